@@ -0,0 +1,102 @@
+#include "arena.h"
+
+// Arena owning the AST of the current compilation
+arena ast_arena = {NULL, 0, 0, 0, 0, 0, 0};
+// Print allocation statistics at the end of a compile (set by --stats)
+int show_alloc_stats = 0;
+
+// Get a fresh block large enough for at least min_size bytes
+static arena_block* arena_new_block(arena* a, size_t min_size) {
+    size_t size = ARENA_BLOCK_SIZE;
+    if (min_size > size) {
+        size = min_size;
+    }
+
+    arena_block* block = (arena_block*)malloc(sizeof(arena_block) + size);
+    if (!block) {
+        fprintf(stderr, "Fatal: out of memory allocating %zu bytes\n", size);
+        exit(1);
+    }
+    block->used = 0;
+    block->size = size;
+    block->next = a->blocks;
+    a->blocks = block;
+
+    a->bytes_reserved += sizeof(arena_block) + size;
+    a->block_count++;
+    return block;
+}
+
+// Carve size bytes out of the current block with the given alignment
+static void* arena_take(arena* a, size_t size, size_t align) {
+    arena_block* block = a->blocks;
+    size_t offset = 0;
+
+    if (block) {
+        offset = (block->used + align - 1) & ~(align - 1);
+    }
+
+    // Current block exhausted - start a new one
+    if (!block || offset + size > block->size) {
+        block = arena_new_block(a, size);
+        offset = 0;
+    }
+
+    block->used = offset + size;
+    a->bytes_used += size;
+    return block->data + offset;
+}
+
+// Allocate size bytes of aligned, uninitialized memory
+void* arena_alloc(arena* a, size_t size) {
+    return arena_take(a, size, ARENA_ALIGNMENT);
+}
+
+// Allocate an AST node
+node* arena_new_node(arena* a) {
+    node* new_node = (node*)arena_take(a, sizeof(node), ARENA_ALIGNMENT);
+    a->node_count++;
+    return new_node;
+}
+
+// Copy a string into the arena
+char* arena_strdup(arena* a, const char* str) {
+    size_t len = strlen(str) + 1;
+    char* copy = (char*)arena_take(a, len, 1);
+    memcpy(copy, str, len);
+
+    a->string_count++;
+    a->string_bytes += len;
+    return copy;
+}
+
+// Release every block at once and reset the statistics
+void arena_release(arena* a) {
+    arena_block* block = a->blocks;
+    while (block) {
+        arena_block* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    a->blocks = NULL;
+    a->bytes_used = 0;
+    a->bytes_reserved = 0;
+    a->block_count = 0;
+    a->node_count = 0;
+    a->string_count = 0;
+    a->string_bytes = 0;
+}
+
+// Print allocation statistics for one arena
+void arena_print_stats(arena* a, const char* label) {
+    printf("=== Allocation Statistics (%s) ===\n", label);
+    if (a->node_count > 0) {
+        printf("Nodes allocated: %d (%zu bytes)\n", a->node_count, a->node_count * sizeof(node));
+    }
+    if (a->string_count > 0) {
+        printf("Strings: %d (%zu bytes)\n", a->string_count, a->string_bytes);
+    }
+    printf("Arena usage: %zu bytes used, %zu bytes reserved in %d block(s)\n\n",
+           a->bytes_used, a->bytes_reserved, a->block_count);
+}
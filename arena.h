@@ -0,0 +1,56 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include "semantic_analysis.h"
+
+// ============================================================================
+// ARENA ALLOCATOR
+// ============================================================================
+// Bump allocator that owns every AST node and token string of one
+// compilation. Memory is carved out of large blocks and is never freed
+// piecemeal; arena_release() returns all blocks at once.
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT 8
+
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t used;
+    size_t size;
+    char data[];
+} arena_block;
+
+typedef struct arena {
+    arena_block* blocks;      // Most recent block first
+    size_t bytes_used;        // Bytes handed out to callers
+    size_t bytes_reserved;    // Bytes obtained from malloc
+    int block_count;
+    int node_count;
+    int string_count;
+    size_t string_bytes;
+} arena;
+
+// ============================================================================
+// GLOBAL STATE MANAGEMENT
+// ============================================================================
+
+extern arena ast_arena;
+extern int show_alloc_stats;
+
+// ============================================================================
+// ALLOCATION
+// ============================================================================
+
+void* arena_alloc(arena* a, size_t size);
+node* arena_new_node(arena* a);
+char* arena_strdup(arena* a, const char* str);
+
+// ============================================================================
+// RELEASE AND STATISTICS
+// ============================================================================
+
+void arena_release(arena* a);
+void arena_print_stats(arena* a, const char* label);
+
+#endif // ARENA_H
@@ -19,6 +19,12 @@
     #include<stdlib.h>
     #include "semantic_analysis.h"
     #include "codegen.h"
+    #include "arena.h"
+    #include "intern.h"
+    #include "optimize.h"
+    #include "cfg.h"
+    #include "peephole.h"
+    #include "inline.h"
 
     int yylex(void);
     int yyerror(const char* s);
@@ -27,12 +33,16 @@
     extern int semantic_errors;
     struct scope* global_scope;
 
-    node *mknode(char *token, node *left, node *right);
+    node *mknode(node_kind kind, char *token, node *left, node *right);
+    node *mkbinary(binary_op op, node *left, node *right);
     void printtree(node *tree, int tabs);
     int syntax_error = FALSE;
     int main_function_found = 0;
     
     #define YYSTYPE struct node*
+    // Statement lists are right-recursive, so the parser stack grows with
+    // the number of statements in a block
+    #define YYMAXDEPTH 1000000
 %}
 
 %%
@@ -69,41 +79,41 @@ program: function statement program {
             yyerror("Statement found after function without braces. Multiple statements require braces '{}'");
             YYABORT;
          }
-       | function program {$$ = mknode("", $1, $2);}
+       | function program {$$ = mknode(NODE_SEQ, "", $1, $2);}
        | function          {$$ = $1;}
        ;
 
 function: DEF ID '(' param_list ')' ARROW type COLON '{' statements '}' {
-            $$ = mknode("function", $2, mknode("", mknode("", mknode("params", $4, NULL), mknode("return_type", $7, NULL)), $10));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", $4, NULL), mknode(NODE_RETURN_TYPE, "return_type", $7, NULL)), $10));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' param_list ')' COLON '{' statements '}' {
-            $$ = mknode("function", $2, mknode("", mknode("params", $4, NULL), $8));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", $4, NULL), $8));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' ')' ARROW type COLON '{' statements '}' {
-            $$ = mknode("function", $2, mknode("", mknode("", mknode("params", NULL, NULL), mknode("return_type", $6, NULL)), $9));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", NULL, NULL), mknode(NODE_RETURN_TYPE, "return_type", $6, NULL)), $9));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' ')' COLON '{' statements '}' {
-            $$ = mknode("function", $2, mknode("", mknode("params", NULL, NULL), $7));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", NULL, NULL), $7));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' param_list ')' ARROW type COLON statement {
-            $$ = mknode("function", $2, mknode("", mknode("", mknode("params", $4, NULL), mknode("return_type", $7, NULL)), $9));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", $4, NULL), mknode(NODE_RETURN_TYPE, "return_type", $7, NULL)), $9));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' param_list ')' COLON statement {
-            $$ = mknode("function", $2, mknode("", mknode("params", $4, NULL), $7));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", $4, NULL), $7));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' ')' ARROW type COLON statement {
-            $$ = mknode("function", $2, mknode("", mknode("", mknode("params", NULL, NULL), mknode("return_type", $6, NULL)), $8));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", NULL, NULL), mknode(NODE_RETURN_TYPE, "return_type", $6, NULL)), $8));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         | DEF ID '(' ')' COLON statement {
-            $$ = mknode("function", $2, mknode("", mknode("params", NULL, NULL), $6));
-            if (strcmp($2->token, "__main__") == 0) main_function_found++;
+            $$ = mknode(NODE_FUNCTION, "function", $2, mknode(NODE_SEQ, "", mknode(NODE_PARAMS, "params", NULL, NULL), $6));
+            if ($2->token == ATOM_MAIN) main_function_found++;
           }
         
         | DEF ID '(' COLON error '{' { yyerror("Missing closing parenthesis"); YYABORT; }
@@ -115,27 +125,27 @@ function: DEF ID '(' param_list ')' ARROW type COLON '{' statements '}' {
         ;
 
 param_list: param {$$ = $1;}
-          | param SEMICOLON param_list {$$ = mknode("", $1, $3);} 
-          | param COMMA param_list {$$ = mknode("", $1, $3);} 
+          | param SEMICOLON param_list {$$ = mknode(NODE_SEQ, "", $1, $3);} 
+          | param COMMA param_list {$$ = mknode(NODE_SEQ, "", $1, $3);} 
           | error { yyerror("Invalid parameter list"); YYABORT; }
           ;
 
-param: type id_list {$$ = mknode($1->token, $2, NULL);} 
+param: type id_list {$$ = mknode(NODE_PARAM, $1->token, $2, NULL);} 
      | error { yyerror("Invalid parameter"); YYABORT; }
      ;
 
 id_list: ID {$$ = $1;} 
-       | ID COLON expr {$$ = mknode($1->token, $3, NULL);}
-       | ID COMMA id_list {$$ = mknode("", $1, $3);} 
-       | ID COLON expr COMMA id_list {node* with_default = mknode($1->token, $3, NULL);
-           $$ = mknode("", with_default, $5);
+       | ID COLON expr {$$ = mknode(NODE_DEFAULT_PARAM, $1->token, $3, NULL);}
+       | ID COMMA id_list {$$ = mknode(NODE_SEQ, "", $1, $3);} 
+       | ID COLON expr COMMA id_list {node* with_default = mknode(NODE_DEFAULT_PARAM, $1->token, $3, NULL);
+           $$ = mknode(NODE_SEQ, "", with_default, $5);
          }
        | error { yyerror("Invalid parameter list"); YYABORT; }
        ;
 
-statements: statement statements {$$ = mknode("", $1, $2);}
+statements: statement statements {$$ = mknode(NODE_SEQ, "", $1, $2);}
           | statement           {$$ = $1;}
-          | '{' statements '}' {$$ = mknode("block", $2, NULL);}
+          | '{' statements '}' {$$ = mknode(NODE_BLOCK, "block", $2, NULL);}
           | error { yyerror("Invalid statement"); YYABORT; }
           ;
 
@@ -145,65 +155,65 @@ statement: declaration
          | while_stmt
          | return_stmt
          | function_call
-         | PASS SEMICOLON {$$ = mknode("pass", NULL, NULL);}
-         | error SEMICOLON { yyerrok; $$ = mknode("ERROR", NULL, NULL); }
+         | PASS SEMICOLON {$$ = mknode(NODE_PASS, "pass", NULL, NULL);}
+         | error SEMICOLON { yyerrok; $$ = mknode(NODE_ERROR, "ERROR", NULL, NULL); }
          ;
 
-function_call: ID '(' arg_list ')' SEMICOLON {$$ = mknode("call", $1, $3);}
-             | ID '(' ')' SEMICOLON {$$ = mknode("call", $1, NULL);}
-             | ID '(' error SEMICOLON { yyerror("Invalid function call arguments"); yyerrok; $$ = mknode("call", $1, NULL); YYABORT;}
-             | ID error SEMICOLON { yyerror("Malformed function call"); yyerrok; $$ = mknode("call", $1, NULL); }
+function_call: ID '(' arg_list ')' SEMICOLON {$$ = mknode(NODE_CALL, "call", $1, $3);}
+             | ID '(' ')' SEMICOLON {$$ = mknode(NODE_CALL, "call", $1, NULL);}
+             | ID '(' error SEMICOLON { yyerror("Invalid function call arguments"); yyerrok; $$ = mknode(NODE_CALL, "call", $1, NULL); YYABORT;}
+             | ID error SEMICOLON { yyerror("Malformed function call"); yyerrok; $$ = mknode(NODE_CALL, "call", $1, NULL); }
              | ID '(' arg_list error { yyerror("Missing semicolon after function call"); YYABORT; }
              | ID '(' ')' error { yyerror("Missing semicolon after function call"); YYABORT; }
              ;
 
 arg_list: expr {$$ = $1;}
-        | expr COMMA arg_list {$$ = mknode("", $1, $3);}
-        | error { yyerrok; $$ = mknode("ERROR", NULL, NULL); }
+        | expr COMMA arg_list {$$ = mknode(NODE_SEQ, "", $1, $3);}
+        | error { yyerrok; $$ = mknode(NODE_ERROR, "ERROR", NULL, NULL); }
         ;
 
 var_list: var_item {$$ = $1;}
-        | var_item COMMA var_list {$$ = mknode("", $1, $3);}
+        | var_item COMMA var_list {$$ = mknode(NODE_SEQ, "", $1, $3);}
         ;
 
 var_item: ID {$$ = $1;}
-        | ID '=' expr {$$ = mknode("init_var", $1, $3);}
+        | ID '=' expr {$$ = mknode(NODE_INIT_VAR, "init_var", $1, $3);}
         ;
 
-declaration: type ID SEMICOLON {$$ = mknode("declare", $1, $2);}
-           | type var_list SEMICOLON {$$ = mknode("declare", $1, $2);} 
-           | type ID '=' expr SEMICOLON {$$ = mknode("init", mknode("declare", $1, $2), $4);}
-           | type ID COLON expr SEMICOLON {$$ = mknode("init", mknode("declare", $1, $2), $4);}
-           | type var_list '=' expr_list SEMICOLON {$$ = mknode("multi_init", mknode("declare", $1, $2), $4);}
+declaration: type ID SEMICOLON {$$ = mknode(NODE_DECLARE, "declare", $1, $2);}
+           | type var_list SEMICOLON {$$ = mknode(NODE_DECLARE, "declare", $1, $2);} 
+           | type ID '=' expr SEMICOLON {$$ = mknode(NODE_INIT, "init", mknode(NODE_DECLARE, "declare", $1, $2), $4);}
+           | type ID COLON expr SEMICOLON {$$ = mknode(NODE_INIT, "init", mknode(NODE_DECLARE, "declare", $1, $2), $4);}
+           | type var_list '=' expr_list SEMICOLON {$$ = mknode(NODE_MULTI_INIT, "multi_init", mknode(NODE_DECLARE, "declare", $1, $2), $4);}
            | type ERROR_TOKEN SEMICOLON { YYABORT; } 
            | type ERROR_TOKEN '=' expr SEMICOLON { YYABORT; } 
-           | type error SEMICOLON { yyerror("Invalid variable name"); yyerrok; $$ = mknode("declare", $1, mknode("ERROR", NULL, NULL)); }
+           | type error SEMICOLON { yyerror("Invalid variable name"); yyerrok; $$ = mknode(NODE_DECLARE, "declare", $1, mknode(NODE_ERROR, "ERROR", NULL, NULL)); }
            | type ID error { yyerror("Missing semicolon in declaration"); YYABORT; }
-           | type ID '=' error SEMICOLON { yyerror("Invalid expression in initialization"); yyerrok; $$ = mknode("init", mknode("declare", $1, $2), mknode("ERROR", NULL, NULL)); }
+           | type ID '=' error SEMICOLON { yyerror("Invalid expression in initialization"); yyerrok; $$ = mknode(NODE_INIT, "init", mknode(NODE_DECLARE, "declare", $1, $2), mknode(NODE_ERROR, "ERROR", NULL, NULL)); }
            | type ID '=' expr error { yyerror("Missing semicolon in initialization"); YYABORT; }
            | ID ID error { yyerror("Invalid data type"); YYABORT; }
            | ID ID '=' expr error { yyerror("Invalid data type"); YYABORT; }
            | ID ID '=' expr SEMICOLON { yyerror("Invalid data type"); YYABORT; }
            ;
 
-type: INT {$$ = mknode("int", NULL, NULL);}
-    | STRING {$$ = mknode("string", NULL, NULL);}
-    | BOOL {$$ = mknode("bool", NULL, NULL);}
-    | FLOAT {$$ = mknode("float", NULL, NULL);}
+type: INT {$$ = mknode(NODE_TYPE, "int", NULL, NULL);}
+    | STRING {$$ = mknode(NODE_TYPE, "string", NULL, NULL);}
+    | BOOL {$$ = mknode(NODE_TYPE, "bool", NULL, NULL);}
+    | FLOAT {$$ = mknode(NODE_TYPE, "float", NULL, NULL);}
     | error { yyerror("Invalid data type"); YYABORT; }
     ;
 
 lhs_list: ID {$$ = $1;}
-        | ID COMMA lhs_list {$$ = mknode("", $1, $3);}
+        | ID COMMA lhs_list {$$ = mknode(NODE_SEQ, "", $1, $3);}
         ;
 
 expr_list: expr {$$ = $1;}
-         | expr COMMA expr_list {$$ = mknode("", $1, $3);}
+         | expr COMMA expr_list {$$ = mknode(NODE_SEQ, "", $1, $3);}
          ;
 
-assign: ID '=' expr SEMICOLON {$$ = mknode("assign", $1, $3);}
-      | ID COLON expr SEMICOLON {$$ = mknode("assign", $1, $3);}
-      | lhs_list '=' expr_list SEMICOLON {$$ = mknode("multi_assign", $1, $3);}
+assign: ID '=' expr SEMICOLON {$$ = mknode(NODE_ASSIGN, "assign", $1, $3);}
+      | ID COLON expr SEMICOLON {$$ = mknode(NODE_ASSIGN, "assign", $1, $3);}
+      | lhs_list '=' expr_list SEMICOLON {$$ = mknode(NODE_MULTI_ASSIGN, "multi_assign", $1, $3);}
       | ERROR_TOKEN '=' expr SEMICOLON { YYABORT; } 
       | ID '=' error SEMICOLON { 
             yyerror("Invalid expression in assignment"); 
@@ -215,73 +225,73 @@ assign: ID '=' expr SEMICOLON {$$ = mknode("assign", $1, $3);}
       ;
 
 if_stmt: IF expr COLON '{' statements '}' %prec LOWER_THAN_ELSE {
-            $$ = mknode("if", $2, $5);
+            $$ = mknode(NODE_IF, "if", $2, $5);
          }
        | IF expr COLON '{' statements '}' elif_chain {
-            $$ = mknode("if-elif", $2, mknode("", $5, $7));
+            $$ = mknode(NODE_IF_ELIF, "if-elif", $2, mknode(NODE_SEQ, "", $5, $7));
          }
        | IF expr COLON '{' statements '}' elif_chain ELSE COLON '{' statements '}' {
-            node* if_elif = mknode("if-elif", $2, mknode("", $5, $7));
-            $$ = mknode("if-elif-else", if_elif, $11);
+            node* if_elif = mknode(NODE_IF_ELIF, "if-elif", $2, mknode(NODE_SEQ, "", $5, $7));
+            $$ = mknode(NODE_IF_ELIF_ELSE, "if-elif-else", if_elif, $11);
          }
        | IF expr COLON '{' statements '}' ELSE COLON '{' statements '}' {
-            $$ = mknode("if-else", mknode("if", $2, $5), $10);
+            $$ = mknode(NODE_IF_ELSE, "if-else", mknode(NODE_IF, "if", $2, $5), $10);
          }
        | IF expr COLON '{' statements '}' ELSE COLON statement {
-            $$ = mknode("if-else", mknode("if", $2, $5), $9);
+            $$ = mknode(NODE_IF_ELSE, "if-else", mknode(NODE_IF, "if", $2, $5), $9);
          }
        | IF expr COLON statement %prec LOWER_THAN_ELSE {
-            $$ = mknode("if", $2, $4);
+            $$ = mknode(NODE_IF, "if", $2, $4);
          }
        | IF expr COLON statement elif_chain {
-            $$ = mknode("if-elif", $2, mknode("", $4, $5));
+            $$ = mknode(NODE_IF_ELIF, "if-elif", $2, mknode(NODE_SEQ, "", $4, $5));
          }
        | IF expr COLON statement elif_chain ELSE COLON '{' statements '}' {
-            node* if_elif = mknode("if-elif", $2, mknode("", $4, $5));
-            $$ = mknode("if-elif-else", if_elif, $9);
+            node* if_elif = mknode(NODE_IF_ELIF, "if-elif", $2, mknode(NODE_SEQ, "", $4, $5));
+            $$ = mknode(NODE_IF_ELIF_ELSE, "if-elif-else", if_elif, $9);
          }
        | IF expr COLON statement elif_chain ELSE COLON statement {
-            node* if_elif = mknode("if-elif", $2, mknode("", $4, $5));
-            $$ = mknode("if-elif-else", if_elif, $8);
+            node* if_elif = mknode(NODE_IF_ELIF, "if-elif", $2, mknode(NODE_SEQ, "", $4, $5));
+            $$ = mknode(NODE_IF_ELIF_ELSE, "if-elif-else", if_elif, $8);
          }
        | IF expr COLON statement ELSE COLON '{' statements '}' {
-            $$ = mknode("if-else", mknode("if", $2, $4), $8);
+            $$ = mknode(NODE_IF_ELSE, "if-else", mknode(NODE_IF, "if", $2, $4), $8);
          }
        | IF expr COLON statement ELSE COLON statement {
-            $$ = mknode("if-else", mknode("if", $2, $4), $7);
+            $$ = mknode(NODE_IF_ELSE, "if-else", mknode(NODE_IF, "if", $2, $4), $7);
          }
        | IF error { yyerror("Invalid if statement"); YYABORT; }
        ;
 
 elif_chain: ELIF expr COLON '{' statements '}' {
-              $$ = mknode("elif", $2, $5);
+              $$ = mknode(NODE_ELIF, "elif", $2, $5);
            }
           | ELIF expr COLON '{' statements '}' elif_chain {
-              $$ = mknode("", mknode("elif", $2, $5), $7);
+              $$ = mknode(NODE_SEQ, "", mknode(NODE_ELIF, "elif", $2, $5), $7);
            }
           | ELIF expr COLON statement {
-              $$ = mknode("elif", $2, $4);
+              $$ = mknode(NODE_ELIF, "elif", $2, $4);
            }
           | ELIF expr COLON statement elif_chain {
-              $$ = mknode("", mknode("elif", $2, $4), $5);
+              $$ = mknode(NODE_SEQ, "", mknode(NODE_ELIF, "elif", $2, $4), $5);
            }
           | ELIF error { yyerror("Invalid elif statement"); YYABORT; }
           ;
 
 while_stmt: WHILE '(' expr ')' '{' statements '}' {
-              $$ = mknode("while", $3, $6);
+              $$ = mknode(NODE_WHILE, "while", $3, $6);
            }
           | WHILE expr COLON '{' statements '}' {
-              $$ = mknode("while", $2, $5);
+              $$ = mknode(NODE_WHILE, "while", $2, $5);
            }
           | WHILE '(' expr ')' COLON '{' statements '}' {
-              $$ = mknode("while", $3, $7);
+              $$ = mknode(NODE_WHILE, "while", $3, $7);
            }
           | WHILE expr COLON statement {
-              $$ = mknode("while", $2, $4);
+              $$ = mknode(NODE_WHILE, "while", $2, $4);
            }
           | WHILE '(' expr ')' COLON statement {
-              $$ = mknode("while", $3, $6);
+              $$ = mknode(NODE_WHILE, "while", $3, $6);
            }
           | WHILE '(' expr error '{' { yyerror("Missing closing parenthesis in while condition"); YYABORT; }
           | WHILE '(' error ')' { yyerror("Invalid condition in while loop"); YYABORT; }
@@ -289,58 +299,107 @@ while_stmt: WHILE '(' expr ')' '{' statements '}' {
           ;
 
 return_stmt: RETURN expr SEMICOLON {
-              $$ = mknode("return", $2, NULL);
+              $$ = mknode(NODE_RETURN, "return", $2, NULL);
             }
           | RETURN SEMICOLON {
-              $$ = mknode("return", NULL, NULL);
+              $$ = mknode(NODE_RETURN, "return", NULL, NULL);
             }
           | RETURN expr error { yyerror("Missing semicolon after return statement"); YYABORT; }
           | RETURN error { yyerror("Invalid return statement"); YYABORT; }
           ;
 
-expr: expr PLUS expr {$$ = mknode("+", $1, $3);}
-    | expr MINUS expr {$$ = mknode("-", $1, $3);}
-    | expr MUL expr {$$ = mknode("*", $1, $3);}
-    | expr DIV expr {$$ = mknode("/", $1, $3);}
-    | expr MOD expr {$$ = mknode("%", $1, $3);}
-    | expr EQ expr {$$ = mknode("==", $1, $3);}
-    | expr IS expr {$$ = mknode("==", $1, $3);}
-    | expr GT expr {$$ = mknode(">", $1, $3);}
-    | expr GE expr {$$ = mknode(">=", $1, $3);}
-    | expr LT expr {$$ = mknode("<", $1, $3);}
-    | expr LE expr {$$ = mknode("<=", $1, $3);}
-    | expr NE expr {$$ = mknode("!=", $1, $3);}
-    | expr POW expr {$$ = mknode("**", $1, $3);}
-    | expr AND expr {$$ = mknode("and", $1, $3);}
-    | expr OR expr {$$ = mknode("or", $1, $3);}
-    | NOT expr {$$ = mknode("not", NULL, $2);}
-    | ID '[' expr ']' {$$ = mknode("index", $1, $3);}
-    | ID '[' expr COLON expr ']' {$$ = mknode("slice", $1, mknode("", $3, $5));} 
-    | ID '[' COLON expr ']' {$$ = mknode("slice", $1, mknode("", mknode("0", NULL, NULL), $4));}  
-    | ID '[' expr COLON ']' {$$ = mknode("slice", $1, mknode("", $3, mknode("-1", NULL, NULL)));}  
-    | ID '[' COLON ']' {$$ = mknode("slice", $1, mknode("", mknode("0", NULL, NULL), mknode("-1", NULL, NULL)));} 
-    | ID '[' expr COLON expr COLON expr ']' {$$ = mknode("slice_step", $1, mknode("", mknode("", $3, $5), $7));}  
-    | ID '[' COLON expr COLON expr ']' {$$ = mknode("slice_step", $1, mknode("", mknode("", mknode("0", NULL, NULL), $4), $6));}  
-    | ID '[' expr COLON COLON expr ']' {$$ = mknode("slice_step", $1, mknode("", mknode("", $3, mknode("-1", NULL, NULL)), $6));} 
-    | ID '[' COLON COLON expr ']' {$$ = mknode("slice_step", $1, mknode("", mknode("", mknode("0", NULL, NULL), mknode("-1", NULL, NULL)), $5));}   
+expr: expr PLUS expr {$$ = mkbinary(OP_ADD, $1, $3);}
+    | expr MINUS expr {$$ = mkbinary(OP_SUB, $1, $3);}
+    | expr MUL expr {$$ = mkbinary(OP_MUL, $1, $3);}
+    | expr DIV expr {$$ = mkbinary(OP_DIV, $1, $3);}
+    | expr MOD expr {$$ = mkbinary(OP_MOD, $1, $3);}
+    | expr EQ expr {$$ = mkbinary(OP_EQ, $1, $3);}
+    | expr IS expr {$$ = mkbinary(OP_EQ, $1, $3);}
+    | expr GT expr {$$ = mkbinary(OP_GT, $1, $3);}
+    | expr GE expr {$$ = mkbinary(OP_GE, $1, $3);}
+    | expr LT expr {$$ = mkbinary(OP_LT, $1, $3);}
+    | expr LE expr {$$ = mkbinary(OP_LE, $1, $3);}
+    | expr NE expr {$$ = mkbinary(OP_NE, $1, $3);}
+    | expr POW expr {$$ = mkbinary(OP_POW, $1, $3);}
+    | expr AND expr {$$ = mknode(NODE_AND, "and", $1, $3);}
+    | expr OR expr {$$ = mknode(NODE_OR, "or", $1, $3);}
+    | NOT expr {$$ = mknode(NODE_NOT, "not", NULL, $2);}
+    | ID '[' expr ']' {$$ = mknode(NODE_INDEX, "index", $1, $3);}
+    | ID '[' expr COLON expr ']' {$$ = mknode(NODE_SLICE, "slice", $1, mknode(NODE_SEQ, "", $3, $5));} 
+    | ID '[' COLON expr ']' {$$ = mknode(NODE_SLICE, "slice", $1, mknode(NODE_SEQ, "", mknode(NODE_NUMBER, "0", NULL, NULL), $4));}  
+    | ID '[' expr COLON ']' {$$ = mknode(NODE_SLICE, "slice", $1, mknode(NODE_SEQ, "", $3, mknode(NODE_NUMBER, "-1", NULL, NULL)));}  
+    | ID '[' COLON ']' {$$ = mknode(NODE_SLICE, "slice", $1, mknode(NODE_SEQ, "", mknode(NODE_NUMBER, "0", NULL, NULL), mknode(NODE_NUMBER, "-1", NULL, NULL)));} 
+    | ID '[' expr COLON expr COLON expr ']' {$$ = mknode(NODE_SLICE_STEP, "slice_step", $1, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", $3, $5), $7));}  
+    | ID '[' COLON expr COLON expr ']' {$$ = mknode(NODE_SLICE_STEP, "slice_step", $1, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", mknode(NODE_NUMBER, "0", NULL, NULL), $4), $6));}  
+    | ID '[' expr COLON COLON expr ']' {$$ = mknode(NODE_SLICE_STEP, "slice_step", $1, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", $3, mknode(NODE_NUMBER, "-1", NULL, NULL)), $6));} 
+    | ID '[' COLON COLON expr ']' {$$ = mknode(NODE_SLICE_STEP, "slice_step", $1, mknode(NODE_SEQ, "", mknode(NODE_SEQ, "", mknode(NODE_NUMBER, "0", NULL, NULL), mknode(NODE_NUMBER, "-1", NULL, NULL)), $5));}   
     | '(' expr ')' {$$ = $2;}
     | '(' expr error { yyerror("Missing closing parenthesis in expression"); YYABORT; }
-    | '(' error ')' { yyerror("Invalid expression in parentheses"); yyerrok; $$ = mknode("ERROR", NULL, NULL); YYABORT; }
-    | ID '(' arg_list ')' {$$ = mknode("call", $1, $3);} 
-    | ID '(' ')' {$$ = mknode("call", $1, NULL);}
-    | ID '(' error ')' { yyerror("Invalid function arguments"); yyerrok; $$ = mknode("call", $1, mknode("ERROR", NULL, NULL)); YYABORT; }
+    | '(' error ')' { yyerror("Invalid expression in parentheses"); yyerrok; $$ = mknode(NODE_ERROR, "ERROR", NULL, NULL); YYABORT; }
+    | ID '(' arg_list ')' {$$ = mknode(NODE_CALL, "call", $1, $3);} 
+    | ID '(' ')' {$$ = mknode(NODE_CALL, "call", $1, NULL);}
+    | ID '(' error ')' { yyerror("Invalid function arguments"); yyerrok; $$ = mknode(NODE_CALL, "call", $1, mknode(NODE_ERROR, "ERROR", NULL, NULL)); YYABORT; }
     | ID {$$ = $1;}
     | ERROR_TOKEN { YYABORT; }
     | NUM {$$ = $1;}
     | STRING_LITERAL {$$ = $1;}
     | TRUE {$$ = $1;}
     | FALSE {$$ = $1;}
-    | error { yyerror("Invalid expression"); yyerrok; syntax_error = TRUE; $$ = mknode("ERROR", NULL, NULL); YYABORT; }
+    | error { yyerror("Invalid expression"); yyerrok; syntax_error = TRUE; $$ = mknode(NODE_ERROR, "ERROR", NULL, NULL); YYABORT; }
     ;
 %%
 #include "lex.yy.c"
-int main() { 
+int main(int argc, char** argv) { 
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            show_alloc_stats = 1;
+        } else if (strcmp(argv[i], "-O") == 0) {
+            optimize_level = 1;
+        } else if (strcmp(argv[i], "--report") == 0) {
+            optimize_report = 1;
+        } else if (strcmp(argv[i], "--cfg") == 0) {
+            dump_cfg = 1;
+        } else if (strcmp(argv[i], "--callgraph") == 0) {
+            dump_call_graph = 1;
+        } else if (strcmp(argv[i], "--reachable-only") == 0) {
+            reachable_only = 1;
+        } else if (strncmp(argv[i], "--peephole=", 11) == 0) {
+            if (!configure_peephole(argv[i] + 11)) {
+                printf("Unknown peephole rule in '%s'; the rules are:\n", argv[i] + 11);
+                print_peephole_rules(stdout);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--peephole-window=", 18) == 0) {
+            peephole_window = atoi(argv[i] + 18);
+            if (peephole_window < 1) {
+                printf("Peephole window must be at least 1\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--inline-limit=", 15) == 0) {
+            char* end;
+            inline_limit = (int)strtol(argv[i] + 15, &end, 10);
+            if (end == argv[i] + 15 || *end != '\0' || inline_limit < 0) {
+                printf("Inline limit must be a number of at least 0\n");
+                return 1;
+            }
+        } else {
+            printf("Unknown option '%s'\n", argv[i]);
+            printf("Usage: %s [--stats] [-O] [--report] [--cfg] [--callgraph] [--reachable-only] [--peephole=RULE,...|none] [--peephole-window=N] [--inline-limit=N] < input_file\n", argv[0]);
+            return 1;
+        }
+    }
+
+    intern_init();
     int result = yyparse();
+
+    if (show_alloc_stats) {
+        arena_print_stats(&ast_arena, "AST");
+        intern_print_stats();
+    }
+    // All nodes and token strings are released in one go
+    arena_release(&ast_arena);
+    intern_release();
+
     if (result != 0) {  
         printf("Parsing failed!\n");
         return 1;
@@ -358,7 +417,7 @@ void printtree(node *tree, int tabs) {
     /* Check if tree is NULL before proceeding */
     if (!tree) return;
     
-    if (strcmp(tree->token, "") != 0) {
+    if (tree->token != ATOM_EMPTY) {
         for (int i = 0; i < tabs; i++)
             printf("\t");
         
@@ -400,12 +459,20 @@ int yyerror(const char* s) {
     return 0;
 }
 
-node *mknode(char *token, node *left, node *right) {
-    node *newnode = (node*)malloc(sizeof(node));
-    char *newstr = (char*)malloc(strlen(token) + 1);
-    strcpy(newstr, token);
+node *mknode(node_kind kind, char *token, node *left, node *right) {
+    node *newnode = arena_new_node(&ast_arena);
     newnode -> left = left;
     newnode -> right = right;
-    newnode -> token = newstr;
+    newnode -> token = intern(token);
+    newnode -> kind = kind;
+    newnode -> op = OP_NONE;
+    newnode -> type = 0;
+    newnode -> typed = 0;
+    return newnode;
+}
+
+node *mkbinary(binary_op op, node *left, node *right) {
+    node *newnode = mknode(NODE_BINARY, (char*)binary_op_name(op), left, right);
+    newnode -> op = op;
     return newnode;
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# bench_locals.sh - Time the compiler on functions with many local variables
+#
+# Usage: ./bench_locals.sh [N ...]    (default: 10000 20000 40000)
+#
+# For each N, writes bench_locals_N.t: a __main__ that declares N chained
+# locals, "int vI = v(I-1) + v(I/2);", so every declaration looks up two
+# earlier names. Then times ./ast on it (build it first with
+# ./run_program.sh). Scope variables live in hash tables, so the time
+# should roughly double with N rather than grow fourfold.
+
+if [ ! -x ./ast ]; then
+    echo "ERROR: ./ast not found. Build it first with ./run_program.sh"
+    exit 1
+fi
+
+if [ $# -eq 0 ]; then
+    set -- 10000 20000 40000
+fi
+
+TIMEFORMAT="%R s real, %U s user"
+for n in "$@"; do
+    file="bench_locals_$n.t"
+    awk -v n="$n" 'BEGIN {
+        print "def __main__(): {"
+        print "    int v0 = 1;"
+        for (i = 1; i < n; i++) printf "    int v%d = v%d + v%d;\n", i, i - 1, int(i / 2)
+        printf "    v0 = v%d + v%d;\n", n - 1, int(n / 3)
+        print "}"
+    }' > "$file"
+
+    echo "=== $n locals ($file) ==="
+    time ./ast < "$file" > /dev/null
+done
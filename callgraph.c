@@ -0,0 +1,114 @@
+#include "callgraph.h"
+#include "intern.h"
+
+int reachable_only = 0;
+int dump_call_graph = 0;
+
+int call_graph_find(call_graph* graph, char* name) {
+    function_info* info = find_function_by_name(name);
+    if (!info || info->declaration_position >= graph->count) return -1;
+    if (graph->nodes[info->declaration_position].name != name) return -1;
+    return info->declaration_position;
+}
+
+int call_graph_reachable(call_graph* graph, char* name) {
+    int index = call_graph_find(graph, name);
+    return index >= 0 && graph->nodes[index].reachable;
+}
+
+// Record a call; seen[callee] holds the last caller that got the edge
+static void add_call(call_graph* graph, int caller, char* callee_name, int* seen) {
+    call_graph_node* from = &graph->nodes[caller];
+    from->call_count++;
+    int callee = call_graph_find(graph, callee_name);
+    if (callee < 0 || seen[callee] == caller) return;
+    seen[callee] = caller;
+
+    if (from->callee_count == from->callee_capacity) {
+        from->callee_capacity = from->callee_capacity ? from->callee_capacity * 2 : 4;
+        from->callees = (int*)realloc(from->callees, from->callee_capacity * sizeof(int));
+    }
+    from->callees[from->callee_count++] = callee;
+}
+
+// Statement lists are right-recursive, so the walk loops down the right
+// children and only recurses on the left ones
+static void collect_calls(call_graph* graph, int caller, node* tree, int* seen) {
+    while (tree) {
+        if (tree->kind == NODE_CALL && tree->left) add_call(graph, caller, tree->left->token, seen);
+        collect_calls(graph, caller, tree->left, seen);
+        tree = tree->right;
+    }
+}
+
+static void collect_functions(call_graph* graph, node* tree, int* seen) {
+    while (tree) {
+        if (tree->kind == NODE_FUNCTION) {
+            int index = tree->left ? call_graph_find(graph, tree->left->token) : -1;
+            if (index >= 0) {
+                graph->nodes[index].definition = tree;
+                collect_calls(graph, index, tree->right, seen);
+            }
+            return;
+        }
+        collect_functions(graph, tree->left, seen);
+        tree = tree->right;
+    }
+}
+
+void build_call_graph(call_graph* graph, node* root) {
+    graph->count = declared_functions.count;
+    graph->nodes = (call_graph_node*)calloc(graph->count + 1, sizeof(call_graph_node));
+    graph->reachable_count = 0;
+    for (int i = 0; i < graph->count; i++) {
+        graph->nodes[i].name = declared_functions.in_order[i]->name;
+    }
+
+    int* seen = (int*)malloc((graph->count + 1) * sizeof(int));
+    for (int i = 0; i < graph->count; i++) {
+        seen[i] = -1;
+    }
+    collect_functions(graph, root, seen);
+
+    // Depth-first from __main__ with an explicit stack; seen is reused
+    // as the stack
+    int top = 0;
+    int entry = call_graph_find(graph, intern("__main__"));
+    if (entry >= 0) {
+        graph->nodes[entry].reachable = 1;
+        seen[top++] = entry;
+    }
+    while (top > 0) {
+        call_graph_node* from = &graph->nodes[seen[--top]];
+        graph->reachable_count++;
+        for (int c = 0; c < from->callee_count; c++) {
+            call_graph_node* to = &graph->nodes[from->callees[c]];
+            if (to->reachable) continue;
+            to->reachable = 1;
+            seen[top++] = from->callees[c];
+        }
+    }
+    free(seen);
+}
+
+void release_call_graph(call_graph* graph) {
+    for (int i = 0; i < graph->count; i++) {
+        free(graph->nodes[i].callees);
+    }
+    free(graph->nodes);
+    memset(graph, 0, sizeof(call_graph));
+}
+
+// One line per function: its callees, and whether __main__ reaches it
+void print_call_graph(FILE* out, call_graph* graph) {
+    fprintf(out, "=== Call Graph ===\n");
+    for (int i = 0; i < graph->count; i++) {
+        call_graph_node* from = &graph->nodes[i];
+        fprintf(out, "%s (%d calls%s):", from->name, from->call_count, from->reachable ? "" : ", unreachable");
+        for (int c = 0; c < from->callee_count; c++) {
+            fprintf(out, " %s", graph->nodes[from->callees[c]].name);
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "%d of %d functions reachable from __main__\n\n", graph->reachable_count, graph->count);
+}
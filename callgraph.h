@@ -0,0 +1,57 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <stdio.h>
+#include "semantic_analysis.h"
+
+// ============================================================================
+// CALL GRAPH
+// ============================================================================
+// Built from the AST once semantic analysis has filled the function table:
+// one node per function definition, indexed by its declaration position,
+// with an edge to every function its body calls (each callee once, in the
+// order of the first call). Calls in the default values of parameters
+// belong to the function declaring them. A function is reachable when a
+// path of edges leads to it from __main__.
+
+typedef struct call_graph_node {
+    char* name;           // Interned function name
+    node* definition;     // NODE_FUNCTION, NULL if never defined
+    int* callees;         // Indexes of the functions called
+    int callee_count;
+    int callee_capacity;
+    int call_count;       // Call nodes in the body, repeated callees included
+    int reachable;
+} call_graph_node;
+
+typedef struct call_graph {
+    call_graph_node* nodes;  // nodes[i] is the function declared i-th
+    int count;
+    int reachable_count;
+} call_graph;
+
+// Generate code only for the functions reachable from __main__
+// (--reachable-only)
+extern int reachable_only;
+
+// Print the call graph after the 3AC (--callgraph)
+extern int dump_call_graph;
+
+// ============================================================================
+// CONSTRUCTION AND QUERIES
+// ============================================================================
+
+void build_call_graph(call_graph* graph, node* root);
+void release_call_graph(call_graph* graph);
+
+// Index of the node of a function (name interned), -1 if not declared
+int call_graph_find(call_graph* graph, char* name);
+int call_graph_reachable(call_graph* graph, char* name);
+
+// ============================================================================
+// DEBUG OUTPUT
+// ============================================================================
+
+void print_call_graph(FILE* out, call_graph* graph);
+
+#endif // CALLGRAPH_H
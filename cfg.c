@@ -0,0 +1,178 @@
+#include "cfg.h"
+
+// Set by --cfg: dump the graph of every function after the 3AC
+int dump_cfg = 0;
+
+// Instructions that transfer control to a label
+int is_jump_opcode(ir_opcode opcode) {
+    return opcode == IR_GOTO || opcode == IR_IF_FALSE || opcode == IR_IF_TRUE;
+}
+
+// Instructions after which the next one starts a new block
+static int ends_block(ir_opcode opcode) {
+    return is_jump_opcode(opcode) || opcode == IR_RETURN || opcode == IR_TAIL_CALL || opcode == IR_SWITCH;
+}
+
+static void append_block_id(int** list, int* count, int* capacity, int id) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 2;
+        *list = (int*)realloc(*list, *capacity * sizeof(int));
+    }
+    (*list)[(*count)++] = id;
+}
+
+// Add an edge once; a conditional jump to the next block is one edge
+static void add_edge(cfg* graph, int from, int to) {
+    basic_block* source = &graph->blocks[from];
+    for (int i = 0; i < source->succ_count; i++) {
+        if (source->succs[i] == to) return;
+    }
+    basic_block* dest = &graph->blocks[to];
+    append_block_id(&source->succs, &source->succ_count, &source->succ_capacity, to);
+    append_block_id(&dest->preds, &dest->pred_count, &dest->pred_capacity, from);
+}
+
+void cfg_build(cfg* graph, ir_function* fn) {
+    memset(graph, 0, sizeof(cfg));
+    graph->fn = fn;
+    graph->label_block = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        graph->label_block[l] = -1;
+    }
+
+    // Mark leaders; an empty function still has one (empty) entry block
+    char* leader = (char*)calloc(fn->count + 1, 1);
+    leader[0] = 1;
+    for (int i = 0; i < fn->count; i++) {
+        if (fn->code[i].opcode == IR_LABEL) leader[i] = 1;
+        if (ends_block(fn->code[i].opcode)) leader[i + 1] = 1;
+    }
+
+    int block_count = 0;
+    for (int i = 0; i < fn->count || i == 0; i++) {
+        if (leader[i]) block_count++;
+    }
+    graph->blocks = (basic_block*)calloc(block_count, sizeof(basic_block));
+
+    // Cut the quads into blocks
+    for (int i = 0; i < fn->count || i == 0; i++) {
+        if (leader[i]) {
+            basic_block* block = &graph->blocks[graph->count];
+            block->id = graph->count++;
+            block->first = i;
+            block->last = i - 1;
+        }
+        if (i >= fn->count) break;
+
+        basic_block* block = &graph->blocks[graph->count - 1];
+        block->last = i;
+        if (fn->code[i].opcode == IR_LABEL) {
+            int label = ir_label_number(fn, fn->code[i].target);
+            if (label) graph->label_block[label] = block->id;
+            if (!block->label) block->label = fn->code[i].target;
+        }
+    }
+    free(leader);
+
+    // Connect them
+    for (int b = 0; b < graph->count; b++) {
+        basic_block* block = &graph->blocks[b];
+        quad* last = cfg_last_quad(graph, block);
+        int falls_through = b + 1 < graph->count;
+
+        if (last && is_jump_opcode(last->opcode)) {
+            int target = cfg_block_of_label(graph, last->target);
+            if (target >= 0) add_edge(graph, b, target);
+            if (last->opcode == IR_GOTO) falls_through = 0;
+        } else if (last && last->opcode == IR_SWITCH) {
+            for (int i = 0; i < last->value; i++) {
+                int target = cfg_block_of_label(graph, last->cases[i]);
+                if (target >= 0) add_edge(graph, b, target);
+            }
+            int fallback = cfg_block_of_label(graph, last->target);
+            if (fallback >= 0) add_edge(graph, b, fallback);
+            falls_through = 0;
+        } else if (last && (last->opcode == IR_RETURN || last->opcode == IR_TAIL_CALL)) {
+            falls_through = 0;
+        }
+        if (falls_through) add_edge(graph, b, b + 1);
+    }
+}
+
+void cfg_release(cfg* graph) {
+    for (int b = 0; b < graph->count; b++) {
+        free(graph->blocks[b].succs);
+        free(graph->blocks[b].preds);
+    }
+    free(graph->blocks);
+    free(graph->label_block);
+    memset(graph, 0, sizeof(cfg));
+}
+
+int cfg_block_of_label(cfg* graph, char* label) {
+    int number = ir_label_number(graph->fn, label);
+    return number ? graph->label_block[number] : -1;
+}
+
+// Binary search over the block ranges
+int cfg_block_of_quad(cfg* graph, int index) {
+    int low = 0, high = graph->count - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (graph->blocks[mid].first <= index) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+// Last instruction of a block, NULL if the block is empty
+quad* cfg_last_quad(cfg* graph, basic_block* block) {
+    if (block->last < block->first) return NULL;
+    return &graph->fn->code[block->last];
+}
+
+static void print_block_list(FILE* out, const char* title, int* ids, int count) {
+    fprintf(out, " %s:", title);
+    if (count == 0) {
+        fprintf(out, " -");
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(out, " B%d", ids[i]);
+    }
+}
+
+// Print each block with its edges followed by its instructions
+void cfg_print(FILE* out, cfg* graph) {
+    ir_function* fn = graph->fn;
+    fprintf(out, "%s: %d block(s)\n", ir_function_label(fn), graph->count);
+
+    for (int b = 0; b < graph->count; b++) {
+        basic_block* block = &graph->blocks[b];
+        fprintf(out, "  B%d", block->id);
+        if (block->label) {
+            fprintf(out, " (%s)", block->label);
+        }
+        print_block_list(out, "preds", block->preds, block->pred_count);
+        print_block_list(out, "succs", block->succs, block->succ_count);
+        fprintf(out, "\n");
+
+        for (int i = block->first; i <= block->last; i++) {
+            fprintf(out, "  ");
+            ir_print_quad(out, &fn->code[i]);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+void cfg_print_program(FILE* out, ir_program* program) {
+    fprintf(out, "=== Control Flow Graphs ===\n");
+    for (ir_function* fn = program->first; fn; fn = fn->next) {
+        cfg graph;
+        cfg_build(&graph, fn);
+        cfg_print(out, &graph);
+        cfg_release(&graph);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "ir.h"
+
+// ============================================================================
+// CONTROL-FLOW GRAPH
+// ============================================================================
+// A view over the quads of one function. Each basic block is a range of
+// instruction indexes that starts at a leader (the entry, a label, or the
+// instruction after a jump or return) and is only entered at the top.
+// Edges come from goto, if_false/if_true (target and fallthrough),
+// switch (every case and the default), plain fallthrough, and return
+// (no successor).
+// The graph must be rebuilt after the quads of the function change.
+
+typedef struct basic_block {
+    int id;               // Index in cfg.blocks, in code order
+    int first;            // Index of the first quad
+    int last;             // Index of the last quad (first - 1 if empty)
+    char* label;          // Label that starts the block, NULL if none
+    int* succs;           // Successor block ids
+    int succ_count;
+    int succ_capacity;
+    int* preds;           // Predecessor block ids
+    int pred_count;
+    int pred_capacity;
+} basic_block;
+
+typedef struct cfg {
+    ir_function* fn;
+    basic_block* blocks;  // blocks[0] is the entry block
+    int count;
+    int* label_block;     // Block id for each label number, -1 if unused
+} cfg;
+
+extern int dump_cfg;
+
+// ============================================================================
+// CONSTRUCTION AND QUERIES
+// ============================================================================
+
+void cfg_build(cfg* graph, ir_function* fn);
+void cfg_release(cfg* graph);
+int cfg_block_of_label(cfg* graph, char* label);
+int cfg_block_of_quad(cfg* graph, int index);
+quad* cfg_last_quad(cfg* graph, basic_block* block);
+int is_jump_opcode(ir_opcode opcode);
+
+// ============================================================================
+// DEBUG OUTPUT
+// ============================================================================
+
+void cfg_print(FILE* out, cfg* graph);
+void cfg_print_program(FILE* out, ir_program* program);
+
+#endif // CFG_H
@@ -1,21 +1,29 @@
 #include "codegen.h"
+#include "intern.h"
+#include "optimize.h"
+#include "cfg.h"
+#include "consteval.h"
+#include "specialize.h"
 
 // Global counters for generating unique names
 int temp_counter = 1;
 int label_counter = 1;
 
-// Generate new temporary variable
+// Functions generated so far and the one currently being filled in
+ir_program generated_program = {NULL, NULL, 0};
+ir_function* current_ir = NULL;
+
+// Who calls whom, built before any code is generated
+call_graph program_calls = {NULL, 0, 0};
+
+// Generate new temporary variable (interned, never freed by the caller)
 char* new_temp() {
-    char* temp = (char*)malloc(10);
-    snprintf(temp, 10, "t%d", temp_counter++);
-    return temp;
+    return ir_temp_name(temp_counter++);
 }
 
-// Generate new label
+// Generate new label (interned, never freed by the caller)
 char* new_label() {
-    char* label = (char*)malloc(10);
-    snprintf(label, 10, "L%d", label_counter++);
-    return label;
+    return ir_label_name(label_counter++);
 }
 
 // Reset counters for each function
@@ -33,8 +41,27 @@ void generate_3ac(struct node* ast_root, struct scope* global_scope) {
         return;
     }
     
-    // Process the AST
+    // Build the code of every function, then print it
+    build_call_graph(&program_calls, (node*)ast_root);
     process_ast_functions(ast_root);
+    if (reachable_only && program_calls.reachable_count < program_calls.count) {
+        printf("// %d functions unreachable from __main__ not generated\n\n",
+               program_calls.count - program_calls.reachable_count);
+    }
+    ir_print_program(stdout, &generated_program);
+    if (dump_call_graph) {
+        print_call_graph(stdout, &program_calls);
+    }
+    if (dump_cfg) {
+        cfg_print_program(stdout, &generated_program);
+    }
+    if (optimize_report) {
+        print_optimization_report(stdout, &generated_program);
+    }
+    ir_release_program(&generated_program);
+    release_constant_calls();
+    release_specializations();
+    release_call_graph(&program_calls);
     
     printf("=== 3AC Generation Completed ===\n\n");
 }
@@ -43,9 +70,11 @@ void generate_3ac(struct node* ast_root, struct scope* global_scope) {
 void process_ast_functions(struct node* node) {
     if (!node) return;
     
-    // If this node is a function, process it
-    if (node->token && strcmp(node->token, "function") == 0) {
-        generate_function(node);
+    // If this node is a function, process it unless it is left out
+    if (node->kind == NODE_FUNCTION) {
+        if (!reachable_only || !node->left || call_graph_reachable(&program_calls, node->left->token)) {
+            generate_function(node);
+        }
     }
     
     // Check for more functions in siblings (left/right children)
@@ -61,180 +90,25 @@ void generate_function(struct node* func) {
     reset_counters();
     
     // func->left is the function name 
-    char* func_name = func->left->token;
-
-    if (strcmp(func_name, "__main__") == 0)
-        func_name = "main";
-        
-    printf("%s:\n", func_name);
-    
-    // Calculate stack size for parameters
-    int stack_size = calculate_function_stack_size(func);
-    
-    printf("    BeginFunc %d\n", stack_size);
+    current_ir = ir_new_function(&generated_program, func->left->token);
     
     // func->right contains the function body
     if (func->right) {
         generate_function_body(func->right);
     }
+    current_ir->temp_count = temp_counter - 1;
+    current_ir->label_count = label_counter - 1;
     
-    printf("    EndFunc\n\n");
-}
-
-// Calculate stack size needed for function parameters
-int calculate_function_stack_size(struct node* func) {
-    if (!func || !func->left) return 0;
-    
-    char* func_name = func->left->token;
-    
-    // Find the parameters in the AST
-    struct node* params_node = find_params_node(func);
-    if (!params_node) return 0;
-    
-    // Count and calculate size of all parameters
-    int total_size = 0;
-    total_size += calculate_params_size(params_node);
-    
-    return total_size;
-}
-
-// Find the params node in function AST
-struct node* find_params_node(struct node* func) {
-    if (!func || !func->right) return NULL;
-    
-    // Search for params node in function structure
-    return search_for_params(func->right);
-}
-
-// Search for params node
-struct node* search_for_params(struct node* node) {
-    if (!node) return NULL;
-    
-    // Check if this is the params node
-    if (node->token && strcmp(node->token, "params") == 0) {
-        return node;
+    // Run the 3AC optimizations; they end by recycling dead temporaries
+    // so fewer of them need a frame slot
+    if (optimize_level > 0) {
+        optimize_function(&generated_program, current_ir);
     }
     
-    // Search in children
-    struct node* left_result = search_for_params(node->left);
-    if (left_result) return left_result;
-    
-    struct node* right_result = search_for_params(node->right);
-    if (right_result) return right_result;
+    // Give every parameter, local and temporary its slot
+    ir_layout_frame(current_ir);
     
-    return NULL;
-}
-
-// Calculate total size of all parameters
-int calculate_params_size(struct node* params_node) {
-    if (!params_node) return 0;
-    
-    int total_size = 0;
-    
-    // Traverse params node to find all parameter type nodes
-    total_size += calculate_param_types_size(params_node);
-    
-    return total_size;
-}
-
-// Calculate size of parameter types
-int calculate_param_types_size(struct node* node) {
-    if (!node) return 0;
-    
-    int size = 0;
-    
-    // Check if this is a type node (int, float, string, bool)
-    if (node->token && get_type_from_string(node->token) != 0) {
-        // This is a parameter type node - count parameters under it
-        int param_count = count_parameters_under_type(node);
-        int type_size = get_type_size(get_type_from_string(node->token));
-        size += param_count * type_size;
-    }
-    
-    // Check children
-    size += calculate_param_types_size(node->left);
-    size += calculate_param_types_size(node->right);
-    
-    return size;
-}
-
-// Count parameter names under a type node
-int count_parameters_under_type(struct node* type_node) {
-    if (!type_node) return 0;
-    
-    int count = 0;
-    count += count_param_names(type_node);
-    return count;
-}
-
-// Count parameter names
-int count_param_names(struct node* node) {
-    if (!node) return 0;
-    
-    int count = 0;
-    
-    // If this node has a token and it's not a type name, it might be a parameter name
-    if (node->token && strlen(node->token) > 0 && 
-        get_type_from_string(node->token) == 0 && 
-        is_valid_param_name(node->token)) {
-        count = 1;
-    }
-    
-    // Count in children
-    count += count_param_names(node->left);
-    count += count_param_names(node->right);
-    
-    return count;
-}
-
-// Get type from string 
-int get_type_from_string(char* type_str) {
-    if (!type_str) return 0;
-    if (strcmp(type_str, "int") == 0) return 1;
-    if (strcmp(type_str, "string") == 0) return 2;
-    if (strcmp(type_str, "bool") == 0) return 3;
-    if (strcmp(type_str, "float") == 0) return 4;
-    return 0;
-}
-
-// Get size in bytes for each type
-int get_type_size(int type) {
-    switch(type) {
-        case 1: return 4; // int
-        case 2: return 4; // string (pointer)
-        case 3: return 4; // bool  
-        case 4: return 4; // float
-        default: return 0;
-    }
-}
-
-// Check if token is a valid parameter name
-int is_valid_param_name(char* token) {
-    if (!token || strlen(token) == 0) return 0;
-    
-    // Skip keywords and operators
-    if (strcmp(token, "params") == 0 || 
-        strcmp(token, "return_type") == 0 ||
-        strcmp(token, "") == 0) return 0;
-    
-    // Skip boolean literals (default values)
-    if (strcmp(token, "true") == 0 || strcmp(token, "false") == 0 || 
-        strcmp(token, "True") == 0 || strcmp(token, "False") == 0) {
-        return 0;  // This is a default value, not a parameter name
-    }
-    
-    // Skip numeric literals (default values)
-    if (token[0] >= '0' && token[0] <= '9') {
-        return 0;  // This is a numeric default value
-    }
-    
-    // Skip string literals (default values)
-    if (token[0] == '"' || token[0] == '\'') {
-        return 0;  // This is a string default value
-    }
-    
-    // This looks like a parameter name
-    return 1;
+    current_ir = NULL;
 }
 
 // Generate code for function body
@@ -242,7 +116,7 @@ void generate_function_body(struct node* body) {
     if (!body) return;
     
     // Look for the params and statements
-    if (body->left && strcmp(body->left->token, "params") == 0) {
+    if (body->left && body->left->kind == NODE_PARAMS) {
         // Skip params for now, go to statements
         if (body->right) {
             generate_statements(body->right);
@@ -257,9 +131,9 @@ void generate_function_body(struct node* body) {
 void generate_statements(struct node* stmts) {
     if (!stmts) return;
     
-    // Check if this is a statement sequence (empty token with left/right children)
-    if (strcmp(stmts->token, "") == 0) {
-        // Empty token - process children (multiple statements)
+    // Check if this is a statement sequence
+    if (stmts->kind == NODE_SEQ) {
+        // Process children (multiple statements)
         if (stmts->left) generate_statements(stmts->left);   // Process first statement(s)
         if (stmts->right) generate_statements(stmts->right); // Process remaining statement(s)
     } else {
@@ -272,70 +146,71 @@ void generate_statements(struct node* stmts) {
 void generate_statement(struct node* stmt) {
     if (!stmt) return;
 
-    if (strcmp(stmt->token, "") == 0) {
-        generate_statements(stmt);
-        return;
-    }
-
-    // Skip nodes that are handled elsewhere
-    if (strcmp(stmt->token, "params") == 0 || 
-        strcmp(stmt->token, "return_type") == 0) {
-        return;
-    }
-    
-    if (strcmp(stmt->token, "init") == 0) {
-        // This is variable initialization
-        generate_init_statement(stmt);
-    }
-    else if (strcmp(stmt->token, "assign") == 0) {
-        // This is assignment
-        generate_assign_statement(stmt);
-    }
-    else if (strcmp(stmt->token, "multi_assign") == 0) {
-        // Handle multiple assignment
-        generate_multiple_assignment(stmt);
-    }
-    else if (strcmp(stmt->token, "if") == 0) {
-        // Handle if statement
-        generate_simple_if(stmt);
-    }
-    else if (strcmp(stmt->token, "if-else") == 0) {
-        // Handle if-else statement 
-        generate_if_else(stmt);
-    }
-    else if (strcmp(stmt->token, "if-elif") == 0) {
-        // Handle if-elif chain 
-        generate_if_elif(stmt);
-    }
-    else if (strcmp(stmt->token, "if-elif-else") == 0) {
-        // Handle if-elif-else chain 
-        generate_if_elif_else(stmt);
-    }
-    else if (strcmp(stmt->token, "while") == 0) {
-        // Handle while loop statement 
-        generate_while_statement(stmt);
-    }
-    else if (strcmp(stmt->token, "call") == 0) {
-        // Handle function call statement
-        generate_function_call_statement(stmt);
-    }
-    else if (strcmp(stmt->token, "return") == 0) {
-        // Handle return statement
-        generate_return_statement(stmt);
-    }
-    else if (strcmp(stmt->token, "declare") == 0) {
-        // Check if this is a comma-separated declaration with initializations
-        if (stmt->right && has_init_var_nodes(stmt->right)) {
-            generate_comma_declaration(stmt);
+    switch (stmt->kind) {
+        case NODE_SEQ:
+            generate_statements(stmt);
+            break;
+        case NODE_PARAMS:
+        case NODE_RETURN_TYPE:
+            // Skip nodes that are handled elsewhere
+            break;
+        case NODE_INIT:
+            // This is variable initialization
+            generate_init_statement(stmt);
+            break;
+        case NODE_ASSIGN:
+            // This is assignment
+            generate_assign_statement(stmt);
+            break;
+        case NODE_MULTI_ASSIGN:
+            // Handle multiple assignment
+            generate_multiple_assignment(stmt);
+            break;
+        case NODE_IF:
+            // Handle if statement
+            generate_simple_if(stmt);
+            break;
+        case NODE_IF_ELSE:
+            // Handle if-else statement 
+            generate_if_else(stmt);
+            break;
+        case NODE_IF_ELIF:
+            // Handle if-elif chain 
+            generate_if_elif(stmt);
+            break;
+        case NODE_IF_ELIF_ELSE:
+            // Handle if-elif-else chain 
+            generate_if_elif_else(stmt);
+            break;
+        case NODE_WHILE:
+            // Handle while loop statement 
+            generate_while_statement(stmt);
+            break;
+        case NODE_CALL:
+            // Handle function call statement
+            generate_function_call_statement(stmt);
+            break;
+        case NODE_RETURN:
+            // Handle return statement
+            generate_return_statement(stmt);
+            break;
+        case NODE_DECLARE:
+            // Check if this is a comma-separated declaration with initializations
+            if (stmt->right && has_init_var_nodes(stmt->right)) {
+                generate_comma_declaration(stmt);
+            }
+            // Otherwise, it's just a regular declaration 
+            break;
+        case NODE_PASS:
+            // Pass statement - do nothing, just leave a comment
+            ir_emit_comment(current_ir, "pass statement");
+            break;
+        default: {
+            char text[256];
+            snprintf(text, sizeof(text), "TODO: Statement type '%s'", stmt->token);
+            ir_emit_comment(current_ir, text);
+            break;
         }
-        // Otherwise, it's just a regular declaration 
-    }
-    else if (strcmp(stmt->token, "pass") == 0) {
-        // Pass statement - do nothing, just print comment
-        printf("    // pass statement\n");
-    }
-    else {
-        printf("    // TODO: Statement type '%s'\n", stmt->token);
     }
 }
 
@@ -356,21 +231,16 @@ void generate_init_statement(struct node* init) {
         char* var_name = declare->right->token;  // Variable name
         
         // Special handling for empty string initialization
-        if ((!value_expr->token || strlen(value_expr->token) == 0) && 
-            declare->left && strcmp(declare->left->token, "string") == 0) {
-            printf("    %s = \"\"\n", var_name);
+        if ((!value_expr->token || value_expr->token == ATOM_EMPTY) && 
+            declare->left && declare->left->token == ATOM_STRING) {
+            ir_emit_copy(current_ir, var_name, intern("\"\""), TYPE_STRING);
             return;
         }
         
         // Generate expression (could be simple value or complex expression)
         char* expr_result = generate_expression(value_expr);
         
-        printf("    %s = %s\n", var_name, expr_result);
-        
-        // Free the temporary result string if it was allocated
-        if (expr_result != value_expr->token) {
-            free(expr_result);
-        }
+        ir_emit_copy(current_ir, var_name, expr_result, get_node_type(value_expr));
     }
 }
 
@@ -390,22 +260,18 @@ void generate_variable_list_assignments(struct node* var_list) {
     if (!var_list) return;
     
     // Handle init_var nodes (variables with initialization)
-    if (var_list->token && strcmp(var_list->token, "init_var") == 0) {
+    if (var_list->kind == NODE_INIT_VAR) {
         if (var_list->left && var_list->right) {
             char* var_name = var_list->left->token;
             char* expr_result = generate_expression(var_list->right);
             
-            printf("    %s = %s\n", var_name, expr_result);
-            
-            if (expr_result != var_list->right->token) {
-                free(expr_result);
-            }
+            ir_emit_copy(current_ir, var_name, expr_result, get_node_type(var_list->right));
         }
         return;
     }
     
     // Handle regular variable names (no initialization needed)
-    if (var_list->token && strlen(var_list->token) > 0) {
+    if (var_list->kind != NODE_SEQ) {
         // Regular variables without initialization - no 3AC code needed
         return;
     }
@@ -424,17 +290,13 @@ void generate_assign_statement(struct node* assign) {
     // Generate expression (could be simple value or complex expression)
     char* expr_result = generate_expression(assign->right);
     
-    printf("    %s = %s\n", var_name, expr_result);
-    
-    if (expr_result != assign->right->token) {
-        free(expr_result);
-    }
+    ir_emit_copy(current_ir, var_name, expr_result, get_node_type(assign->right));
 }
 
 // Generate code for multiple assignment
 void generate_multiple_assignment(struct node* multi_assign_node) {
     if (!multi_assign_node || !multi_assign_node->left || !multi_assign_node->right) {
-        printf("    // ERROR: Invalid multiple assignment\n");
+        ir_emit_comment(current_ir, "ERROR: Invalid multiple assignment");
         return;
     }
 
@@ -449,7 +311,7 @@ void generate_multiple_assignment(struct node* multi_assign_node) {
     count_and_extract_expressions(multi_assign_node->right, &rhs_exprs, &rhs_count);
 
     if (lhs_count != rhs_count || lhs_count == 0) {
-        printf("    // ERROR: Multiple assignment count mismatch\n");
+        ir_emit_comment(current_ir, "ERROR: Multiple assignment count mismatch");
         goto cleanup;
     }
 
@@ -465,7 +327,7 @@ void generate_multiple_assignment(struct node* multi_assign_node) {
             // If generate_expression returned the original token, create a temp
             if (temp_vars[i] == rhs_exprs[i]->token) {
                 char* new_temp_var = new_temp();
-                printf("    %s = %s\n", new_temp_var, temp_vars[i]);
+                ir_emit_copy(current_ir, new_temp_var, temp_vars[i], get_node_type(rhs_exprs[i]));
                 temp_vars[i] = new_temp_var;
             }
         } else {
@@ -476,12 +338,7 @@ void generate_multiple_assignment(struct node* multi_assign_node) {
     // Assign all temporaries to LHS variables
     for (int i = 0; i < lhs_count; i++) {
         if (lhs_vars[i] && lhs_vars[i]->token && temp_vars[i]) {
-            printf("    %s = %s\n", lhs_vars[i]->token, temp_vars[i]);
-            
-            // Free temp_vars[i] if it was allocated by generate_expression
-            if (temp_vars[i] != rhs_exprs[i]->token) {
-                free(temp_vars[i]);
-            }
+            ir_emit_copy(current_ir, lhs_vars[i]->token, temp_vars[i], get_node_type(rhs_exprs[i]));
         }
     }
 
@@ -500,53 +357,34 @@ char* generate_expression(struct node* expr) {
         return NULL;
     }
     
-    // Check what type of expression this is
-    if (strcmp(expr->token, "+") == 0 ||
-        strcmp(expr->token, "-") == 0 ||
-        strcmp(expr->token, "*") == 0 ||
-        strcmp(expr->token, "/") == 0 ||
-        strcmp(expr->token, "%") == 0 ||
-        strcmp(expr->token, "**") == 0 ||
-        strcmp(expr->token, "==") == 0 ||
-        strcmp(expr->token, "!=") == 0 ||
-        strcmp(expr->token, "<") == 0 ||
-        strcmp(expr->token, ">") == 0 ||
-        strcmp(expr->token, "<=") == 0 ||
-        strcmp(expr->token, ">=") == 0) {
-        // Binary operation (arithmetic or comparison)
-        return generate_binary_operation(expr);
-    }
-    else if (strcmp(expr->token, "and") == 0) {
-        // Logical AND with short-circuit evaluation
-        return generate_logical_and(expr);
-    }
-    else if (strcmp(expr->token, "or") == 0) {
-        // Logical OR with short-circuit evaluation
-        return generate_logical_or(expr);
-    }
-    else if (strcmp(expr->token, "not") == 0) {
-        // Logical NOT
-        return generate_logical_not(expr);
-    }
-    else if (strcmp(expr->token, "call") == 0) {
-        // Function call that returns a value
-        return generate_function_call_expression(expr);
-    }
-    else if (strcmp(expr->token, "index") == 0) {
-        // String indexing operation
-        return generate_string_index(expr);
-    }
-    else if (strcmp(expr->token, "slice") == 0) {
-        // String slicing operation
-        return generate_string_slice(expr);
-    }
-    else if (strcmp(expr->token, "slice_step") == 0) {
-        // String slicing with step operation
-        return generate_string_slice_step(expr);
-    }
-    else {
-        // Simple literal or identifier - return the token directly
-        return expr->token;
+    switch (expr->kind) {
+        case NODE_BINARY:
+            // Binary operation (arithmetic or comparison)
+            return generate_binary_operation(expr);
+        case NODE_AND:
+            // Logical AND with short-circuit evaluation
+            return generate_logical_and(expr);
+        case NODE_OR:
+            // Logical OR with short-circuit evaluation
+            return generate_logical_or(expr);
+        case NODE_NOT:
+            // Logical NOT
+            return generate_logical_not(expr);
+        case NODE_CALL:
+            // Function call that returns a value
+            return generate_function_call_expression(expr);
+        case NODE_INDEX:
+            // String indexing operation
+            return generate_string_index(expr);
+        case NODE_SLICE:
+            // String slicing operation
+            return generate_string_slice(expr);
+        case NODE_SLICE_STEP:
+            // String slicing with step operation
+            return generate_string_slice_step(expr);
+        default:
+            // Simple literal or identifier - return the token directly
+            return expr->token;
     }
 }
 
@@ -558,22 +396,30 @@ char* generate_binary_operation(struct node* expr) {
     char* left_result = generate_expression(expr->left);
     char* right_result = generate_expression(expr->right);
     
+    // Evaluate operations on literals at compile time
+    if (optimize_level > 0) {
+        char* folded = fold_binary((binary_op)expr->op, left_result, right_result);
+        if (folded) {
+            return folded;
+        }
+    }
+    
     // Generate a new temporary variable for the result
     char* temp_var = new_temp();
     
-    // Print the 3AC instruction
-    printf("    %s = %s %s %s\n", temp_var, left_result, expr->token, right_result);
-    
-    if (left_result != expr->left->token) {
-        free(left_result);
-    }
-    if (right_result != expr->right->token) {
-        free(right_result);
-    }
+    ir_emit_binary(current_ir, temp_var, (binary_op)expr->op, left_result, right_result, get_node_type(expr));
     
     return temp_var;
 }
 
+// Get the literal spelling of a boolean operand that needs no code, or NULL
+char* literal_bool_operand(struct node* expr) {
+    if (!expr || expr->kind != NODE_BOOL) {
+        return NULL;
+    }
+    return expr->token;
+}
+
 // Generate code for logical AND with short-circuit evaluation
 char* generate_logical_and(struct node* expr) {
     if (!expr || !expr->left || !expr->right) return NULL;
@@ -581,29 +427,39 @@ char* generate_logical_and(struct node* expr) {
     // Generate code for left operand
     char* left_result = generate_expression(expr->left);
     
+    if (optimize_level > 0) {
+        // false and X is false without evaluating X; true and X is X
+        if (is_bool_literal(left_result)) {
+            if (!bool_literal_value(left_result)) {
+                return ATOM_FALSE;
+            }
+            return generate_expression(expr->right);
+        }
+        // X has been evaluated: X and false is false; X and true is X
+        char* right_literal = literal_bool_operand(expr->right);
+        if (right_literal) {
+            return bool_literal_value(right_literal) ? left_result : ATOM_FALSE;
+        }
+    }
+    
     // Generate labels for short-circuit evaluation
     char* false_label = new_label();
     char* end_label = new_label();
     char* result_temp = new_temp();
     
     // Short-circuit: if left is false, result is false
-    printf("    if_false %s goto %s\n", left_result, false_label);
+    ir_emit_cond_jump(current_ir, IR_IF_FALSE, left_result, false_label);
     
     // Left is true, evaluate right operand
     char* right_result = generate_expression(expr->right);
-    printf("    %s = %s\n", result_temp, right_result);
-    printf("    goto %s\n", end_label);
+    ir_emit_copy(current_ir, result_temp, right_result, TYPE_BOOL);
+    ir_emit_goto(current_ir, end_label);
     
     // Left was false, result is false
-    printf("%s:\n", false_label);
-    printf("    %s = false\n", result_temp);
-    
-    printf("%s:\n", end_label);
+    ir_emit_label(current_ir, false_label);
+    ir_emit_copy(current_ir, result_temp, ATOM_FALSE, TYPE_BOOL);
     
-    if (left_result != expr->left->token) free(left_result);
-    if (right_result != expr->right->token) free(right_result);
-    free(false_label);
-    free(end_label);
+    ir_emit_label(current_ir, end_label);
     
     return result_temp;
 }
@@ -615,30 +471,39 @@ char* generate_logical_or(struct node* expr) {
     // Generate code for left operand
     char* left_result = generate_expression(expr->left);
     
+    if (optimize_level > 0) {
+        // true or X is true without evaluating X; false or X is X
+        if (is_bool_literal(left_result)) {
+            if (bool_literal_value(left_result)) {
+                return ATOM_TRUE;
+            }
+            return generate_expression(expr->right);
+        }
+        // X has been evaluated: X or true is true; X or false is X
+        char* right_literal = literal_bool_operand(expr->right);
+        if (right_literal) {
+            return bool_literal_value(right_literal) ? ATOM_TRUE : left_result;
+        }
+    }
+    
     // Generate labels for short-circuit evaluation
     char* true_label = new_label();
     char* end_label = new_label();
     char* result_temp = new_temp();
     
     // Short-circuit: if left is true, result is true
-    printf("    if_true %s goto %s\n", left_result, true_label);
+    ir_emit_cond_jump(current_ir, IR_IF_TRUE, left_result, true_label);
     
     // Left is false, evaluate right operand
     char* right_result = generate_expression(expr->right);
-    printf("    %s = %s\n", result_temp, right_result);
-    printf("    goto %s\n", end_label);
+    ir_emit_copy(current_ir, result_temp, right_result, TYPE_BOOL);
+    ir_emit_goto(current_ir, end_label);
     
     // Left was true, result is true
-    printf("%s:\n", true_label);
-    printf("    %s = true\n", result_temp);
+    ir_emit_label(current_ir, true_label);
+    ir_emit_copy(current_ir, result_temp, ATOM_TRUE, TYPE_BOOL);
     
-    printf("%s:\n", end_label);
-    
-    // Clean up temporaries
-    if (left_result != expr->left->token) free(left_result);
-    if (right_result != expr->right->token) free(right_result);
-    free(true_label);
-    free(end_label);
+    ir_emit_label(current_ir, end_label);
     
     return result_temp;
 }
@@ -649,18 +514,106 @@ char* generate_logical_not(struct node* expr) {
     
     // Generate code for operand
     char* operand_result = generate_expression(expr->right);
+    
+    if (optimize_level > 0) {
+        char* folded = fold_not(operand_result);
+        if (folded) {
+            return folded;
+        }
+    }
+    
     char* result_temp = new_temp();
     
     // Generate NOT operation
-    printf("    %s = not %s\n", result_temp, operand_result);
-    
-    if (operand_result != expr->right->token) {
-        free(operand_result);
-    }
+    ir_emit_not(current_ir, result_temp, operand_result);
     
     return result_temp;
 }
 
+// Evaluate a condition for a statement that branches on it. Under -O
+// nothing is emitted yet: generate_false_jump compiles the condition
+// straight into branches, so NULL is returned.
+char* generate_condition(struct node* cond) {
+    if (optimize_level > 0) {
+        return NULL;
+    }
+    return generate_expression(cond);
+}
+
+// Jump to label when the condition is false, given the result of generate_condition
+void generate_false_jump(struct node* cond, char* condition_result, char* label) {
+    if (condition_result) {
+        ir_emit_cond_jump(current_ir, IR_IF_FALSE, condition_result, label);
+        return;
+    }
+    generate_branch(cond, label, 0);
+}
+
+// Compile a condition in control context: jump to label when its value
+// equals jump_if, otherwise fall through. Comparisons become a single
+// compare-and-branch and and/or/not never materialize a bool temporary.
+void generate_branch(struct node* cond, char* label, int jump_if) {
+    char* skip_label;
+
+    switch (cond->kind) {
+        case NODE_AND:
+            if (!jump_if) {
+                // Either operand being false takes the jump
+                generate_branch(cond->left, label, 0);
+                generate_branch(cond->right, label, 0);
+                return;
+            }
+            skip_label = new_label();
+            generate_branch(cond->left, skip_label, 0);
+            generate_branch(cond->right, label, 1);
+            ir_emit_label(current_ir, skip_label);
+            return;
+        case NODE_OR:
+            if (jump_if) {
+                // Either operand being true takes the jump
+                generate_branch(cond->left, label, 1);
+                generate_branch(cond->right, label, 1);
+                return;
+            }
+            skip_label = new_label();
+            generate_branch(cond->left, skip_label, 1);
+            generate_branch(cond->right, label, 0);
+            ir_emit_label(current_ir, skip_label);
+            return;
+        case NODE_NOT:
+            generate_branch(cond->right, label, !jump_if);
+            return;
+        case NODE_BINARY:
+            if (cond->op >= OP_EQ && cond->op <= OP_GE) {
+                char* left_result = generate_expression(cond->left);
+                char* right_result = generate_expression(cond->right);
+                char* folded = fold_binary((binary_op)cond->op, left_result, right_result);
+                if (folded) {
+                    if (bool_literal_value(folded) == jump_if) {
+                        ir_emit_goto(current_ir, label);
+                    }
+                    return;
+                }
+                ir_emit_compare_jump(current_ir, jump_if ? IR_IF_TRUE : IR_IF_FALSE,
+                                     (binary_op)cond->op, left_result, right_result, label);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Any other boolean value is computed and tested
+    char* value = generate_expression(cond);
+    if (is_bool_literal(value)) {
+        if (bool_literal_value(value) == jump_if) {
+            ir_emit_goto(current_ir, label);
+        }
+        return;
+    }
+    ir_emit_cond_jump(current_ir, jump_if ? IR_IF_TRUE : IR_IF_FALSE, value, label);
+}
+
 // Generate simple if statement
 void generate_simple_if(struct node* if_node) {
     if (!if_node || !if_node->left || !if_node->right) return;
@@ -669,24 +622,19 @@ void generate_simple_if(struct node* if_node) {
     // if_node->right = if body statements
     
     // Generate condition evaluation
-    char* condition_result = generate_expression(if_node->left);
+    char* condition_result = generate_condition(if_node->left);
     
     // Generate end label for if statement
     char* end_label = new_label();
     
     // Generate conditional jump: if condition is false, skip the if body
-    printf("    if_false %s goto %s\n", condition_result, end_label);
+    generate_false_jump(if_node->left, condition_result, end_label);
     
     // Generate if body
     generate_statements(if_node->right);
     
     // End label
-    printf("%s:\n", end_label);
-    
-    if (condition_result != if_node->left->token) {
-        free(condition_result);
-    }
-    free(end_label);
+    ir_emit_label(current_ir, end_label);
 }
 
 // Generate if-else statement
@@ -706,33 +654,27 @@ void generate_if_else(struct node* if_else_node) {
     struct node* if_body = if_part->right;
     
     // Generate condition evaluation
-    char* condition_result = generate_expression(condition);
+    char* condition_result = generate_condition(condition);
     
     // Generate labels
     char* else_label = new_label();  // Jump here if condition is false
     char* end_label = new_label();   // Jump here to skip else after if
     
     // Generate conditional jump: if condition is false, go to else
-    printf("    if_false %s goto %s\n", condition_result, else_label);
+    generate_false_jump(condition, condition_result, else_label);
     
     // Generate if body
     generate_statements(if_body);
     
     // Jump to end after if body (skip else)
-    printf("    goto %s\n", end_label);
+    ir_emit_goto(current_ir, end_label);
     
     // Else label and body
-    printf("%s:\n", else_label);
+    ir_emit_label(current_ir, else_label);
     generate_statements(else_part);
     
     // End label
-    printf("%s:\n", end_label);
-    
-    if (condition_result != condition->token) {
-        free(condition_result);
-    }
-    free(else_label);
-    free(end_label);
+    ir_emit_label(current_ir, end_label);
 }
 
 // Generate while loop
@@ -747,28 +689,22 @@ void generate_while_statement(struct node* while_node) {
     char* loop_end_label = new_label();   
     
     // Loop start label - this is where we come back to
-    printf("%s:\n", loop_start_label);
+    ir_emit_label(current_ir, loop_start_label);
     
     // Evaluate condition
-    char* condition_result = generate_expression(while_node->left);
+    char* condition_result = generate_condition(while_node->left);
     
     // If condition is false, exit the loop
-    printf("    if_false %s goto %s\n", condition_result, loop_end_label);
+    generate_false_jump(while_node->left, condition_result, loop_end_label);
     
     // Generate loop body
     generate_statements(while_node->right);
     
     // Jump back to start of loop
-    printf("    goto %s\n", loop_start_label);
+    ir_emit_goto(current_ir, loop_start_label);
     
     // Loop end label
-    printf("%s:\n", loop_end_label);
-    
-    if (condition_result != while_node->left->token) {
-        free(condition_result);
-    }
-    free(loop_start_label);
-    free(loop_end_label);
+    ir_emit_label(current_ir, loop_end_label);
 }
 
 // Generate if-elif chain
@@ -779,26 +715,20 @@ void generate_if_elif(struct node* if_elif_node) {
     // if_elif_node->right = sequence containing if body + elif chain
     
     // Generate the initial if condition
-    char* condition_result = generate_expression(if_elif_node->left);
+    char* condition_result = generate_condition(if_elif_node->left);
     
     // Generate end label for entire chain
     char* end_label = new_label();
     char* first_elif_label = new_label();
     
     // Initial if: if condition is false, go to first elif
-    printf("    if_false %s goto %s\n", condition_result, first_elif_label);
+    generate_false_jump(if_elif_node->left, condition_result, first_elif_label);
     
     // Process the right side: if body + elif chain
     process_if_body_and_elif_chain(if_elif_node->right, first_elif_label, end_label);
     
     // Final end label
-    printf("%s:\n", end_label);
-    
-    if (condition_result != if_elif_node->left->token) {
-        free(condition_result);
-    }
-    free(first_elif_label);
-    free(end_label);
+    ir_emit_label(current_ir, end_label);
 }
 
 // Process the sequence containing if body + elif chain
@@ -811,7 +741,7 @@ void process_if_body_and_elif_chain(struct node* sequence, char* elif_start_labe
     // Generate if body first
     if (sequence->left) {
         generate_statement(sequence->left);  // This is the "assign" statement
-        printf("    goto %s\n", end_label);  // Skip all elifs after if body
+        ir_emit_goto(current_ir, end_label);  // Skip all elifs after if body
     }
     
     // Process the elif chain
@@ -824,20 +754,19 @@ void process_if_body_and_elif_chain(struct node* sequence, char* elif_start_labe
 void process_elif_chain(struct node* elif_sequence, char* current_label, char* end_label) {
     if (!elif_sequence) return;
     
-    // Print the current label (where we jump if previous condition failed)
-    printf("%s:\n", current_label);
+    // Place the current label (where we jump if previous condition failed)
+    ir_emit_label(current_ir, current_label);
     
-    if (elif_sequence->token && strcmp(elif_sequence->token, "elif") == 0) {
+    if (elif_sequence->kind == NODE_ELIF) {
         // This is a single elif node
         generate_single_elif(elif_sequence, end_label);
     }
-    else if (strcmp(elif_sequence->token, "") == 0) {
+    else if (elif_sequence->kind == NODE_SEQ) {
         // This is a sequence of elifs
         // elif_sequence->left = first elif
         // elif_sequence->right = remaining elifs (or single elif)
         
-        if (elif_sequence->left && elif_sequence->left->token && 
-            strcmp(elif_sequence->left->token, "elif") == 0) {
+        if (elif_sequence->left && elif_sequence->left->kind == NODE_ELIF) {
             
             // Generate this elif
             char* next_label = new_label();
@@ -847,9 +776,8 @@ void process_elif_chain(struct node* elif_sequence, char* current_label, char* e
             if (elif_sequence->right) {
                 process_elif_chain(elif_sequence->right, next_label, end_label);
             } else {
-                // No more elifs, just print the next label
-                printf("%s:\n", next_label);
-                free(next_label);
+                // No more elifs, just place the next label
+                ir_emit_label(current_ir, next_label);
             }
         }
     }
@@ -860,20 +788,16 @@ void generate_single_elif(struct node* elif_node, char* end_label) {
     if (!elif_node || !elif_node->left || !elif_node->right) return;
     
     // Generate elif condition
-    char* condition_result = generate_expression(elif_node->left);
+    char* condition_result = generate_condition(elif_node->left);
     
     // If condition fails, jump to end (this is the last elif)
-    printf("    if_false %s goto %s\n", condition_result, end_label);
+    generate_false_jump(elif_node->left, condition_result, end_label);
     
     // Generate elif body
     generate_statements(elif_node->right);
     
     // Jump to end after body
-    printf("    goto %s\n", end_label);
-    
-    if (condition_result != elif_node->left->token) {
-        free(condition_result);
-    }
+    ir_emit_goto(current_ir, end_label);
 }
 
 // Generate a single elif that jumps to next_label if condition fails
@@ -881,20 +805,16 @@ void generate_single_elif_with_next(struct node* elif_node, char* next_label, ch
     if (!elif_node || !elif_node->left || !elif_node->right) return;
     
     // Generate elif condition
-    char* condition_result = generate_expression(elif_node->left);
+    char* condition_result = generate_condition(elif_node->left);
     
     // If condition fails, jump to next elif
-    printf("    if_false %s goto %s\n", condition_result, next_label);
+    generate_false_jump(elif_node->left, condition_result, next_label);
     
     // Generate elif body
     generate_statements(elif_node->right);
     
     // Jump to end after body
-    printf("    goto %s\n", end_label);
-    
-    if (condition_result != elif_node->left->token) {
-        free(condition_result);
-    }
+    ir_emit_goto(current_ir, end_label);
 }
 
 // Generate if-elif-else chain
@@ -912,15 +832,12 @@ void generate_if_elif_else(struct node* if_elif_else_node) {
     generate_if_elif_with_final_else(if_elif_else_node->left, else_label, end_label);
     
     // Generate the final else part
-    printf("%s:\n", else_label);
+    ir_emit_label(current_ir, else_label);
     generate_statements(if_elif_else_node->right);
-    printf("    goto %s\n", end_label);
+    ir_emit_goto(current_ir, end_label);
     
     // Final end label
-    printf("%s:\n", end_label);
-    
-    free(else_label);
-    free(end_label);
+    ir_emit_label(current_ir, end_label);
 }
 
 // Generate if-elif with final else that jumps to end
@@ -928,21 +845,16 @@ void generate_if_elif_with_final_else(struct node* if_elif_node, char* else_labe
     if (!if_elif_node || !if_elif_node->left || !if_elif_node->right) return;
     
     // Generate the initial if condition
-    char* condition_result = generate_expression(if_elif_node->left);
+    char* condition_result = generate_condition(if_elif_node->left);
     
     // Generate first elif label
     char* first_elif_label = new_label();
     
     // Initial if: if condition is false, go to first elif
-    printf("    if_false %s goto %s\n", condition_result, first_elif_label);
+    generate_false_jump(if_elif_node->left, condition_result, first_elif_label);
     
     // Process the if body and elif chain
     process_if_body_and_elif_with_final_else(if_elif_node->right, first_elif_label, else_label, end_label);
-    
-    if (condition_result != if_elif_node->left->token) {
-        free(condition_result);
-    }
-    free(first_elif_label);
 }
 
 // Process if body and elif chain, with last elif jumping to else
@@ -952,7 +864,7 @@ void process_if_body_and_elif_with_final_else(struct node* sequence, char* elif_
     // Generate if body first
     if (sequence->left) {
         generate_statement(sequence->left);  // This is the "assign" statement
-        printf("    goto %s\n", end_label);  // Skip all elifs and else
+        ir_emit_goto(current_ir, end_label);  // Skip all elifs and else
     }
     
     // Process the elif chain
@@ -965,31 +877,27 @@ void process_if_body_and_elif_with_final_else(struct node* sequence, char* elif_
 void process_elif_chain_with_else_destination(struct node* elif_sequence, char* current_label, char* else_label, char* end_label) {
     if (!elif_sequence) return;
     
-    printf("%s:\n", current_label);
+    ir_emit_label(current_ir, current_label);
     
-    if (elif_sequence->token && strcmp(elif_sequence->token, "elif") == 0) {
+    if (elif_sequence->kind == NODE_ELIF) {
         // This is a single elif - need to determine if it's the last one
         generate_single_elif_with_else_fallback(elif_sequence, else_label, end_label);
     }
-    else if (strcmp(elif_sequence->token, "") == 0) {
+    else if (elif_sequence->kind == NODE_SEQ) {
         // This is a sequence of elifs
-        if (elif_sequence->left && elif_sequence->left->token && 
-            strcmp(elif_sequence->left->token, "elif") == 0) {
+        if (elif_sequence->left && elif_sequence->left->kind == NODE_ELIF) {
             
             // Check if there are more elifs after this one
-            if (elif_sequence->right && elif_sequence->right->token && 
-                strcmp(elif_sequence->right->token, "elif") == 0) {
+            if (elif_sequence->right && elif_sequence->right->kind == NODE_ELIF) {
                 // There's another elif after this one
                 char* next_label = new_label();
                 generate_single_elif_with_next(elif_sequence->left, next_label, end_label);
                 process_elif_chain_with_else_destination(elif_sequence->right, next_label, else_label, end_label);
-                free(next_label);
-            } else if (elif_sequence->right && strcmp(elif_sequence->right->token, "") == 0) {
+            } else if (elif_sequence->right && elif_sequence->right->kind == NODE_SEQ) {
                 // There's a sequence on the right, process it
                 char* next_label = new_label();
                 generate_single_elif_with_next(elif_sequence->left, next_label, end_label);
                 process_elif_chain_with_else_destination(elif_sequence->right, next_label, else_label, end_label);
-                free(next_label);
             } else {
                 // This is the last elif - it should jump to else if condition fails
                 generate_single_elif_with_else_fallback(elif_sequence->left, else_label, end_label);
@@ -1003,33 +911,29 @@ void generate_single_elif_with_else_fallback(struct node* elif_node, char* else_
     if (!elif_node || !elif_node->left || !elif_node->right) return;
     
     // Generate elif condition
-    char* condition_result = generate_expression(elif_node->left);
+    char* condition_result = generate_condition(elif_node->left);
     
     // If condition fails, jump to else (not end)
-    printf("    if_false %s goto %s\n", condition_result, else_label);
+    generate_false_jump(elif_node->left, condition_result, else_label);
     
     // Generate elif body
     generate_statements(elif_node->right);
     
     // Jump to end after body (skip else)
-    printf("    goto %s\n", end_label);
-    
-    if (condition_result != elif_node->left->token) {
-        free(condition_result);
-    }
+    ir_emit_goto(current_ir, end_label);
 }
 
 // Generate function call statements
 void generate_function_call_statement(struct node* call_stmt) {
     if (!call_stmt || !call_stmt->left) {
-        printf("    // ERROR: Invalid function call\n");
+        ir_emit_comment(current_ir, "ERROR: Invalid function call");
         return;
     }
     
     char* function_name = call_stmt->left->token;
     
     if (!function_name) {
-        printf("    // ERROR: Missing function name in call\n");
+        ir_emit_comment(current_ir, "ERROR: Missing function name in call");
         return;
     }
     
@@ -1040,11 +944,11 @@ void generate_function_call_statement(struct node* call_stmt) {
     generate_function_arguments(call_stmt, &arg_count, &total_bytes);
     
     // Generate simple function call (void function)
-    printf("    call %s\n", function_name);
+    ir_emit_call(current_ir, function_name);
     
     // Clean up parameters from stack
     if (total_bytes > 0) {
-        printf("    PopParams %d\n", total_bytes);
+        ir_emit_pop_params(current_ir, total_bytes);
     }
 }
 
@@ -1055,35 +959,25 @@ void generate_return_statement(struct node* return_node) {
     // Check if there's a return value
     if (return_node->left) {
         // return_node->left = expression to return
-        
-        // Generate the return expression
-        char* return_value = generate_expression(return_node->left);
-        
-        // Print return with value
-        printf("    return %s\n", return_value);
-        
-        // Clean up if we generated a temporary
-        if (return_value != return_node->left->token) {
-            free(return_value);
-        }
+        ir_emit_return(current_ir, generate_expression(return_node->left));
     } else {
         // Empty return (no value)
-        printf("    return\n");
+        ir_emit_return(current_ir, NULL);
     }
 }
 
 // Generate function call expression
 char* generate_function_call_expression(struct node* call_expr) {
     if (!call_expr || !call_expr->left) {
-        printf("    // ERROR: Invalid function call expression\n");
-        return strdup("call_error");
+        ir_emit_comment(current_ir, "ERROR: Invalid function call expression");
+        return intern("call_error");
     }
     
     char* function_name = call_expr->left->token;
     
     if (!function_name) {
-        printf("    // ERROR: No function name in call expression\n");
-        return strdup("no_func_name");
+        ir_emit_comment(current_ir, "ERROR: No function name in call expression");
+        return intern("no_func_name");
     }
     
     // Process arguments
@@ -1094,13 +988,14 @@ char* generate_function_call_expression(struct node* call_expr) {
     
     // Generate a temporary variable for the return value
     char* result_temp = new_temp();
+    function_info* callee = find_function_by_name(function_name);
     
     // Generate LCall instruction
-    printf("    %s = LCall %s\n", result_temp, function_name);
+    ir_emit_lcall(current_ir, result_temp, function_name, callee ? callee->return_type : 0);
     
     // Clean up parameters from stack
     if (total_bytes > 0) {
-        printf("    PopParams %d\n", total_bytes);
+        ir_emit_pop_params(current_ir, total_bytes);
     }
     
     return result_temp;
@@ -1121,14 +1016,23 @@ void generate_function_arguments(struct node* call_node, int* arg_count, int* to
     if (call_node->right) {
         process_call_arguments(call_node->right, arg_count, total_bytes, 0);
     }
+
+    // Parameters the call leaves out get their default values
+    function_info* callee = call_node->left ? find_function_by_name(call_node->left->token) : NULL;
+    for (int p = *arg_count; callee && p < callee->param_count && callee->has_default[p]; p++) {
+        char* value = generate_expression(callee->default_values[p]);
+        ir_emit_push_param(current_ir, convert_literal(value, callee->param_types[p]));
+        *total_bytes += FRAME_SLOT_SIZE;
+        (*arg_count)++;
+    }
 }
 
 // Process function call arguments
 void process_call_arguments(struct node* args_node, int* arg_count, int* total_bytes, int unused) {
     if (!args_node) return;
     
-    // If this is an empty structure node (comma-separated arguments)
-    if (!args_node->token || strcmp(args_node->token, "") == 0) {
+    // If this is a sequence node (comma-separated arguments)
+    if (args_node->kind == NODE_SEQ) {
         // Process left argument first
         if (args_node->left) {
             process_call_arguments(args_node->left, arg_count, total_bytes, 0);
@@ -1143,16 +1047,12 @@ void process_call_arguments(struct node* args_node, int* arg_count, int* total_b
     // This is a single argument - process it
     
     // Check if this is a nested function call
-    if (strcmp(args_node->token, "call") == 0) {
+    if (args_node->kind == NODE_CALL) {
         char* nested_result = generate_function_call_expression(args_node);
         if (nested_result) {
-            printf("    PushParam %s\n", nested_result);
-            *total_bytes += 4;
+            ir_emit_push_param(current_ir, nested_result);
+            *total_bytes += FRAME_SLOT_SIZE;
             (*arg_count)++;
-            
-            if (nested_result != args_node->token) {
-                free(nested_result);
-            }
         }
         return;
     }
@@ -1166,28 +1066,15 @@ void process_call_arguments(struct node* args_node, int* arg_count, int* total_b
 int is_argument_node(struct node* node) {
     if (!node) return 0;
     
-    // Don't treat empty nodes as arguments
-    if (!node->token || strcmp(node->token, "") == 0) return 0;
-    
-    // Function calls ARE arguments (nested calls)
-    if (strcmp(node->token, "call") == 0) return 1;
-    
-    // Expressions are arguments
-    if (strcmp(node->token, "+") == 0 ||
-        strcmp(node->token, "-") == 0 ||
-        strcmp(node->token, "*") == 0 ||
-        strcmp(node->token, "/") == 0 ||
-        strcmp(node->token, "%") == 0) return 1;
-    
-    // Literals and variables are arguments
-    return 1;
+    // Sequence nodes only separate arguments; everything else is one
+    return node->kind != NODE_SEQ;
 }
 
 // Function to check if variable list has init_var nodes:
 int has_init_var_nodes(struct node* var_list) {
     if (!var_list) return 0;
     
-    if (var_list->token && strcmp(var_list->token, "init_var") == 0) {
+    if (var_list->kind == NODE_INIT_VAR) {
         return 1;
     }
     
@@ -1199,14 +1086,11 @@ void generate_push_param(struct node* arg_node, int* total_bytes) {
     if (!arg_node) return;
     
     // If this is a function call node, handle it properly
-    if (arg_node->token && strcmp(arg_node->token, "call") == 0) {
+    if (arg_node->kind == NODE_CALL) {
         char* result = generate_function_call_expression(arg_node);
         if (result) {
-            printf("    PushParam %s\n", result);
-            *total_bytes += 4;
-            if (result != arg_node->token) {
-                free(result);
-            }
+            ir_emit_push_param(current_ir, result);
+            *total_bytes += FRAME_SLOT_SIZE;
         }
         return;
     }
@@ -1215,12 +1099,8 @@ void generate_push_param(struct node* arg_node, int* total_bytes) {
     char* arg_value = generate_argument_value(arg_node);
     
     if (arg_value) {
-        printf("    PushParam %s\n", arg_value);
-        *total_bytes += 4;
-        
-        if (arg_value != arg_node->token) {
-            free(arg_value);
-        }
+        ir_emit_push_param(current_ir, arg_value);
+        *total_bytes += FRAME_SLOT_SIZE;
     }
 }
 
@@ -1229,32 +1109,12 @@ char* generate_argument_value(struct node* arg_node) {
     if (!arg_node) return NULL;
     
     // Handle function calls
-    if (arg_node->token && strcmp(arg_node->token, "call") == 0) {
+    if (arg_node->kind == NODE_CALL) {
         return generate_function_call_expression(arg_node);
     }
     
-    // Handle expressions
-    if (arg_node->token && (
-        strcmp(arg_node->token, "+") == 0 ||
-        strcmp(arg_node->token, "-") == 0 ||
-        strcmp(arg_node->token, "*") == 0 ||
-        strcmp(arg_node->token, "/") == 0 ||
-        strcmp(arg_node->token, "%") == 0 ||
-        strcmp(arg_node->token, "==") == 0 ||
-        strcmp(arg_node->token, "!=") == 0 ||
-        strcmp(arg_node->token, "<") == 0 ||
-        strcmp(arg_node->token, ">") == 0 ||
-        strcmp(arg_node->token, "<=") == 0 ||
-        strcmp(arg_node->token, ">=") == 0)) {
-        return generate_expression(arg_node);
-    }
-    
-    // Return literals and variables
-    if (arg_node->token) {
-        return arg_node->token;
-    }
-    
-    return NULL;
+    // Expressions, literals and variables
+    return generate_expression(arg_node);
 }
 
 // Generate 3AC for string indexing
@@ -1265,12 +1125,7 @@ char* generate_string_index(struct node* index_node) {
     char* index_expr = generate_expression(index_node->right);  // The index
     
     char* result_temp = new_temp();
-    printf("    %s = %s[%s]\n", result_temp, string_var, index_expr);
-    
-    // Clean up if index was a complex expression
-    if (index_expr != index_node->right->token) {
-        free(index_expr);
-    }
+    ir_emit_index(current_ir, result_temp, string_var, index_expr);
     
     return result_temp;
 }
@@ -1278,44 +1133,34 @@ char* generate_string_index(struct node* index_node) {
 // Generate 3AC for string slicing
 char* generate_string_slice(struct node* slice_node) {
     if (!slice_node || !slice_node->left || !slice_node->right) {
-        printf("    // ERROR: Invalid slice node\n");
-        return strdup("ERROR");
+        ir_emit_comment(current_ir, "ERROR: Invalid slice node");
+        return ATOM_ERROR;
     }
     
     char* string_var = slice_node->left->token;  // The string variable
     
     // Initialize default values
-    char* start_expr = strdup("0");   // Default start
-    char* end_expr = strdup("-1");    // Default end (full length)
-    int need_free_start = 1;
-    int need_free_end = 1;
+    char* start_expr = ATOM_ZERO;      // Default start
+    char* end_expr = ATOM_MINUS_ONE;   // Default end (full length)
     
     // Extract start and end indices from the slice structure
     if (slice_node->right) {
         if (slice_node->right->left) {
             char* temp_start = generate_expression(slice_node->right->left);
             if (temp_start) {
-                if (need_free_start) free(start_expr);
                 start_expr = temp_start;
-                need_free_start = (temp_start != slice_node->right->left->token);
             }
         }
         if (slice_node->right->right) {
             char* temp_end = generate_expression(slice_node->right->right);
             if (temp_end) {
-                if (need_free_end) free(end_expr);
                 end_expr = temp_end;
-                need_free_end = (temp_end != slice_node->right->right->token);
             }
         }
     }
     
     char* result_temp = new_temp();
-    printf("    %s = %s[%s:%s]\n", result_temp, string_var, start_expr, end_expr);
-    
-    // Clean up
-    if (need_free_start && start_expr) free(start_expr);
-    if (need_free_end && end_expr) free(end_expr);
+    ir_emit_slice(current_ir, result_temp, string_var, start_expr, end_expr);
     
     return result_temp;
 }
@@ -1327,9 +1172,9 @@ char* generate_string_slice_step(struct node* slice_step_node) {
     char* string_var = slice_step_node->left->token;  // The string variable
     
     // Extract start, end, and step from the complex structure
-    char* start_expr = "0";   // Default start
-    char* end_expr = "-1";    // Default end
-    char* step_expr = "1";    // Default step
+    char* start_expr = ATOM_ZERO;       // Default start
+    char* end_expr = ATOM_MINUS_ONE;    // Default end
+    char* step_expr = intern("1");      // Default step
     
     if (slice_step_node->right) {
         // slice_step structure: right -> (left: (start, end), right: step)
@@ -1347,7 +1192,7 @@ char* generate_string_slice_step(struct node* slice_step_node) {
     }
     
     char* result_temp = new_temp();
-    printf("    %s = %s[%s:%s:%s]\n", result_temp, string_var, start_expr, end_expr, step_expr);
+    ir_emit_slice_step(current_ir, result_temp, string_var, start_expr, end_expr, step_expr);
     
     return result_temp;
 }
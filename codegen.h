@@ -2,6 +2,8 @@
 #define CODEGEN_H
 
 #include "semantic_analysis.h"
+#include "ir.h"
+#include "callgraph.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -18,6 +20,9 @@ struct scope;
 
 extern int temp_counter;
 extern int label_counter;
+extern ir_program generated_program;
+extern ir_function* current_ir;
+extern call_graph program_calls;
 
 
 char* new_temp(void);
@@ -38,18 +43,6 @@ void process_ast_functions(struct node* node);
 void generate_function(struct node* func);
 void generate_function_body(struct node* body);
 
-// Stack size calculation
-int calculate_function_stack_size(struct node* func);
-struct node* find_params_node(struct node* func);
-struct node* search_for_params(struct node* node);
-int calculate_params_size(struct node* params_node);
-int calculate_param_types_size(struct node* node);
-int count_parameters_under_type(struct node* type_node);
-int count_param_names(struct node* node);
-int get_type_from_string(char* type_str);
-int get_type_size(int type);
-int is_valid_param_name(char* token);
-
 // ============================================================================
 // STATEMENT GENERATION
 // ============================================================================
@@ -76,6 +69,11 @@ void generate_return_statement(struct node* return_node);
 // CONTROL FLOW GENERATION
 // ============================================================================
 
+// Conditions in control context (branch-fused under -O)
+char* generate_condition(struct node* cond);
+void generate_false_jump(struct node* cond, char* condition_result, char* label);
+void generate_branch(struct node* cond, char* label, int jump_if);
+
 // Basic control structures
 void generate_simple_if(struct node* if_node);
 void generate_if_else(struct node* if_else_node);
@@ -108,6 +106,7 @@ char* generate_expression(struct node* expr);
 char* generate_binary_operation(struct node* expr);
 
 // Logical operations (with short-circuit evaluation)
+char* literal_bool_operand(struct node* expr);
 char* generate_logical_and(struct node* expr);
 char* generate_logical_or(struct node* expr);
 char* generate_logical_not(struct node* expr);
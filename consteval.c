@@ -0,0 +1,333 @@
+#include <stdint.h>
+#include "consteval.h"
+#include "inline.h"
+#include "optimize.h"
+#include "frame.h"
+
+// One evaluated call; result is NULL when the call could not be folded
+typedef struct memo_entry {
+    char* callee;
+    char** args;
+    int arg_count;
+    char* result;
+    struct memo_entry* next;
+} memo_entry;
+
+static memo_entry* memo[CONSTEVAL_MEMO_BUCKETS];
+
+// What a void function returns to the evaluator
+static char void_result[] = "";
+
+// Budget shared by the activations of one folded call
+typedef struct eval_state {
+    ir_program* program;
+    int steps;
+    constant_call_stats* stats;
+} eval_state;
+
+static char* evaluate_call(eval_state* state, char* callee, char** args, int arg_count, int depth);
+
+// Operands are interned, so the key hashes by address
+static unsigned memo_bucket(char* callee, char** args, int arg_count) {
+    uintptr_t hash = (uintptr_t)callee;
+    for (int a = 0; a < arg_count; a++) {
+        hash = hash * 31 + (uintptr_t)args[a];
+    }
+    return (unsigned)((hash >> 4) % CONSTEVAL_MEMO_BUCKETS);
+}
+
+static memo_entry* memo_find(char* callee, char** args, int arg_count) {
+    memo_entry* entry = memo[memo_bucket(callee, args, arg_count)];
+    for (; entry; entry = entry->next) {
+        if (entry->callee != callee || entry->arg_count != arg_count) continue;
+        if (arg_count == 0 || memcmp(entry->args, args, arg_count * sizeof(char*)) == 0) return entry;
+    }
+    return NULL;
+}
+
+static void memo_add(char* callee, char** args, int arg_count, char* result) {
+    unsigned bucket = memo_bucket(callee, args, arg_count);
+    memo_entry* entry = (memo_entry*)malloc(sizeof(memo_entry));
+    entry->callee = callee;
+    entry->args = (char**)malloc((arg_count + 1) * sizeof(char*));
+    memcpy(entry->args, args, arg_count * sizeof(char*));
+    entry->arg_count = arg_count;
+    entry->result = result;
+    entry->next = memo[bucket];
+    memo[bucket] = entry;
+}
+
+void release_constant_calls(void) {
+    for (int b = 0; b < CONSTEVAL_MEMO_BUCKETS; b++) {
+        memo_entry* entry = memo[b];
+        while (entry) {
+            memo_entry* next = entry->next;
+            free(entry->args);
+            free(entry);
+            entry = next;
+        }
+        memo[b] = NULL;
+    }
+}
+
+// ============================================================================
+// ACTIVATIONS
+// ============================================================================
+
+// Values of one running call: parameters, then locals, then temporaries
+typedef struct activation {
+    ir_function* fn;
+    function_info* info;
+    char** values;
+    int variable_count;
+} activation;
+
+// Slot of a name in the activation, -1 for a global
+static int slot_of(activation* frame, char* name) {
+    int t = ir_temp_number(frame->fn, name);
+    if (t) return frame->variable_count + t - 1;
+    function_info* info = frame->info;
+    for (int v = 0; v < info->param_count; v++) {
+        if (info->param_names[v] == name) return v;
+    }
+    for (int v = 0; v < info->local_count; v++) {
+        if (info->local_names[v] == name) return info->param_count + v;
+    }
+    return -1;
+}
+
+// Literal value of an operand, NULL if it has none yet or is a global
+static char* read_operand(activation* frame, char* operand) {
+    if (!operand || !ir_is_variable(operand)) return operand;
+    int slot = slot_of(frame, operand);
+    return slot < 0 ? NULL : frame->values[slot];
+}
+
+static int write_operand(activation* frame, char* name, char* value) {
+    int slot = slot_of(frame, name);
+    if (slot < 0 || !value) return 0;
+    frame->values[slot] = value;
+    return 1;
+}
+
+// Run the code of one activation; NULL if it cannot be evaluated
+static char* run_activation(eval_state* state, activation* frame, int depth) {
+    ir_function* fn = frame->fn;
+    int* label_at = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        label_at[l] = -1;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        if (fn->code[i].opcode != IR_LABEL) continue;
+        int label = ir_label_number(fn, fn->code[i].target);
+        if (label) label_at[label] = i;
+    }
+
+    char** pushed = (char**)malloc((fn->count + 1) * sizeof(char*));
+    int pushed_count = 0;
+    char* result = NULL;
+    int pc = 0;
+    while (1) {
+        if (pc >= fn->count) {
+            result = void_result;
+            break;
+        }
+        if (++state->steps > CONSTEVAL_MAX_STEPS) break;
+        quad* q = &fn->code[pc++];
+        char* a = read_operand(frame, q->args[0]);
+        char* b = read_operand(frame, q->args[1]);
+        if ((q->args[0] && !a) || (q->args[1] && !b)) break;
+
+        int ok = 1;
+        switch (q->opcode) {
+            case IR_LABEL:
+            case IR_COMMENT:
+            case IR_POP_PARAMS:
+                break;
+            case IR_COPY:
+                ok = write_operand(frame, q->result, a);
+                break;
+            case IR_BINARY:
+                ok = write_operand(frame, q->result, fold_binary(q->op, a, b));
+                break;
+            case IR_NOT:
+                ok = write_operand(frame, q->result, fold_not(a));
+                break;
+            case IR_GOTO:
+                pc = label_at[ir_label_number(fn, q->target)];
+                ok = pc >= 0;
+                break;
+            case IR_IF_FALSE:
+            case IR_IF_TRUE: {
+                char* condition = q->op != OP_NONE ? fold_binary(q->op, a, b) : a;
+                if (!is_bool_literal(condition)) {
+                    ok = 0;
+                } else if (bool_literal_value(condition) == (q->opcode == IR_IF_TRUE)) {
+                    pc = label_at[ir_label_number(fn, q->target)];
+                    ok = pc >= 0;
+                }
+                break;
+            }
+            case IR_SWITCH: {
+                if (!is_int_literal(a)) {
+                    ok = 0;
+                    break;
+                }
+                long long index = strtoll(a, NULL, 10) - strtoll(b, NULL, 10);
+                char* target = index >= 0 && index < q->value ? q->cases[index] : q->target;
+                pc = label_at[ir_label_number(fn, target)];
+                ok = pc >= 0;
+                break;
+            }
+            case IR_PUSH_PARAM:
+                pushed[pushed_count++] = a;
+                break;
+            case IR_LCALL:
+            case IR_CALL:
+            case IR_TAIL_CALL: {
+                int bytes = q->opcode == IR_TAIL_CALL ? q->value :
+                            pc < fn->count && fn->code[pc].opcode == IR_POP_PARAMS ? fn->code[pc].value : 0;
+                int arg_count = bytes / FRAME_SLOT_SIZE;
+                if (arg_count > pushed_count) {
+                    ok = 0;
+                    break;
+                }
+                pushed_count -= arg_count;
+                char* value = evaluate_call(state, q->target, &pushed[pushed_count], arg_count, depth + 1);
+                if (!value || (q->opcode == IR_LCALL && value == void_result)) {
+                    ok = 0;
+                } else if (q->opcode == IR_TAIL_CALL) {
+                    result = value;
+                } else if (q->opcode == IR_LCALL) {
+                    ok = write_operand(frame, q->result, value);
+                }
+                break;
+            }
+            case IR_RETURN:
+                result = a ? a : void_result;
+                break;
+            default:
+                // String indexing and slicing
+                ok = 0;
+                break;
+        }
+        if (!ok || result) break;
+    }
+
+    free(label_at);
+    free(pushed);
+    return result;
+}
+
+static char* evaluate_call(eval_state* state, char* callee, char** args, int arg_count, int depth) {
+    memo_entry* known = memo_find(callee, args, arg_count);
+    if (known) {
+        state->stats->memo_hits++;
+        return known->result;
+    }
+    if (depth > CONSTEVAL_MAX_DEPTH || state->steps > CONSTEVAL_MAX_STEPS) return NULL;
+
+    activation frame;
+    frame.fn = ir_find_function(state->program, callee);
+    frame.info = find_function_by_name(callee);
+    if (!frame.fn || !frame.info || arg_count > frame.info->param_count) return NULL;
+
+    function_info* info = frame.info;
+    frame.variable_count = info->param_count + info->local_count;
+    frame.values = (char**)calloc(frame.variable_count + frame.fn->temp_count + 1, sizeof(char*));
+    char* result = NULL;
+    int bound = 1;
+    for (int p = 0; p < info->param_count; p++) {
+        frame.values[p] = p < arg_count ? args[p] : default_argument(info, p);
+        if (!frame.values[p]) bound = 0;
+    }
+    if (bound) result = run_activation(state, &frame, depth);
+    free(frame.values);
+
+    // Running out of budget says nothing about the call itself
+    if (result || state->steps <= CONSTEVAL_MAX_STEPS) memo_add(callee, args, arg_count, result);
+    return result;
+}
+
+// ============================================================================
+// FOLDING CALL SITES
+// ============================================================================
+
+void evaluate_constant_calls(ir_program* program, ir_function* fn, constant_call_stats* stats) {
+    memset(stats, 0, sizeof(constant_call_stats));
+    if (fn->count == 0) return;
+
+    // Temporaries written exactly once, and their literal value once known
+    int* defs = (int*)calloc(fn->temp_count + 1, sizeof(int));
+    char** known = (char**)calloc(fn->temp_count + 1, sizeof(char*));
+    for (int i = 0; i < fn->count; i++) {
+        int t = ir_temp_number(fn, fn->code[i].result);
+        if (t) defs[t]++;
+    }
+
+    int site_count = 0;
+    call_site* sites = find_call_sites(fn, &site_count);
+    char* removed = (char*)calloc(fn->count + 1, 1);
+    char** args = (char**)malloc((fn->count + 1) * sizeof(char*));
+    eval_state state;
+    state.program = program;
+    state.stats = stats;
+
+    int next_site = 0;
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        int t = ir_temp_number(fn, q->result);
+        if (t && defs[t] == 1 && q->opcode == IR_COPY && !ir_is_variable(q->args[0])) known[t] = q->args[0];
+        if (next_site >= site_count || sites[next_site].call != i) continue;
+
+        call_site* site = &sites[next_site++];
+        int literal = 1;
+        for (int a = 0; a < site->arg_count; a++) {
+            char* arg = fn->code[site->pushes[a]].args[0];
+            int at = ir_temp_number(fn, arg);
+            args[a] = at && known[at] ? known[at] : arg;
+            if (ir_is_variable(args[a])) literal = 0;
+        }
+        if (!literal) continue;
+
+        state.steps = 0;
+        char* value = evaluate_call(&state, q->target, args, site->arg_count, 0);
+        if (!value || (q->opcode == IR_LCALL && value == void_result)) continue;
+
+        stats->folded++;
+        char text[128];
+        int length = snprintf(text, sizeof(text), "%s(", q->target);
+        for (int a = 0; a < site->arg_count && length < (int)sizeof(text); a++) {
+            length += snprintf(text + length, sizeof(text) - length, "%s%s", a ? ", " : "", args[a]);
+        }
+        ir_add_note(fn, "eval: %s) = %s", text, value == void_result ? "(no value)" : value);
+        for (int a = 0; a < site->arg_count; a++) {
+            removed[site->pushes[a]] = 1;
+        }
+        if (site->pop >= 0) removed[site->pop] = 1;
+        if (q->opcode == IR_LCALL) {
+            ir_make_copy(q, value);
+            if (t && defs[t] == 1) known[t] = value;
+        } else if (q->opcode == IR_TAIL_CALL) {
+            q->opcode = IR_RETURN;
+            q->target = NULL;
+            q->args[0] = value == void_result ? NULL : value;
+        } else {
+            removed[i] = 1;
+        }
+    }
+
+    if (stats->folded > 0) {
+        int kept = 0;
+        for (int i = 0; i < fn->count; i++) {
+            if (!removed[i]) fn->code[kept++] = fn->code[i];
+        }
+        fn->count = kept;
+    }
+
+    release_call_sites(sites, site_count);
+    free(defs);
+    free(known);
+    free(removed);
+    free(args);
+}
@@ -0,0 +1,39 @@
+#ifndef CONSTEVAL_H
+#define CONSTEVAL_H
+
+#include "semantic_analysis.h"
+#include "ir.h"
+
+// ============================================================================
+// COMPILE-TIME EVALUATION OF CALLS
+// ============================================================================
+// A call whose arguments are all literals is run at compile time over the
+// callee's 3AC, which is final because every callee is generated before
+// its callers. Values are interned literals and every operation goes
+// through the constant folders, so an operation they refuse to fold also
+// stops the evaluation. Parameters, locals and temporaries live in a frame
+// per activation; the signature and the defaults of left-out arguments
+// come from function_info. Reading or writing a global, string indexing
+// and calls to functions not generated yet make a function impure and
+// leave the call alone, as does running out of steps or depth.
+//
+// A call that returns becomes a copy of its result, a void call
+// disappears, and a TailCall becomes a return of the result. Results,
+// failures included, are memoized per callee and argument list for the
+// whole program.
+
+#define CONSTEVAL_MAX_STEPS 10000  // Instructions one folded call may run
+#define CONSTEVAL_MAX_DEPTH 64     // Nested activations
+#define CONSTEVAL_MEMO_BUCKETS 256
+
+typedef struct constant_call_stats {
+    int folded;           // Calls replaced by their result
+    int memo_hits;        // Evaluations answered by the memo table
+} constant_call_stats;
+
+void evaluate_constant_calls(ir_program* program, ir_function* fn, constant_call_stats* stats);
+
+// Free the memo table once the program is generated
+void release_constant_calls(void);
+
+#endif // CONSTEVAL_H
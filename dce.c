@@ -0,0 +1,213 @@
+#include <limits.h>
+#include "dce.h"
+#include "optimize.h"
+
+// Keep the quads flagged in keep, in order; returns how many were dropped
+static int compact_code(ir_function* fn, char* keep) {
+    int kept = 0;
+    for (int i = 0; i < fn->count; i++) {
+        if (keep[i]) fn->code[kept++] = fn->code[i];
+    }
+    int removed = fn->count - kept;
+    fn->count = kept;
+    return removed;
+}
+
+int remove_unreachable_code(ir_function* fn) {
+    if (fn->count == 0) return 0;
+
+    cfg graph;
+    cfg_build(&graph, fn);
+
+    char* reached = (char*)calloc(graph.count, 1);
+    int* worklist = (int*)malloc(graph.count * sizeof(int));
+    int count = 0;
+    reached[0] = 1;
+    worklist[count++] = 0;
+    while (count > 0) {
+        basic_block* block = &graph.blocks[worklist[--count]];
+        for (int s = 0; s < block->succ_count; s++) {
+            if (reached[block->succs[s]]) continue;
+            reached[block->succs[s]] = 1;
+            worklist[count++] = block->succs[s];
+        }
+    }
+
+    char* keep = (char*)malloc(fn->count);
+    for (int b = 0; b < graph.count; b++) {
+        for (int i = graph.blocks[b].first; i <= graph.blocks[b].last; i++) {
+            keep[i] = reached[b];
+        }
+    }
+    int removed = compact_code(fn, keep);
+
+    free(keep);
+    free(reached);
+    free(worklist);
+    cfg_release(&graph);
+    return removed;
+}
+
+// Mark a name live and queue it the first time
+static void mark_live(ssa_form* ssa, char* operand, char* live, int* worklist, int* count) {
+    if (!ir_is_variable(operand)) return;
+    int v = ssa_name_index(ssa, operand);
+    if (live[v]) return;
+    live[v] = 1;
+    worklist[(*count)++] = v;
+}
+
+// Mark and sweep over the SSA names: everything an instruction with an
+// effect reads is live, and so is everything a live definition reads
+int remove_dead_assignments(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    int names = ssa->name_count;
+
+    // Where each name is defined: a quad index, or ~block for a phi
+    int* def_site = (int*)malloc(names * sizeof(int));
+    char* live = (char*)calloc(names, 1);
+    int* worklist = (int*)malloc((names + 1) * sizeof(int));
+    int count = 0;
+    for (int v = 0; v < names; v++) {
+        def_site[v] = INT_MIN;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        if (ir_is_variable(fn->code[i].result)) {
+            def_site[ssa_name_index(ssa, fn->code[i].result)] = i;
+        }
+    }
+    for (int b = 0; b < graph->count; b++) {
+        for (int p = 0; p < ssa->blocks[b].phi_count; p++) {
+            def_site[ssa_name_index(ssa, ssa->blocks[b].phis[p].result)] = ~b;
+        }
+    }
+
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        if (is_pure_definition(q)) continue;
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            mark_live(ssa, q->args[a], live, worklist, &count);
+        }
+    }
+
+    while (count > 0) {
+        int v = worklist[--count];
+        int site = def_site[v];
+        if (site == INT_MIN) continue;
+
+        if (site >= 0) {
+            for (int a = 0; a < IR_MAX_ARGS; a++) {
+                mark_live(ssa, fn->code[site].args[a], live, worklist, &count);
+            }
+            continue;
+        }
+
+        ssa_block* info = &ssa->blocks[~site];
+        for (int p = 0; p < info->phi_count; p++) {
+            phi_node* phi = &info->phis[p];
+            if (phi->result != ssa->names[v].name) continue;
+            for (int k = 0; k < graph->blocks[~site].pred_count; k++) {
+                mark_live(ssa, phi->args[k], live, worklist, &count);
+            }
+        }
+    }
+
+    // Sweep the quads, keeping the block ranges of the graph in step
+    char* keep = (char*)malloc(fn->count + 1);
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        keep[i] = !is_pure_definition(q) || !ir_is_variable(q->result) ||
+                  live[ssa_name_index(ssa, q->result)];
+    }
+    int kept = 0;
+    for (int b = 0; b < graph->count; b++) {
+        basic_block* block = &graph->blocks[b];
+        int first = kept;
+        for (int i = block->first; i <= block->last; i++) {
+            if (keep[i]) kept++;
+        }
+        block->first = first;
+        block->last = kept - 1;
+    }
+    int removed = compact_code(fn, keep);
+
+    for (int b = 0; b < graph->count; b++) {
+        ssa_block* info = &ssa->blocks[b];
+        int phis = 0;
+        for (int p = 0; p < info->phi_count; p++) {
+            if (live[ssa_name_index(ssa, info->phis[p].result)]) {
+                info->phis[phis++] = info->phis[p];
+            } else {
+                free(info->phis[p].args);
+                ssa->phi_total--;
+            }
+        }
+        info->phi_count = phis;
+    }
+
+    free(def_site);
+    free(live);
+    free(worklist);
+    free(keep);
+    return removed;
+}
+
+// Outside SSA: a temporary no instruction reads is dead wherever it is
+// written, and deleting its pure definition may leave the temporaries
+// that definition read unread in turn
+int remove_dead_temporaries(ir_function* fn) {
+    int* reads = (int*)calloc(fn->temp_count + 1, sizeof(int));
+    for (int i = 0; i < fn->count; i++) {
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            reads[ir_temp_number(fn, fn->code[i].args[a])]++;
+        }
+    }
+
+    char* keep = (char*)malloc(fn->count + 1);
+    memset(keep, 1, fn->count + 1);
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = fn->count - 1; i >= 0; i--) {
+            quad* q = &fn->code[i];
+            int t = ir_temp_number(fn, q->result);
+            if (!keep[i] || !t || reads[t] > 0 || !is_pure_definition(q)) continue;
+            keep[i] = 0;
+            changed = 1;
+            for (int a = 0; a < IR_MAX_ARGS; a++) {
+                reads[ir_temp_number(fn, q->args[a])]--;
+            }
+        }
+    }
+
+    int removed = compact_code(fn, keep);
+    free(reads);
+    free(keep);
+    return removed;
+}
+
+// A jump is redundant when its target is among the labels right after it.
+// Scanning backwards lets a removal expose the jump before it.
+int remove_redundant_jumps(ir_function* fn) {
+    char* keep = (char*)malloc(fn->count + 1);
+    memset(keep, 1, fn->count + 1);
+
+    for (int i = fn->count - 1; i >= 0; i--) {
+        quad* q = &fn->code[i];
+        if (!is_jump_opcode(q->opcode)) continue;
+
+        for (int j = i + 1; j < fn->count; j++) {
+            if (!keep[j] || fn->code[j].opcode == IR_COMMENT) continue;
+            if (fn->code[j].opcode != IR_LABEL) break;
+            if (fn->code[j].target == q->target) {
+                keep[i] = 0;
+                break;
+            }
+        }
+    }
+
+    int removed = compact_code(fn, keep);
+    free(keep);
+    return removed;
+}
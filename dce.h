@@ -0,0 +1,24 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "ssa.h"
+
+// ============================================================================
+// DEAD CODE ELIMINATION
+// ============================================================================
+// Each pass returns the number of instructions it removed.
+// remove_unreachable_code drops the blocks no path from the entry reaches,
+// such as the "goto end" generated after a return.
+// remove_dead_assignments works on SSA form: a pure definition whose value
+// no return, jump, parameter push or live definition reads is deleted.
+// Calls always stay, and so do operations that may trap.
+// remove_dead_temporaries does the same for temporaries after SSA is gone,
+// for the passes that run late and leave unread temporaries behind.
+// remove_redundant_jumps deletes jumps to a label that follows directly.
+
+int remove_unreachable_code(ir_function* fn);
+int remove_dead_assignments(ssa_form* ssa);
+int remove_dead_temporaries(ir_function* fn);
+int remove_redundant_jumps(ir_function* fn);
+
+#endif // DCE_H
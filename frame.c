@@ -0,0 +1,102 @@
+#include "frame.h"
+#include "ir.h"
+
+// Append a slot at the next aligned offset
+static void add_slot(frame_layout* layout, char* name, slot_kind kind, int type) {
+    frame_slot* slot = &layout->slots[layout->count++];
+    slot->name = name;
+    slot->kind = kind;
+    slot->type = type;
+    slot->offset = layout->size;
+    layout->size += FRAME_SLOT_SIZE;
+}
+
+// Slot of a name in an open-addressing set keyed on the interned pointer:
+// where it is, or the empty slot where it goes
+static unsigned int find_name(char** set, unsigned int mask, char* name) {
+    unsigned int index = hash_name(name) & mask;
+    while (set[index] && set[index] != name) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+// Lay out the frame from the parameters and locals recorded by semantic
+// analysis and the number of temporaries the generated code uses.
+// A name declared in several blocks of one function is one variable in
+// the 3AC and gets a single slot.
+void layout_frame(frame_layout* layout, function_info* info, int temp_count, ir_function* code) {
+    int params = info ? info->param_count : 0;
+    int locals = info ? info->local_count : 0;
+
+    memset(layout, 0, sizeof(frame_layout));
+    layout->slots = (frame_slot*)malloc((params + locals + temp_count + 1) * sizeof(frame_slot));
+
+    // Declared names; needed is 1 for the ones that want a slot and 2 once
+    // they have it. Parameters always keep theirs, the caller pushes them.
+    int capacity = 8;
+    while (capacity < 2 * (params + locals)) capacity *= 2;
+    char** seen = (char**)calloc(capacity, sizeof(char*));
+    char* needed = (char*)calloc(capacity, 1);
+    unsigned int mask = capacity - 1;
+
+    for (int i = 0; i < params + locals; i++) {
+        char* name = i < params ? info->param_names[i] : info->local_names[i - params];
+        unsigned int index = find_name(seen, mask, name);
+        seen[index] = name;
+        if (i < params || !code) needed[index] = 1;
+    }
+    for (int i = 0; code && i < code->count; i++) {
+        quad* q = &code->code[i];
+        for (int a = -1; a < IR_MAX_ARGS; a++) {
+            char* operand = a < 0 ? q->result : q->args[a];
+            if (!operand) continue;
+            unsigned int index = find_name(seen, mask, operand);
+            if (seen[index]) needed[index] = 1;
+        }
+    }
+
+    for (int i = 0; i < params + locals; i++) {
+        char* name = i < params ? info->param_names[i] : info->local_names[i - params];
+        unsigned int index = find_name(seen, mask, name);
+        if (needed[index] != 1) continue;
+        needed[index] = 2;
+
+        if (i < params) {
+            add_slot(layout, name, SLOT_PARAM, info->param_types[i]);
+            layout->param_count++;
+        } else {
+            add_slot(layout, name, SLOT_LOCAL, info->local_types[i - params]);
+            layout->local_count++;
+        }
+    }
+    free(seen);
+    free(needed);
+
+    for (int t = 1; t <= temp_count; t++) {
+        add_slot(layout, ir_temp_name(t), SLOT_TEMP, 0);
+    }
+    layout->temp_count = temp_count;
+}
+
+frame_slot* find_frame_slot(frame_layout* layout, char* name) {
+    for (int i = 0; i < layout->count; i++) {
+        if (layout->slots[i].name == name) {
+            return &layout->slots[i];
+        }
+    }
+    return NULL;
+}
+
+void print_frame_layout(FILE* out, frame_layout* layout) {
+    static const char* kind_names[] = {"param", "local", "temp"};
+    for (int i = 0; i < layout->count; i++) {
+        frame_slot* slot = &layout->slots[i];
+        fprintf(out, "    [%4d] %-5s %s\n", slot->offset, kind_names[slot->kind], slot->name);
+    }
+}
+
+void release_frame_layout(frame_layout* layout) {
+    free(layout->slots);
+    memset(layout, 0, sizeof(frame_layout));
+}
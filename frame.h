@@ -0,0 +1,51 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include "semantic_analysis.h"
+
+// ============================================================================
+// FRAME LAYOUT
+// ============================================================================
+// Every parameter, local variable and temporary of a function gets its own
+// slot. All slots are 8 bytes, so a float or a string pointer fits as well
+// as an int or a bool, and every offset is aligned for 64-bit access.
+// Laid out from the final code of an optimized function, a local the
+// code no longer names gets no slot.
+
+#define FRAME_SLOT_SIZE 8
+
+typedef enum slot_kind {
+    SLOT_PARAM,
+    SLOT_LOCAL,
+    SLOT_TEMP
+} slot_kind;
+
+typedef struct frame_slot {
+    char* name;           // Interned variable or temporary name
+    slot_kind kind;
+    int type;             // TYPE_* of the variable, 0 for temporaries
+    int offset;           // Byte offset from the start of the frame
+} frame_slot;
+
+typedef struct frame_layout {
+    frame_slot* slots;    // Parameters, then locals, then temporaries
+    int count;
+    int param_count;
+    int local_count;
+    int temp_count;
+    int size;             // Bytes reserved by BeginFunc
+} frame_layout;
+
+// ============================================================================
+// CONSTRUCTION AND RELEASE
+// ============================================================================
+
+struct ir_function;
+
+// code is the final code of the function, or NULL to keep every local
+void layout_frame(frame_layout* layout, function_info* info, int temp_count, struct ir_function* code);
+frame_slot* find_frame_slot(frame_layout* layout, char* name);
+void print_frame_layout(FILE* out, frame_layout* layout);
+void release_frame_layout(frame_layout* layout);
+
+#endif // FRAME_H
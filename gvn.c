@@ -0,0 +1,244 @@
+#include <stdint.h>
+#include "gvn.h"
+#include "optimize.h"
+#include "simplify.h"
+
+// One computed expression; operands are value numbers, i.e. leader names
+// or literals, so equal expressions have equal keys
+typedef struct expression {
+    ir_opcode opcode;
+    ir_op op;
+    char* args[IR_MAX_ARGS];
+    char* result;         // Name holding the value, NULL for an empty slot
+    int block;            // Block that computed it
+} expression;
+
+typedef struct value_table {
+    expression* slots;
+    int capacity;         // Power of two
+    int* undo;            // Slots filled, in order, for scoped removal
+    int undo_count;
+    int undo_capacity;
+} value_table;
+
+static unsigned int hash_expression(expression* e) {
+    uintptr_t h = (uintptr_t)e->opcode * 31u + (uintptr_t)e->op;
+    for (int a = 0; a < IR_MAX_ARGS; a++) {
+        h = h * 1000003u ^ (uintptr_t)e->args[a];
+    }
+    return (unsigned int)(h ^ (h >> 17));
+}
+
+static int same_expression(expression* a, expression* b) {
+    if (a->opcode != b->opcode || a->op != b->op) return 0;
+    for (int i = 0; i < IR_MAX_ARGS; i++) {
+        if (a->args[i] != b->args[i]) return 0;
+    }
+    return 1;
+}
+
+// Slot holding e, or the empty slot where it would go
+static int find_slot(value_table* table, expression* e) {
+    int mask = table->capacity - 1;
+    int slot = hash_expression(e) & mask;
+    while (table->slots[slot].result && !same_expression(&table->slots[slot], e)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Entries are removed in the reverse order they were added, which keeps
+// every remaining probe sequence intact
+static void insert_expression(value_table* table, int slot, expression* e) {
+    table->slots[slot] = *e;
+    if (table->undo_count == table->undo_capacity) {
+        table->undo_capacity = table->undo_capacity ? table->undo_capacity * 2 : 64;
+        table->undo = (int*)realloc(table->undo, table->undo_capacity * sizeof(int));
+    }
+    table->undo[table->undo_count++] = slot;
+}
+
+// Value number of an operand: its leader name, or the literal it holds
+static char* value_of(ssa_form* ssa, char** values, char* operand) {
+    if (!ir_is_variable(operand)) return operand;
+    char* value = values[ssa_name_index(ssa, operand)];
+    return value ? value : operand;
+}
+
+static int is_numbered(quad* q) {
+    switch (q->opcode) {
+        case IR_BINARY:
+        case IR_NOT:
+        case IR_INDEX:
+        case IR_SLICE:
+        case IR_SLICE_STEP:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// a op b == b op a; + on strings concatenates, so it only commutes on numbers
+static int commutes(quad* q) {
+    if (q->opcode != IR_BINARY) return 0;
+    if (q->op == OP_EQ || q->op == OP_NE) return 1;
+    return (q->op == OP_ADD || q->op == OP_MUL) && (q->type == TYPE_INT || q->type == TYPE_FLOAT);
+}
+
+// Give the phis of a block their values: a phi whose operands (other than
+// itself) all have one value is that value, and a phi with the same
+// operands as an earlier phi of the block is that phi
+static void number_phis(ssa_form* ssa, char** values, int block_id, value_numbering_stats* stats) {
+    ssa_block* info = &ssa->blocks[block_id];
+    int preds = ssa->graph.blocks[block_id].pred_count;
+
+    for (int p = 0; p < info->phi_count; p++) {
+        phi_node* phi = &info->phis[p];
+        char* common = NULL;
+        int meaningless = 1;
+        for (int k = 0; k < preds && meaningless; k++) {
+            char* arg = phi->args[k] ? value_of(ssa, values, phi->args[k]) : NULL;
+            if (arg == phi->result) continue;
+            if (!arg || (common && arg != common)) meaningless = 0;
+            common = arg;
+        }
+        if (meaningless && common) {
+            values[ssa_name_index(ssa, phi->result)] = common;
+            stats->phis++;
+            continue;
+        }
+
+        for (int e = 0; e < p; e++) {
+            phi_node* earlier = &info->phis[e];
+            int same = 1;
+            for (int k = 0; k < preds && same; k++) {
+                if (!phi->args[k] || !earlier->args[k]) {
+                    same = 0;
+                } else if (value_of(ssa, values, phi->args[k]) != value_of(ssa, values, earlier->args[k])) {
+                    same = 0;
+                }
+            }
+            if (same) {
+                values[ssa_name_index(ssa, phi->result)] = value_of(ssa, values, earlier->result);
+                stats->phis++;
+                break;
+            }
+        }
+    }
+}
+
+static void number_quad(ssa_form* ssa, value_table* table, char** values, quad* q, int block_id,
+                        value_numbering_stats* stats) {
+    for (int a = 0; a < IR_MAX_ARGS; a++) {
+        q->args[a] = value_of(ssa, values, q->args[a]);
+    }
+    if (!ir_is_variable(q->result)) return;
+    int result = ssa_name_index(ssa, q->result);
+
+    if (q->opcode == IR_COPY) {
+        values[result] = q->args[0];
+        return;
+    }
+    if (!is_numbered(q)) return;
+
+    char* folded = NULL;
+    if (q->opcode == IR_BINARY) folded = fold_binary(q->op, q->args[0], q->args[1]);
+    if (q->opcode == IR_NOT) folded = fold_not(q->args[0]);
+    if (folded) {
+        ir_make_copy(q, folded);
+        values[result] = folded;
+        stats->folded++;
+        return;
+    }
+    if (simplify_quad(q)) {
+        values[result] = q->args[0];
+        stats->simplified++;
+        return;
+    }
+
+    expression key;
+    memset(&key, 0, sizeof(key));
+    key.opcode = q->opcode;
+    key.op = q->op;
+    memcpy(key.args, q->args, sizeof(key.args));
+    if (commutes(q) && (uintptr_t)key.args[0] > (uintptr_t)key.args[1]) {
+        key.args[0] = q->args[1];
+        key.args[1] = q->args[0];
+    }
+
+    int slot = find_slot(table, &key);
+    expression* found = &table->slots[slot];
+    if (found->result) {
+        if (found->block == block_id) {
+            stats->local++;
+        } else {
+            stats->global++;
+        }
+        values[result] = found->result;
+        ir_make_copy(q, found->result);
+        return;
+    }
+
+    key.result = q->result;
+    key.block = block_id;
+    insert_expression(table, slot, &key);
+}
+
+void number_values(ssa_form* ssa, value_numbering_stats* stats) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    memset(stats, 0, sizeof(value_numbering_stats));
+
+    char** values = (char**)calloc(ssa->name_count + 1, sizeof(char*));
+    value_table table;
+    memset(&table, 0, sizeof(table));
+    table.capacity = 64;
+    while (table.capacity < 2 * fn->count + 16) table.capacity *= 2;
+    table.slots = (expression*)calloc(table.capacity, sizeof(expression));
+
+    // Preorder walk of the dominator tree; ~mark frames pop a block's scope
+    int* frames = (int*)malloc((2 * graph->count + 1) * sizeof(int));
+    int frame_count = 0;
+    frames[frame_count++] = 0;
+
+    while (frame_count > 0) {
+        int frame = frames[--frame_count];
+        if (frame < 0) {
+            int mark = ~frame;
+            while (table.undo_count > mark) {
+                table.slots[table.undo[--table.undo_count]].result = NULL;
+            }
+            continue;
+        }
+
+        basic_block* block = &graph->blocks[frame];
+        ssa_block* info = &ssa->blocks[frame];
+        frames[frame_count++] = ~table.undo_count;
+
+        number_phis(ssa, values, frame, stats);
+        for (int i = block->first; i <= block->last; i++) {
+            number_quad(ssa, &table, values, &fn->code[i], frame, stats);
+        }
+
+        // This block's operand of each phi in its successors
+        for (int s = 0; s < block->succ_count; s++) {
+            basic_block* succ = &graph->blocks[block->succs[s]];
+            ssa_block* succ_info = &ssa->blocks[succ->id];
+            int slot = 0;
+            while (succ->preds[slot] != block->id) slot++;
+            for (int p = 0; p < succ_info->phi_count; p++) {
+                phi_node* phi = &succ_info->phis[p];
+                if (phi->args[slot]) phi->args[slot] = value_of(ssa, values, phi->args[slot]);
+            }
+        }
+
+        for (int c = info->child_count - 1; c >= 0; c--) {
+            frames[frame_count++] = info->children[c];
+        }
+    }
+
+    free(frames);
+    free(table.slots);
+    free(table.undo);
+    free(values);
+}
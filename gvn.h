@@ -0,0 +1,34 @@
+#ifndef GVN_H
+#define GVN_H
+
+#include "ssa.h"
+
+// ============================================================================
+// VALUE NUMBERING
+// ============================================================================
+// Dominator-based value numbering over SSA form. Blocks are visited down
+// the dominator tree with a scoped table of the expressions computed so
+// far, so a computation is reused from its own block (local value
+// numbering) or from any dominating block (global value numbering).
+// Because every SSA name is assigned once, a variable reassigned by
+// assignment or multiple assignment gets a new name and never matches
+// an expression computed from its old value.
+//
+// Arithmetic, comparisons, not, and string index/slice are numbered.
+// Copies and phis whose operands all have the same value are propagated,
+// operations whose operands become literals are folded, and identities
+// such as x * 1 that constants reveal are simplified. A redundant
+// instruction becomes a copy of the earlier result; dead code
+// elimination removes it when nothing reads it any more.
+
+typedef struct value_numbering_stats {
+    int local;            // Redundant in the block that computed the value first
+    int global;           // Redundant with a value from a dominating block
+    int folded;           // Evaluated at compile time
+    int simplified;       // Reduced to an operand by an algebraic identity
+    int phis;             // Phis found meaningless or equal to another phi
+} value_numbering_stats;
+
+void number_values(ssa_form* ssa, value_numbering_stats* stats);
+
+#endif // GVN_H
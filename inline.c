@@ -0,0 +1,341 @@
+#include "inline.h"
+#include "frame.h"
+#include "optimize.h"
+#include "cfg.h"
+
+int inline_limit = INLINE_DEFAULT_LIMIT;
+
+// Code copied into a call site, with the counters that tell its own
+// temporaries and labels apart from the caller's
+typedef struct inline_body {
+    ir_function* fn;
+    function_info* info;
+    quad* code;
+    int count;
+    int temp_count;
+    int label_count;
+    int size;             // Instructions other than labels and comments
+    int has_switch;       // Switches only appear once a function is final
+} inline_body;
+
+// Names of one inlined copy: callee operand -> caller operand
+typedef struct rename_map {
+    char** temps;         // By callee temporary number
+    char** labels;        // By callee label number
+    char** variables;     // Callee parameters, then locals
+} rename_map;
+
+static void init_body(inline_body* body, ir_function* fn, quad* code, int count) {
+    body->fn = fn;
+    body->info = find_function_by_name(fn->name);
+    body->code = code;
+    body->count = count;
+    body->temp_count = fn->temp_count;
+    body->label_count = fn->label_count;
+    body->size = 0;
+    body->has_switch = 0;
+    for (int i = 0; i < count; i++) {
+        if (code[i].opcode != IR_LABEL && code[i].opcode != IR_COMMENT) body->size++;
+        if (code[i].opcode == IR_SWITCH) body->has_switch = 1;
+    }
+}
+
+call_site* find_call_sites(ir_function* fn, int* site_count) {
+    call_site* sites = NULL;
+    int count = 0, capacity = 0;
+    int* pending = (int*)malloc((fn->count + 1) * sizeof(int));
+    int depth = 0;
+
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        if (q->opcode == IR_PUSH_PARAM) {
+            pending[depth++] = i;
+            continue;
+        }
+        if (q->opcode != IR_LCALL && q->opcode != IR_CALL && q->opcode != IR_TAIL_CALL) continue;
+
+        int pop = q->opcode != IR_TAIL_CALL && i + 1 < fn->count && fn->code[i + 1].opcode == IR_POP_PARAMS ? i + 1 : -1;
+        int args = q->opcode == IR_TAIL_CALL ? q->value / FRAME_SLOT_SIZE :
+                   pop >= 0 ? fn->code[pop].value / FRAME_SLOT_SIZE : 0;
+        if (args > depth) args = depth;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            sites = (call_site*)realloc(sites, capacity * sizeof(call_site));
+        }
+        call_site* site = &sites[count++];
+        site->call = i;
+        site->pop = pop;
+        site->arg_count = args;
+        site->pushes = (int*)malloc((args + 1) * sizeof(int));
+        site->params = NULL;
+        depth -= args;
+        memcpy(site->pushes, &pending[depth], args * sizeof(int));
+    }
+
+    free(pending);
+    *site_count = count;
+    return sites;
+}
+
+void release_call_sites(call_site* sites, int site_count) {
+    for (int s = 0; s < site_count; s++) {
+        free(sites[s].pushes);
+        free(sites[s].params);
+    }
+    free(sites);
+}
+
+char* default_argument(function_info* info, int p) {
+    node* value = info->has_default[p] ? info->default_values[p] : NULL;
+    if (!value) return NULL;
+    if (value->kind != NODE_NUMBER && value->kind != NODE_STRING && value->kind != NODE_BOOL) return NULL;
+    return convert_literal(value->token, info->param_types[p]);
+}
+
+// Why a call site cannot be inlined, NULL if it can
+static const char* check_call_site(call_site* site, inline_body* body) {
+    function_info* info = body->info;
+    if (!info) return "no signature";
+    if (body->has_switch) return "body has a switch";
+    if (site->arg_count > info->param_count) return "too many arguments";
+    for (int p = site->arg_count; p < info->param_count; p++) {
+        if (!info->has_default[p]) return "missing argument";
+        if (!default_argument(info, p)) return "default is not a literal";
+    }
+    return NULL;
+}
+
+static int call_site_cost(ir_function* fn, call_site* site, inline_body* body) {
+    int saved = site->arg_count + 1 + (site->pop >= 0);
+    int cost = body->size - saved;
+    for (int a = 0; a < site->arg_count; a++) {
+        char* arg = fn->code[site->pushes[a]].args[0];
+        if (!ir_is_variable(arg)) cost--;
+    }
+    return cost;
+}
+
+static char* rename_operand(inline_body* body, rename_map* map, ir_function* caller, char* operand) {
+    if (!ir_is_variable(operand)) return operand;
+
+    int t = ir_temp_number(body->fn, operand);
+    if (t && t <= body->temp_count) {
+        if (!map->temps[t]) map->temps[t] = ir_new_temp(caller);
+        return map->temps[t];
+    }
+
+    function_info* info = body->info;
+    for (int v = 0; v < info->param_count + info->local_count; v++) {
+        char* name = v < info->param_count ? info->param_names[v] : info->local_names[v - info->param_count];
+        if (name != operand) continue;
+        if (!map->variables[v]) map->variables[v] = ir_new_temp(caller);
+        return map->variables[v];
+    }
+    return operand;
+}
+
+static char* rename_label(inline_body* body, rename_map* map, ir_function* caller, char* label) {
+    int l = ir_label_number(body->fn, label);
+    if (!l || l > body->label_count) return label;
+    if (!map->labels[l]) map->labels[l] = ir_new_label(caller);
+    return map->labels[l];
+}
+
+// Append a renamed copy of the callee in place of call
+static void emit_inlined_body(ir_function* caller, quad* call, call_site* site, inline_body* body) {
+    function_info* info = body->info;
+    char* result = call->opcode == IR_LCALL ? call->result : NULL;
+    char* exit_label = ir_new_label(caller);
+
+    rename_map map;
+    map.temps = (char**)calloc(body->temp_count + 1, sizeof(char*));
+    map.labels = (char**)calloc(body->label_count + 1, sizeof(char*));
+    map.variables = (char**)calloc(info->param_count + info->local_count + 1, sizeof(char*));
+    for (int p = 0; p < info->param_count; p++) {
+        map.variables[p] = site->params[p];
+    }
+
+    // Parameters the call leaves out take their defaults
+    for (int p = site->arg_count; p < info->param_count; p++) {
+        ir_emit_copy(caller, site->params[p], default_argument(info, p), info->param_types[p]);
+    }
+
+    for (int i = 0; i < body->count; i++) {
+        quad q = body->code[i];
+        if (q.opcode == IR_COMMENT) continue;
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            q.args[a] = rename_operand(body, &map, caller, q.args[a]);
+        }
+        q.result = rename_operand(body, &map, caller, q.result);
+        if (q.opcode == IR_LABEL || is_jump_opcode(q.opcode)) {
+            q.target = rename_label(body, &map, caller, q.target);
+        }
+
+        if (q.opcode == IR_RETURN) {
+            if (result && q.args[0]) {
+                ir_emit_copy(caller, result, q.args[0], call->type);
+            }
+            if (i == body->count - 1) break;
+            ir_emit_goto(caller, exit_label);
+        } else if (q.opcode == IR_TAIL_CALL) {
+            // The copy is not in tail position, so the call comes back to it
+            if (result) {
+                char* value = ir_new_temp(caller);
+                ir_emit_lcall(caller, value, q.target, q.type);
+                if (q.value > 0) ir_emit_pop_params(caller, q.value);
+                ir_emit_copy(caller, result, value, call->type);
+            } else {
+                ir_emit_call(caller, q.target);
+                if (q.value > 0) ir_emit_pop_params(caller, q.value);
+            }
+            if (i == body->count - 1) break;
+            ir_emit_goto(caller, exit_label);
+        } else {
+            *ir_append(caller, q.opcode) = q;
+        }
+    }
+    ir_emit_label(caller, exit_label);
+
+    free(map.temps);
+    free(map.labels);
+    free(map.variables);
+}
+
+// One round: inline the chosen call sites of the code at the given depth.
+// Returns the number inlined and advances depths to the new layout.
+static int inline_round(ir_function* fn, inline_body* self, ir_program* program, int level,
+                        int** depths, int* growth, int growth_limit) {
+    int site_count = 0;
+    call_site* sites = find_call_sites(fn, &site_count);
+    inline_body* bodies = (inline_body*)calloc(site_count + 1, sizeof(inline_body));
+
+    // Decide, in code order
+    int chosen = 0;
+    for (int s = 0; s < site_count; s++) {
+        call_site* site = &sites[s];
+        char* callee = fn->code[site->call].target;
+        if ((*depths)[site->call] != level - 1 || fn->code[site->call].opcode == IR_TAIL_CALL) continue;
+
+        int recursive = strcmp(callee, fn->name) == 0;
+        if (level > 1 && !recursive) continue;
+        if (recursive) {
+            bodies[s] = *self;
+        } else {
+            ir_function* generated = ir_find_function(program, callee);
+            if (!generated) continue;
+            init_body(&bodies[s], generated, generated->code, generated->count);
+        }
+
+        const char* reason = check_call_site(site, &bodies[s]);
+        int cost = call_site_cost(fn, site, &bodies[s]);
+        char detail[64];
+        if (!reason && recursive && level > INLINE_MAX_DEPTH) {
+            snprintf(detail, sizeof(detail), "recursion deeper than %d", INLINE_MAX_DEPTH);
+            reason = detail;
+        } else if (!reason && cost > inline_limit) {
+            snprintf(detail, sizeof(detail), "cost over limit %d", inline_limit);
+            reason = detail;
+        } else if (!reason && *growth + cost > growth_limit) {
+            reason = "caller growth limit";
+        }
+        if (reason) {
+            ir_add_note(fn, "inline: %s (size %d, cost %d): kept, %s", callee, bodies[s].size, cost, reason);
+            continue;
+        }
+        ir_add_note(fn, "inline: %s (size %d, cost %d): inlined%s", callee, bodies[s].size, cost,
+                    recursive ? " (recursive)" : "");
+        *growth += cost;
+        chosen++;
+
+        function_info* info = bodies[s].info;
+        site->params = (char**)malloc((info->param_count + 1) * sizeof(char*));
+        for (int p = 0; p < info->param_count; p++) {
+            site->params[p] = ir_new_temp(fn);
+        }
+    }
+
+    if (chosen > 0) {
+        // Which inlined call, if any, each push and call belongs to
+        int* push_site = (int*)malloc(fn->count * sizeof(int));
+        int* call_site_of = (int*)malloc(fn->count * sizeof(int));
+        for (int i = 0; i < fn->count; i++) {
+            push_site[i] = -1;
+            call_site_of[i] = -1;
+        }
+        for (int s = 0; s < site_count; s++) {
+            if (!sites[s].params) continue;
+            call_site_of[sites[s].call] = s;
+            for (int a = 0; a < sites[s].arg_count; a++) {
+                push_site[sites[s].pushes[a]] = a;
+                call_site_of[sites[s].pushes[a]] = s;
+            }
+        }
+
+        quad* code = fn->code;
+        int count = fn->count;
+        int* old_depths = *depths;
+        int* new_depths = NULL;
+        int depth_capacity = 0;
+        fn->code = NULL;
+        fn->count = 0;
+        fn->capacity = 0;
+
+        for (int i = 0; i < count; i++) {
+            quad* q = &code[i];
+            int s = call_site_of[i];
+            int first = fn->count;
+            int level_of_copy = old_depths[i];
+            if (s < 0) {
+                *ir_append(fn, q->opcode) = *q;
+            } else if (push_site[i] >= 0) {
+                int a = push_site[i];
+                ir_emit_copy(fn, sites[s].params[a], q->args[0], bodies[s].info->param_types[a]);
+            } else {
+                emit_inlined_body(fn, q, &sites[s], &bodies[s]);
+                level_of_copy = level;
+                if (sites[s].pop >= 0) i = sites[s].pop;
+            }
+            if (fn->count > depth_capacity) {
+                depth_capacity = fn->count * 2;
+                new_depths = (int*)realloc(new_depths, depth_capacity * sizeof(int));
+            }
+            for (int k = first; k < fn->count; k++) {
+                new_depths[k] = level_of_copy;
+            }
+        }
+
+        free(code);
+        free(old_depths);
+        *depths = new_depths;
+        free(push_site);
+        free(call_site_of);
+    }
+
+    release_call_sites(sites, site_count);
+    free(bodies);
+    return chosen;
+}
+
+int inline_calls(ir_program* program, ir_function* fn) {
+    if (inline_limit <= 0 || fn->count == 0) return 0;
+
+    // The function's own code as generated, for unrolling recursive calls
+    inline_body self;
+    quad* snapshot = (quad*)malloc(fn->count * sizeof(quad));
+    memcpy(snapshot, fn->code, fn->count * sizeof(quad));
+    init_body(&self, fn, snapshot, fn->count);
+
+    int* depths = (int*)calloc(fn->count + 1, sizeof(int));
+    int growth = 0;
+    int growth_limit = self.size + INLINE_GROWTH_SLACK;
+    int inlined = 0;
+    for (int level = 1; level <= INLINE_MAX_DEPTH + 1; level++) {
+        int round = inline_round(fn, &self, program, level, &depths, &growth, growth_limit);
+        inlined += round;
+        if (round == 0) break;
+    }
+
+    free(depths);
+    free(snapshot);
+    return inlined;
+}
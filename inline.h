@@ -0,0 +1,65 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include "semantic_analysis.h"
+#include "ir.h"
+
+// ============================================================================
+// FUNCTION INLINING
+// ============================================================================
+// Functions are generated in source order and every callee is declared
+// before its callers, so when a function is optimized the final code of
+// each function it calls already exists. A call site is
+//     PushParam a1 ... PushParam ak; t = LCall f; PopParams 8k
+// and inlining replaces each push with a copy into a fresh temporary
+// standing for the parameter, binds the parameters the call leaves out to
+// their default values, and replaces the call with the callee's code.
+// Every temporary, label, parameter and local of the copy is renamed to a
+// fresh temporary or label of the caller; global variables keep their
+// names. Each return becomes a copy into t and a jump past the copy.
+//
+// Cost of a call site: callee instructions (labels not counted), minus
+// the push, call and pop instructions that disappear, minus one per
+// literal argument that may fold. A site is inlined when its cost is at
+// most inline_limit and the caller has not grown by more than its own
+// size plus INLINE_GROWTH_SLACK instructions. Calls inside an inlined
+// body were already weighed when the callee was optimized and stay as
+// they are, except recursive calls to the function being optimized: its
+// own unoptimized code is unrolled into them up to INLINE_MAX_DEPTH deep.
+
+// ============================================================================
+// CALL SITES
+// ============================================================================
+
+// One call in the code, with the pushes of its arguments
+typedef struct call_site {
+    int call;             // Index of the LCall, call or TailCall
+    int pop;              // Index of its PopParams, -1 if it has no arguments
+    int* pushes;          // Index of the push of each argument, in order
+    int arg_count;
+    char** params;        // Temporaries standing for the parameters if inlined
+} call_site;
+
+// Match every call with the pushes of its arguments
+call_site* find_call_sites(ir_function* fn, int* site_count);
+void release_call_sites(call_site* sites, int site_count);
+
+// Literal operand for the default of parameter p, converted to the
+// parameter's type; NULL if it has none or it is an expression
+char* default_argument(function_info* info, int p);
+
+// ============================================================================
+// INLINING
+// ============================================================================
+
+#define INLINE_DEFAULT_LIMIT 10
+#define INLINE_GROWTH_SLACK 64
+#define INLINE_MAX_DEPTH 2
+
+// Largest cost inlined (--inline-limit); 0 disables inlining
+extern int inline_limit;
+
+// Returns the number of calls inlined into fn and notes every decision
+int inline_calls(ir_program* program, ir_function* fn);
+
+#endif // INLINE_H
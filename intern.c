@@ -0,0 +1,105 @@
+#include "intern.h"
+
+// Storage for the predefined atoms
+#define DEFINE_ATOM(name, text) char* name = NULL;
+ATOM_LIST(DEFINE_ATOM)
+#undef DEFINE_ATOM
+
+// Global intern table for the current compilation
+intern_table interned_strings = {NULL, 0, 0, 0, {NULL, 0, 0, 0, 0, 0, 0}};
+
+// FNV-1a hash of a NUL-terminated string
+static unsigned int hash_string(const char* str) {
+    unsigned int hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Double the slot array and re-insert every string
+static void intern_grow(intern_table* table) {
+    int old_capacity = table->capacity;
+    char** old_slots = table->slots;
+
+    table->capacity = old_capacity ? old_capacity * 2 : INTERN_INITIAL_CAPACITY;
+    table->slots = (char**)calloc(table->capacity, sizeof(char*));
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (!old_slots[i]) continue;
+        unsigned int index = hash_string(old_slots[i]) & (table->capacity - 1);
+        while (table->slots[index]) {
+            index = (index + 1) & (table->capacity - 1);
+        }
+        table->slots[index] = old_slots[i];
+    }
+
+    free(old_slots);
+}
+
+// Set up the table and the predefined atoms
+void intern_init(void) {
+    if (interned_strings.slots) return;
+
+    intern_grow(&interned_strings);
+
+#define INIT_ATOM(name, text) name = intern(text);
+    ATOM_LIST(INIT_ATOM)
+#undef INIT_ATOM
+}
+
+// Return the canonical copy of str, adding it on first sight
+char* intern(const char* str) {
+    intern_table* table = &interned_strings;
+    if (!table->slots) {
+        intern_init();
+    }
+
+    table->lookups++;
+
+    unsigned int index = hash_string(str) & (table->capacity - 1);
+    while (table->slots[index]) {
+        if (strcmp(table->slots[index], str) == 0) {
+            return table->slots[index];
+        }
+        index = (index + 1) & (table->capacity - 1);
+    }
+
+    // Keep the load factor below 1/2
+    if ((table->count + 1) * 2 > table->capacity) {
+        intern_grow(table);
+        index = hash_string(str) & (table->capacity - 1);
+        while (table->slots[index]) {
+            index = (index + 1) & (table->capacity - 1);
+        }
+    }
+
+    char* copy = arena_strdup(&table->strings, str);
+    table->slots[index] = copy;
+    table->count++;
+    return copy;
+}
+
+// Drop every interned string; atoms become invalid until intern_init()
+void intern_release(void) {
+    free(interned_strings.slots);
+    interned_strings.slots = NULL;
+    interned_strings.capacity = 0;
+    interned_strings.count = 0;
+    interned_strings.lookups = 0;
+    arena_release(&interned_strings.strings);
+
+#define RESET_ATOM(name, text) name = NULL;
+    ATOM_LIST(RESET_ATOM)
+#undef RESET_ATOM
+}
+
+// Print how many distinct strings back all token occurrences
+void intern_print_stats(void) {
+    printf("=== Intern Table Statistics ===\n");
+    printf("Unique strings: %d (%zu bytes)\n",
+           interned_strings.count, interned_strings.strings.string_bytes);
+    printf("Lookups: %ld, table capacity: %d\n\n",
+           interned_strings.lookups, interned_strings.capacity);
+}
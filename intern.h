@@ -0,0 +1,91 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "arena.h"
+
+// ============================================================================
+// STRING INTERNING
+// ============================================================================
+// Every token and synthetic node label is stored exactly once. Two interned
+// strings are equal if and only if their pointers are equal, so the analysis
+// and code generation passes compare tokens with '==' instead of strcmp.
+
+#define INTERN_INITIAL_CAPACITY 1024
+
+// Predefined atoms: keywords, operators and the labels the grammar builds
+#define ATOM_LIST(X) \
+    X(ATOM_EMPTY, "") \
+    X(ATOM_FUNCTION, "function") \
+    X(ATOM_PARAMS, "params") \
+    X(ATOM_RETURN_TYPE, "return_type") \
+    X(ATOM_BLOCK, "block") \
+    X(ATOM_PASS, "pass") \
+    X(ATOM_ERROR, "ERROR") \
+    X(ATOM_CALL, "call") \
+    X(ATOM_DECLARE, "declare") \
+    X(ATOM_INIT, "init") \
+    X(ATOM_INIT_VAR, "init_var") \
+    X(ATOM_MULTI_INIT, "multi_init") \
+    X(ATOM_ASSIGN, "assign") \
+    X(ATOM_MULTI_ASSIGN, "multi_assign") \
+    X(ATOM_IF, "if") \
+    X(ATOM_IF_ELSE, "if-else") \
+    X(ATOM_IF_ELIF, "if-elif") \
+    X(ATOM_IF_ELIF_ELSE, "if-elif-else") \
+    X(ATOM_ELIF, "elif") \
+    X(ATOM_WHILE, "while") \
+    X(ATOM_RETURN, "return") \
+    X(ATOM_INDEX, "index") \
+    X(ATOM_SLICE, "slice") \
+    X(ATOM_SLICE_STEP, "slice_step") \
+    X(ATOM_PLUS, "+") \
+    X(ATOM_MINUS, "-") \
+    X(ATOM_MUL, "*") \
+    X(ATOM_DIV, "/") \
+    X(ATOM_MOD, "%") \
+    X(ATOM_POW, "**") \
+    X(ATOM_EQ, "==") \
+    X(ATOM_NE, "!=") \
+    X(ATOM_LT, "<") \
+    X(ATOM_GT, ">") \
+    X(ATOM_LE, "<=") \
+    X(ATOM_GE, ">=") \
+    X(ATOM_AND, "and") \
+    X(ATOM_OR, "or") \
+    X(ATOM_NOT, "not") \
+    X(ATOM_INT, "int") \
+    X(ATOM_STRING, "string") \
+    X(ATOM_BOOL, "bool") \
+    X(ATOM_FLOAT, "float") \
+    X(ATOM_TRUE, "true") \
+    X(ATOM_FALSE, "false") \
+    X(ATOM_TRUE_CAP, "True") \
+    X(ATOM_FALSE_CAP, "False") \
+    X(ATOM_ZERO, "0") \
+    X(ATOM_MINUS_ONE, "-1") \
+    X(ATOM_MAIN, "__main__")
+
+#define DECLARE_ATOM(name, text) extern char* name;
+ATOM_LIST(DECLARE_ATOM)
+#undef DECLARE_ATOM
+
+// ============================================================================
+// INTERN TABLE
+// ============================================================================
+
+typedef struct intern_table {
+    char** slots;         // Open addressing, NULL marks an empty slot
+    int capacity;         // Always a power of two
+    int count;
+    long lookups;
+    arena strings;        // Owns the bytes of every interned string
+} intern_table;
+
+extern intern_table interned_strings;
+
+void intern_init(void);
+char* intern(const char* str);
+void intern_release(void);
+void intern_print_stats(void);
+
+#endif // INTERN_H
@@ -0,0 +1,399 @@
+#include <stdarg.h>
+#include "ir.h"
+#include "intern.h"
+#include "optimize.h"
+
+// Add an empty function to the end of the program
+ir_function* ir_new_function(ir_program* program, char* name) {
+    ir_function* fn = (ir_function*)calloc(1, sizeof(ir_function));
+    fn->name = intern(name);
+
+    if (program->last) {
+        program->last->next = fn;
+    } else {
+        program->first = fn;
+    }
+    program->last = fn;
+    program->count++;
+    return fn;
+}
+
+// Add an empty function right after an existing one
+ir_function* ir_new_function_after(ir_program* program, ir_function* after, char* name) {
+    ir_function* fn = (ir_function*)calloc(1, sizeof(ir_function));
+    fn->name = intern(name);
+
+    fn->next = after->next;
+    after->next = fn;
+    if (program->last == after) program->last = fn;
+    program->count++;
+    return fn;
+}
+
+// Give every parameter, local and temporary of a finished function its
+// slot; under -O only the locals its final code still names
+void ir_layout_frame(ir_function* fn) {
+    layout_frame(&fn->frame, find_function_by_name(fn->name), fn->temp_count, optimize_level ? fn : NULL);
+    ir_add_note(fn, "frame: %d bytes (%d params, %d locals, %d temps)",
+                fn->frame.size, fn->frame.param_count, fn->frame.local_count, fn->frame.temp_count);
+}
+
+// Generated function with this source name, NULL if not generated yet
+ir_function* ir_find_function(ir_program* program, char* name) {
+    for (ir_function* fn = program->first; fn; fn = fn->next) {
+        if (strcmp(fn->name, name) == 0) return fn;
+    }
+    return NULL;
+}
+
+// Append a cleared instruction and return it for filling in
+quad* ir_append(ir_function* fn, ir_opcode opcode) {
+    if (fn->count == fn->capacity) {
+        fn->capacity = fn->capacity ? fn->capacity * 2 : IR_INITIAL_CAPACITY;
+        fn->code = (quad*)realloc(fn->code, fn->capacity * sizeof(quad));
+    }
+
+    quad* q = &fn->code[fn->count++];
+    memset(q, 0, sizeof(quad));
+    q->opcode = opcode;
+    q->op = OP_NONE;
+    return q;
+}
+
+// Insert a cleared instruction before code[index] and return it
+quad* ir_insert(ir_function* fn, int index, ir_opcode opcode) {
+    ir_append(fn, opcode);
+    memmove(&fn->code[index + 1], &fn->code[index], (fn->count - 1 - index) * sizeof(quad));
+
+    quad* q = &fn->code[index];
+    memset(q, 0, sizeof(quad));
+    q->opcode = opcode;
+    q->op = OP_NONE;
+    return q;
+}
+
+// Turn an instruction into "result = source", keeping its result and type
+void ir_make_copy(quad* q, char* source) {
+    q->opcode = IR_COPY;
+    q->op = OP_NONE;
+    q->args[0] = source;
+    for (int a = 1; a < IR_MAX_ARGS; a++) {
+        q->args[a] = NULL;
+    }
+}
+
+// Record one line of the optimization report for this function
+void ir_add_note(ir_function* fn, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (fn->note_count == fn->note_capacity) {
+        fn->note_capacity = fn->note_capacity ? fn->note_capacity * 2 : 4;
+        fn->notes = (char**)realloc(fn->notes, fn->note_capacity * sizeof(char*));
+    }
+    fn->notes[fn->note_count++] = strdup(buffer);
+}
+
+void ir_emit_label(ir_function* fn, char* label) {
+    ir_append(fn, IR_LABEL)->target = label;
+}
+
+void ir_emit_copy(ir_function* fn, char* result, char* src, int type) {
+    quad* q = ir_append(fn, IR_COPY);
+    q->result = result;
+    q->args[0] = src;
+    q->type = type;
+}
+
+void ir_emit_binary(ir_function* fn, char* result, ir_op op, char* left, char* right, int type) {
+    quad* q = ir_append(fn, IR_BINARY);
+    q->op = op;
+    q->result = result;
+    q->args[0] = left;
+    q->args[1] = right;
+    q->type = type;
+}
+
+void ir_emit_not(ir_function* fn, char* result, char* operand) {
+    quad* q = ir_append(fn, IR_NOT);
+    q->result = result;
+    q->args[0] = operand;
+    q->type = TYPE_BOOL;
+}
+
+void ir_emit_index(ir_function* fn, char* result, char* str, char* index) {
+    quad* q = ir_append(fn, IR_INDEX);
+    q->result = result;
+    q->args[0] = str;
+    q->args[1] = index;
+    q->type = TYPE_STRING;
+}
+
+void ir_emit_slice(ir_function* fn, char* result, char* str, char* start, char* end) {
+    quad* q = ir_append(fn, IR_SLICE);
+    q->result = result;
+    q->args[0] = str;
+    q->args[1] = start;
+    q->args[2] = end;
+    q->type = TYPE_STRING;
+}
+
+void ir_emit_slice_step(ir_function* fn, char* result, char* str, char* start, char* end, char* step) {
+    quad* q = ir_append(fn, IR_SLICE_STEP);
+    q->result = result;
+    q->args[0] = str;
+    q->args[1] = start;
+    q->args[2] = end;
+    q->args[3] = step;
+    q->type = TYPE_STRING;
+}
+
+void ir_emit_goto(ir_function* fn, char* label) {
+    ir_append(fn, IR_GOTO)->target = label;
+}
+
+// Emit IR_IF_FALSE or IR_IF_TRUE
+void ir_emit_cond_jump(ir_function* fn, ir_opcode opcode, char* cond, char* label) {
+    quad* q = ir_append(fn, opcode);
+    q->args[0] = cond;
+    q->target = label;
+}
+
+// Emit IR_IF_FALSE or IR_IF_TRUE that tests "left op right" directly
+void ir_emit_compare_jump(ir_function* fn, ir_opcode opcode, ir_op op, char* left, char* right, char* label) {
+    quad* q = ir_append(fn, opcode);
+    q->op = op;
+    q->args[0] = left;
+    q->args[1] = right;
+    q->target = label;
+}
+
+void ir_emit_push_param(ir_function* fn, char* arg) {
+    ir_append(fn, IR_PUSH_PARAM)->args[0] = arg;
+}
+
+void ir_emit_pop_params(ir_function* fn, int bytes) {
+    ir_append(fn, IR_POP_PARAMS)->value = bytes;
+}
+
+void ir_emit_lcall(ir_function* fn, char* result, char* callee, int type) {
+    quad* q = ir_append(fn, IR_LCALL);
+    q->result = result;
+    q->target = callee;
+    q->type = type;
+}
+
+void ir_emit_call(ir_function* fn, char* callee) {
+    ir_append(fn, IR_CALL)->target = callee;
+}
+
+// Emit a return; value is NULL for a bare return
+void ir_emit_return(ir_function* fn, char* value) {
+    ir_append(fn, IR_RETURN)->args[0] = value;
+}
+
+// Emit a tail call to callee with the bytes of arguments pushed before it
+void ir_emit_tail_call(ir_function* fn, char* callee, int bytes, int type) {
+    quad* q = ir_append(fn, IR_TAIL_CALL);
+    q->target = callee;
+    q->value = bytes;
+    q->type = type;
+}
+
+// The table is copied; cases[i] is the label for value low + i
+void ir_emit_switch(ir_function* fn, char* value, char* low, char** cases, int count, char* fallback) {
+    quad* q = ir_append(fn, IR_SWITCH);
+    q->args[0] = value;
+    q->args[1] = low;
+    q->target = fallback;
+    q->value = count;
+    q->cases = (char**)malloc(count * sizeof(char*));
+    memcpy(q->cases, cases, count * sizeof(char*));
+}
+
+void ir_emit_comment(ir_function* fn, char* text) {
+    ir_append(fn, IR_COMMENT)->target = intern(text);
+}
+
+char* ir_temp_name(int number) {
+    char name[16];
+    snprintf(name, sizeof(name), "t%d", number);
+    return intern(name);
+}
+
+char* ir_label_name(int number) {
+    char name[16];
+    snprintf(name, sizeof(name), "L%d", number);
+    return intern(name);
+}
+
+// Parse "<prefix><number>" where number is in 1..limit
+static int numbered_name(const char* operand, char prefix, int limit) {
+    if (!operand || operand[0] != prefix || operand[1] < '1' || operand[1] > '9') return 0;
+
+    int number = 0;
+    for (const char* p = operand + 1; *p; p++) {
+        if (*p < '0' || *p > '9' || number > limit) return 0;
+        number = number * 10 + (*p - '0');
+    }
+    return number <= limit ? number : 0;
+}
+
+int ir_temp_number(ir_function* fn, const char* operand) {
+    return numbered_name(operand, 't', fn->temp_count);
+}
+
+int ir_label_number(ir_function* fn, const char* label) {
+    return numbered_name(label, 'L', fn->label_count);
+}
+
+// Spelling of an operator in the printed 3AC
+const char* ir_op_name(ir_op op) {
+    switch (op) {
+        case OP_SHL: return "<<";
+        case OP_SHR: return ">>";
+        case OP_BITAND: return "&";
+        case OP_MULHI: return "mulhi";
+        default: return binary_op_name((binary_op)op);
+    }
+}
+
+// Print one instruction in the textual 3AC format
+void ir_print_quad(FILE* out, quad* q) {
+    switch (q->opcode) {
+        case IR_LABEL:
+            fprintf(out, "%s:\n", q->target);
+            break;
+        case IR_COPY:
+            fprintf(out, "    %s = %s\n", q->result, q->args[0]);
+            break;
+        case IR_BINARY:
+            fprintf(out, "    %s = %s %s %s\n", q->result, q->args[0], ir_op_name(q->op), q->args[1]);
+            break;
+        case IR_NOT:
+            fprintf(out, "    %s = not %s\n", q->result, q->args[0]);
+            break;
+        case IR_INDEX:
+            fprintf(out, "    %s = %s[%s]\n", q->result, q->args[0], q->args[1]);
+            break;
+        case IR_SLICE:
+            fprintf(out, "    %s = %s[%s:%s]\n", q->result, q->args[0], q->args[1], q->args[2]);
+            break;
+        case IR_SLICE_STEP:
+            fprintf(out, "    %s = %s[%s:%s:%s]\n", q->result, q->args[0], q->args[1], q->args[2], q->args[3]);
+            break;
+        case IR_GOTO:
+            fprintf(out, "    goto %s\n", q->target);
+            break;
+        case IR_IF_FALSE:
+        case IR_IF_TRUE:
+            fprintf(out, "    %s ", q->opcode == IR_IF_FALSE ? "if_false" : "if_true");
+            if (q->op != OP_NONE) {
+                fprintf(out, "%s %s %s", q->args[0], ir_op_name(q->op), q->args[1]);
+            } else {
+                fprintf(out, "%s", q->args[0]);
+            }
+            fprintf(out, " goto %s\n", q->target);
+            break;
+        case IR_PUSH_PARAM:
+            fprintf(out, "    PushParam %s\n", q->args[0]);
+            break;
+        case IR_POP_PARAMS:
+            fprintf(out, "    PopParams %d\n", q->value);
+            break;
+        case IR_LCALL:
+            fprintf(out, "    %s = LCall %s\n", q->result, q->target);
+            break;
+        case IR_CALL:
+            fprintf(out, "    call %s\n", q->target);
+            break;
+        case IR_RETURN:
+            if (q->args[0]) {
+                fprintf(out, "    return %s\n", q->args[0]);
+            } else {
+                fprintf(out, "    return\n");
+            }
+            break;
+        case IR_TAIL_CALL:
+            fprintf(out, "    TailCall %s %d\n", q->target, q->value);
+            break;
+        case IR_SWITCH: {
+            long long low = strtoll(q->args[1], NULL, 10);
+            fprintf(out, "    switch %s [", q->args[0]);
+            for (int i = 0; i < q->value; i++) {
+                fprintf(out, "%s%lld: %s", i ? ", " : "", low + i, q->cases[i]);
+            }
+            fprintf(out, "] default %s\n", q->target);
+            break;
+        }
+        case IR_COMMENT:
+            fprintf(out, "    // %s\n", q->target);
+            break;
+    }
+}
+
+// Fresh temporary or label for a pass that adds code to a finished function
+char* ir_new_temp(ir_function* fn) {
+    return ir_temp_name(++fn->temp_count);
+}
+
+char* ir_new_label(ir_function* fn) {
+    return ir_label_name(++fn->label_count);
+}
+
+int ir_is_variable(const char* operand) {
+    if (!operand) return 0;
+    if (operand == ATOM_TRUE || operand == ATOM_FALSE) return 0;
+    return (operand[0] >= 'a' && operand[0] <= 'z') ||
+           (operand[0] >= 'A' && operand[0] <= 'Z') ||
+           operand[0] == '_';
+}
+
+// Name of the function as printed in the 3AC
+char* ir_function_label(ir_function* fn) {
+    return fn->name == ATOM_MAIN ? "main" : fn->name;
+}
+
+// Print a function with its BeginFunc/EndFunc frame
+void ir_print_function(FILE* out, ir_function* fn) {
+    fprintf(out, "%s:\n", ir_function_label(fn));
+    fprintf(out, "    BeginFunc %d\n", fn->frame.size);
+
+    for (int i = 0; i < fn->count; i++) {
+        ir_print_quad(out, &fn->code[i]);
+    }
+
+    fprintf(out, "    EndFunc\n\n");
+}
+
+void ir_print_program(FILE* out, ir_program* program) {
+    for (ir_function* fn = program->first; fn; fn = fn->next) {
+        ir_print_function(out, fn);
+    }
+}
+
+// Free every function; operand strings belong to the intern table
+void ir_release_program(ir_program* program) {
+    ir_function* fn = program->first;
+    while (fn) {
+        ir_function* next = fn->next;
+        for (int i = 0; i < fn->count; i++) {
+            if (fn->code[i].opcode == IR_SWITCH) free(fn->code[i].cases);
+        }
+        free(fn->code);
+        for (int i = 0; i < fn->note_count; i++) {
+            free(fn->notes[i]);
+        }
+        free(fn->notes);
+        release_frame_layout(&fn->frame);
+        free(fn);
+        fn = next;
+    }
+
+    program->first = NULL;
+    program->last = NULL;
+    program->count = 0;
+}
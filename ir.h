@@ -0,0 +1,143 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include "semantic_analysis.h"
+#include "frame.h"
+
+// ============================================================================
+// THREE-ADDRESS CODE REPRESENTATION
+// ============================================================================
+// Code generation fills one quad array per function; the printer renders
+// it in the textual 3AC format. All operand strings are interned, so quads
+// can be copied, reordered and compared by pointer freely.
+
+#define IR_MAX_ARGS 4
+#define IR_INITIAL_CAPACITY 32
+
+// Operator of IR_BINARY and fused jumps: a binary_op, or one of the
+// operators below that only strength reduction produces
+typedef int ir_op;
+
+enum {
+    OP_SHL = OP_GE + 1,
+    OP_SHR,
+    OP_BITAND,
+    OP_MULHI              // High 32 bits of the 64-bit product
+};
+
+typedef enum ir_opcode {
+    IR_LABEL,         // target:
+    IR_COPY,          // result = args[0]
+    IR_BINARY,        // result = args[0] op args[1]
+    IR_NOT,           // result = not args[0]
+    IR_INDEX,         // result = args[0][args[1]]
+    IR_SLICE,         // result = args[0][args[1]:args[2]]
+    IR_SLICE_STEP,    // result = args[0][args[1]:args[2]:args[3]]
+    IR_GOTO,          // goto target
+    IR_IF_FALSE,      // if_false args[0] [op args[1]] goto target
+    IR_IF_TRUE,       // if_true args[0] [op args[1]] goto target
+    IR_PUSH_PARAM,    // PushParam args[0]
+    IR_POP_PARAMS,    // PopParams value
+    IR_LCALL,         // result = LCall target
+    IR_CALL,          // call target
+    IR_RETURN,        // return [args[0]]
+    IR_TAIL_CALL,     // TailCall target value: return what target returns, reusing this frame
+    IR_SWITCH,        // switch args[0]: jump to cases[args[0] - args[1]] if within the value entries, else target
+    IR_COMMENT        // // target
+} ir_opcode;
+
+// One instruction
+typedef struct quad {
+    ir_opcode opcode;
+    ir_op op;                 // Operator of IR_BINARY, or comparison of a fused jump
+    char* result;             // Destination operand, NULL if none
+    char* args[IR_MAX_ARGS];  // Source operands, NULL when unused
+    char* target;             // Label, callee or comment text
+    int value;                // Byte count of IR_POP_PARAMS, or of the arguments of IR_TAIL_CALL;
+                              // table size of IR_SWITCH
+    char** cases;             // Jump table of IR_SWITCH, owned by the instruction
+    int type;                 // TYPE_* of result, 0 if unknown
+} quad;
+
+// Code of one function
+typedef struct ir_function {
+    char* name;               // Source name ("__main__" for the entry point)
+    frame_layout frame;       // BeginFunc prints frame.size
+    int temp_count;           // Temporaries are named t1 .. t<temp_count>
+    int label_count;          // Labels are named L1 .. L<label_count>
+    char** notes;             // Lines for the optimization report
+    int note_count;
+    int note_capacity;
+    quad* code;
+    int count;
+    int capacity;
+    struct ir_function* next;
+} ir_function;
+
+// All functions in source order
+typedef struct ir_program {
+    ir_function* first;
+    ir_function* last;
+    int count;
+} ir_program;
+
+// ============================================================================
+// CONSTRUCTION
+// ============================================================================
+
+ir_function* ir_new_function(ir_program* program, char* name);
+ir_function* ir_new_function_after(ir_program* program, ir_function* after, char* name);
+ir_function* ir_find_function(ir_program* program, char* name);
+void ir_layout_frame(ir_function* fn);
+quad* ir_append(ir_function* fn, ir_opcode opcode);
+quad* ir_insert(ir_function* fn, int index, ir_opcode opcode);
+void ir_make_copy(quad* q, char* source);
+void ir_add_note(ir_function* fn, const char* format, ...);
+void ir_emit_label(ir_function* fn, char* label);
+void ir_emit_copy(ir_function* fn, char* result, char* src, int type);
+void ir_emit_binary(ir_function* fn, char* result, ir_op op, char* left, char* right, int type);
+void ir_emit_not(ir_function* fn, char* result, char* operand);
+void ir_emit_index(ir_function* fn, char* result, char* str, char* index);
+void ir_emit_slice(ir_function* fn, char* result, char* str, char* start, char* end);
+void ir_emit_slice_step(ir_function* fn, char* result, char* str, char* start, char* end, char* step);
+void ir_emit_goto(ir_function* fn, char* label);
+void ir_emit_cond_jump(ir_function* fn, ir_opcode opcode, char* cond, char* label);
+void ir_emit_compare_jump(ir_function* fn, ir_opcode opcode, ir_op op, char* left, char* right, char* label);
+void ir_emit_push_param(ir_function* fn, char* arg);
+void ir_emit_pop_params(ir_function* fn, int bytes);
+void ir_emit_lcall(ir_function* fn, char* result, char* callee, int type);
+void ir_emit_call(ir_function* fn, char* callee);
+void ir_emit_return(ir_function* fn, char* value);
+void ir_emit_tail_call(ir_function* fn, char* callee, int bytes, int type);
+void ir_emit_switch(ir_function* fn, char* value, char* low, char** cases, int count, char* fallback);
+void ir_emit_comment(ir_function* fn, char* text);
+
+// ============================================================================
+// TEMPORARIES AND LABELS
+// ============================================================================
+// Temporaries and labels are numbered per function; an operand is mapped
+// back to its number by spelling. Returns 0 for any other operand.
+
+char* ir_temp_name(int number);
+char* ir_label_name(int number);
+int ir_temp_number(ir_function* fn, const char* operand);
+int ir_label_number(ir_function* fn, const char* label);
+char* ir_new_temp(ir_function* fn);
+char* ir_new_label(ir_function* fn);
+
+// Variables and temporaries start with a letter or '_'; literals never do
+int ir_is_variable(const char* operand);
+
+// ============================================================================
+// PRINTING AND RELEASE
+// ============================================================================
+
+char* ir_function_label(ir_function* fn);
+const char* ir_op_name(ir_op op);
+void ir_print_quad(FILE* out, quad* q);
+void ir_print_function(FILE* out, ir_function* fn);
+void ir_print_program(FILE* out, ir_program* program);
+void ir_release_program(ir_program* program);
+
+#endif // IR_H
@@ -0,0 +1,217 @@
+#include "jumptable.h"
+#include "optimize.h"
+#include "cfg.h"
+
+// One key of a chain and the label of its body
+typedef struct switch_case {
+    long long key;
+    char* label;
+} switch_case;
+
+// A chain to replace, recorded at its first test
+typedef struct switch_chain {
+    char* value;
+    switch_case* cases;   // In chain order until the dispatch sorts them
+    int count;
+    char* fallback;       // Target of the last test
+    char* first_body;     // Label placed after the first test
+} switch_chain;
+
+typedef struct dispatch_stats {
+    int tables;
+    int table_cases;      // Keys reached through a jump table
+    int depth;            // Most compares run before a jump
+} dispatch_stats;
+
+// Variable tested by "if_false v == k" or "if_true v != k" with an int
+// literal k, NULL if q is no such test
+static char* chain_test(quad* q, long long* key) {
+    if (!(q->opcode == IR_IF_FALSE && q->op == OP_EQ) && !(q->opcode == IR_IF_TRUE && q->op == OP_NE)) return NULL;
+    char* variable = q->args[0];
+    char* literal = q->args[1];
+    if (!ir_is_variable(variable)) {
+        variable = q->args[1];
+        literal = q->args[0];
+    }
+    if (!ir_is_variable(variable) || !is_int_literal(literal)) return NULL;
+    *key = strtoll(literal, NULL, 10);
+    return variable;
+}
+
+// Instructions that never fall into the next one
+static int ends_flow(quad* q) {
+    return q->opcode == IR_GOTO || q->opcode == IR_RETURN || q->opcode == IR_TAIL_CALL || q->opcode == IR_SWITCH;
+}
+
+// Parameters and locals by their declared type; a temporary when every
+// instruction writing it produces an int. Globals are left alone.
+static int is_int_variable(ir_function* fn, function_info* info, char* name) {
+    if (ir_temp_number(fn, name)) {
+        int defs = 0;
+        for (int i = 0; i < fn->count; i++) {
+            if (fn->code[i].result != name) continue;
+            if (fn->code[i].type != TYPE_INT) return 0;
+            defs++;
+        }
+        return defs > 0;
+    }
+    if (!info) return 0;
+    for (int v = 0; v < info->param_count; v++) {
+        if (info->param_names[v] == name) return info->param_types[v] == TYPE_INT;
+    }
+    for (int v = 0; v < info->local_count; v++) {
+        if (info->local_names[v] == name) return info->local_types[v] == TYPE_INT;
+    }
+    return 0;
+}
+
+static int has_key(switch_case* cases, int count, long long key) {
+    for (int c = 0; c < count; c++) {
+        if (cases[c].key == key) return 1;
+    }
+    return 0;
+}
+
+static int by_key(const void* a, const void* b) {
+    long long left = ((const switch_case*)a)->key;
+    long long right = ((const switch_case*)b)->key;
+    return (left > right) - (left < right);
+}
+
+// Emit the dispatch over keys sorted in ascending order
+static void emit_dispatch(ir_function* fn, char* value, switch_case* cases, int count, char* fallback,
+                          int depth, dispatch_stats* stats) {
+    long long low = cases[0].key;
+    long long range = cases[count - 1].key - low + 1;
+    if (count >= SWITCH_MIN_CASES && range <= 2LL * count && range <= SWITCH_MAX_TABLE) {
+        char** table = (char**)malloc(range * sizeof(char*));
+        for (int i = 0; i < range; i++) {
+            table[i] = fallback;
+        }
+        for (int c = 0; c < count; c++) {
+            table[cases[c].key - low] = cases[c].label;
+        }
+        ir_emit_switch(fn, value, make_int_literal(low), table, (int)range, fallback);
+        free(table);
+        stats->tables++;
+        stats->table_cases += count;
+        if (depth > stats->depth) stats->depth = depth;
+        return;
+    }
+
+    if (count <= SWITCH_LINEAR_CASES) {
+        for (int c = 0; c < count; c++) {
+            ir_emit_compare_jump(fn, IR_IF_TRUE, OP_EQ, value, make_int_literal(cases[c].key), cases[c].label);
+        }
+        ir_emit_goto(fn, fallback);
+        if (depth + count > stats->depth) stats->depth = depth + count;
+        return;
+    }
+
+    int middle = count / 2;
+    char* high = ir_new_label(fn);
+    ir_emit_compare_jump(fn, IR_IF_TRUE, OP_GE, value, make_int_literal(cases[middle].key), high);
+    emit_dispatch(fn, value, cases, middle, fallback, depth + 1, stats);
+    ir_emit_label(fn, high);
+    emit_dispatch(fn, value, cases + middle, count - middle, fallback, depth + 1, stats);
+}
+
+int lower_switches(ir_function* fn) {
+    if (fn->count == 0) return 0;
+    function_info* info = find_function_by_name(fn->name);
+
+    // Where each label is and how many jumps lead to it
+    int* label_at = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    int* uses = (int*)calloc(fn->label_count + 1, sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        label_at[l] = -1;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        if (q->opcode == IR_LABEL) label_at[ir_label_number(fn, q->target)] = i;
+        if (is_jump_opcode(q->opcode) || q->opcode == IR_SWITCH) uses[ir_label_number(fn, q->target)]++;
+        for (int c = 0; q->opcode == IR_SWITCH && c < q->value; c++) {
+            uses[ir_label_number(fn, q->cases[c])]++;
+        }
+    }
+
+    switch_chain** chains = (switch_chain**)calloc(fn->count, sizeof(switch_chain*));
+    char* removed = (char*)calloc(fn->count, 1);
+    switch_case* cases = (switch_case*)malloc(fn->count * sizeof(switch_case));
+    int* tests = (int*)malloc(fn->count * sizeof(int));
+    int lowered = 0;
+
+    for (int i = 0; i < fn->count; i++) {
+        long long key;
+        char* value = removed[i] ? NULL : chain_test(&fn->code[i], &key);
+        if (!value) continue;
+
+        // Follow the failed tests while each lands on the next test and
+        // nothing else reaches it
+        int count = 0;
+        cases[count].key = key;
+        cases[count].label = NULL;
+        tests[count++] = i;
+        while (1) {
+            quad* test = &fn->code[tests[count - 1]];
+            int label = ir_label_number(fn, test->target);
+            int at = label ? label_at[label] : -1;
+            if (at <= tests[count - 1] || uses[label] != 1 || at + 1 >= fn->count) break;
+            if (!ends_flow(&fn->code[at - 1])) break;
+            long long next_key;
+            if (chain_test(&fn->code[at + 1], &next_key) != value || has_key(cases, count, next_key)) break;
+            cases[count].key = next_key;
+            cases[count].label = test->target;
+            tests[count++] = at + 1;
+        }
+        if (count < SWITCH_MIN_CASES || !is_int_variable(fn, info, value)) continue;
+
+        switch_chain* chain = (switch_chain*)malloc(sizeof(switch_chain));
+        chain->value = value;
+        chain->count = count;
+        chain->fallback = fn->code[tests[count - 1]].target;
+        chain->first_body = ir_new_label(fn);
+        cases[0].label = chain->first_body;
+        chain->cases = (switch_case*)malloc(count * sizeof(switch_case));
+        memcpy(chain->cases, cases, count * sizeof(switch_case));
+        chains[i] = chain;
+        for (int t = 1; t < count; t++) {
+            removed[tests[t]] = 1;
+        }
+        lowered++;
+    }
+
+    if (lowered > 0) {
+        quad* code = fn->code;
+        int count = fn->count;
+        fn->code = NULL;
+        fn->count = 0;
+        fn->capacity = 0;
+        for (int i = 0; i < count; i++) {
+            switch_chain* chain = chains[i];
+            if (removed[i]) continue;
+            if (!chain) {
+                *ir_append(fn, code[i].opcode) = code[i];
+                continue;
+            }
+
+            dispatch_stats stats = {0, 0, 0};
+            qsort(chain->cases, chain->count, sizeof(switch_case), by_key);
+            emit_dispatch(fn, chain->value, chain->cases, chain->count, chain->fallback, 0, &stats);
+            ir_emit_label(fn, chain->first_body);
+            ir_add_note(fn, "switch: %s, %d cases: %d in %d jump tables, up to %d compares",
+                        chain->value, chain->count, stats.table_cases, stats.tables, stats.depth);
+            free(chain->cases);
+            free(chain);
+        }
+        free(code);
+    }
+
+    free(label_at);
+    free(uses);
+    free(chains);
+    free(removed);
+    free(cases);
+    free(tests);
+    return lowered;
+}
@@ -0,0 +1,40 @@
+#ifndef JUMPTABLE_H
+#define JUMPTABLE_H
+
+#include "semantic_analysis.h"
+#include "ir.h"
+
+// ============================================================================
+// SWITCH LOWERING
+// ============================================================================
+// An if-elif chain that compares one int variable with integer literals
+// reaches the optimizer as a series of tests, each reached only from the
+// failed test before it:
+//     if_false x == 1 goto L2; <body 1>; goto Lend
+//     L2: if_false x == 7 goto L3; <body 2>; goto Lend
+//     L3: ...
+// The bodies must not fall into the next test, and the keys must be
+// distinct. A chain of at least SWITCH_MIN_CASES tests is replaced by one
+// dispatch at the first test that jumps straight to the right body, or to
+// the target of the last test when no key matches.
+//
+// The dispatch over the sorted keys is built recursively. A run of keys
+// filling at least half of its range, and no wider than
+// SWITCH_MAX_TABLE, becomes a bounds-checked jump table:
+//     switch x [1: L4, 2: L9, 3: L5] default L9
+// where the holes go to the default. At most SWITCH_LINEAR_CASES keys are
+// tested one after the other with if_true x == k. Anything else is split
+// at the middle key into a binary search:
+//     if_true x >= 40 goto Lhigh; <lower half>; Lhigh: <upper half>
+//
+// This runs last, on the final code of the function; inlining and
+// specialization leave functions with a switch alone.
+
+#define SWITCH_MIN_CASES 4
+#define SWITCH_LINEAR_CASES 3
+#define SWITCH_MAX_TABLE 256
+
+// Returns the number of chains lowered and notes each of them
+int lower_switches(ir_function* fn);
+
+#endif // JUMPTABLE_H
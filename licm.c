@@ -0,0 +1,171 @@
+#include "licm.h"
+#include "optimize.h"
+
+typedef struct licm_state {
+    ssa_form* ssa;
+    int* def_block;       // Block defining each name, -1 for values on entry
+    int* quad_block;      // Block each quad is in now, hoisted ones included
+    int* hoist_stamp;     // Position in hoist_order of the latest move, -1 if never moved
+    int* hoist_order;     // Quad indexes in the order they were hoisted
+    int hoisted;
+    int order_capacity;
+} licm_state;
+
+static int is_invariant_operand(licm_state* state, natural_loop* loop, char* operand) {
+    if (!ir_is_variable(operand)) return 1;
+    int block = state->def_block[ssa_name_index(state->ssa, operand)];
+    return block < 0 || !loop_contains(loop, block);
+}
+
+// A trapping quad may only move when the header runs nothing with an
+// effect, or another trap, before it
+static int traps_at_header_entry(licm_state* state, natural_loop* loop, int index) {
+    basic_block* header = &state->ssa->graph.blocks[loop->header];
+    if (index < header->first || index > header->last) return 0;
+    for (int i = header->first; i < index; i++) {
+        quad* q = &state->ssa->fn->code[i];
+        if (q->opcode == IR_LABEL || q->opcode == IR_COMMENT) continue;
+        if (state->quad_block[i] != loop->header) continue;
+        if (!is_pure_definition(q)) return 0;
+    }
+    return 1;
+}
+
+static int can_hoist(licm_state* state, natural_loop* loop, int index) {
+    quad* q = &state->ssa->fn->code[index];
+    if (!ir_is_variable(q->result)) return 0;
+    if (!is_pure_definition(q)) {
+        switch (q->opcode) {
+            case IR_BINARY:
+            case IR_INDEX:
+                if (!traps_at_header_entry(state, loop, index)) return 0;
+                break;
+            default:
+                return 0;
+        }
+    }
+    for (int a = 0; a < IR_MAX_ARGS; a++) {
+        if (!is_invariant_operand(state, loop, q->args[a])) return 0;
+    }
+    return 1;
+}
+
+// Move invariant definitions of one loop to its preheader until none is left
+static int hoist_from_loop(licm_state* state, natural_loop* loop) {
+    ir_function* fn = state->ssa->fn;
+    int moved = 0;
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < fn->count; i++) {
+            if (!loop_contains(loop, state->quad_block[i]) || !can_hoist(state, loop, i)) continue;
+            state->quad_block[i] = loop->preheader;
+            state->def_block[ssa_name_index(state->ssa, fn->code[i].result)] = loop->preheader;
+            if (state->hoisted == state->order_capacity) {
+                state->order_capacity *= 2;
+                state->hoist_order = (int*)realloc(state->hoist_order, state->order_capacity * sizeof(int));
+            }
+            state->hoist_stamp[i] = state->hoisted;
+            state->hoist_order[state->hoisted++] = i;
+            moved++;
+            changed = 1;
+        }
+    }
+    return moved;
+}
+
+// Lay the quads out again: each block keeps the quads still in it, and
+// a preheader gets its hoisted quads, in the order they moved, before its jump
+static void rebuild_code(licm_state* state) {
+    cfg* graph = &state->ssa->graph;
+    ir_function* fn = state->ssa->fn;
+    int** arrivals = (int**)calloc(graph->count, sizeof(int*));
+    int* arrival_count = (int*)calloc(graph->count, sizeof(int));
+    for (int k = 0; k < state->hoisted; k++) {
+        int i = state->hoist_order[k];
+        if (state->hoist_stamp[i] != k) continue;
+        int b = state->quad_block[i];
+        arrivals[b] = (int*)realloc(arrivals[b], (arrival_count[b] + 1) * sizeof(int));
+        arrivals[b][arrival_count[b]++] = i;
+    }
+
+    quad* code = (quad*)malloc((fn->count + 1) * sizeof(quad));
+    int count = 0;
+    for (int b = 0; b < graph->count; b++) {
+        basic_block* block = &graph->blocks[b];
+        int end = block->last;
+        if (end >= block->first && is_jump_opcode(fn->code[end].opcode)) end--;
+        int first = count;
+        for (int i = block->first; i <= end; i++) {
+            if (state->quad_block[i] == b && state->hoist_stamp[i] < 0) code[count++] = fn->code[i];
+        }
+        for (int k = 0; k < arrival_count[b]; k++) {
+            code[count++] = fn->code[arrivals[b][k]];
+        }
+        for (int i = end + 1; i <= block->last; i++) {
+            code[count++] = fn->code[i];
+        }
+        block->first = first;
+        block->last = count - 1;
+        free(arrivals[b]);
+    }
+
+    free(fn->code);
+    fn->code = code;
+    fn->capacity = fn->count + 1;
+    free(arrivals);
+    free(arrival_count);
+}
+
+int hoist_loop_invariants(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    loop_forest forest;
+    find_loops(graph, &forest);
+    if (forest.count == 0) return 0;
+
+    licm_state state;
+    state.ssa = ssa;
+    state.def_block = (int*)malloc(ssa->name_count * sizeof(int));
+    state.quad_block = (int*)malloc(fn->count * sizeof(int));
+    state.hoist_stamp = (int*)malloc(fn->count * sizeof(int));
+    state.order_capacity = 16;
+    state.hoist_order = (int*)malloc(state.order_capacity * sizeof(int));
+    state.hoisted = 0;
+    for (int v = 0; v < ssa->name_count; v++) {
+        state.def_block[v] = -1;
+    }
+    for (int b = 0; b < graph->count; b++) {
+        for (int i = graph->blocks[b].first; i <= graph->blocks[b].last; i++) {
+            state.quad_block[i] = b;
+            state.hoist_stamp[i] = -1;
+            if (ir_is_variable(fn->code[i].result)) {
+                state.def_block[ssa_name_index(ssa, fn->code[i].result)] = b;
+            }
+        }
+        for (int p = 0; p < ssa->blocks[b].phi_count; p++) {
+            state.def_block[ssa_name_index(ssa, ssa->blocks[b].phis[p].result)] = b;
+        }
+    }
+
+    int total = 0;
+    for (int l = 0; l < forest.count; l++) {
+        natural_loop* loop = &forest.loops[l];
+        char* label = graph->blocks[loop->header].label;
+        if (loop->preheader < 0) {
+            ir_add_note(fn, "licm: loop at %s skipped, no preheader", label ? label : "entry");
+            continue;
+        }
+        int moved = hoist_from_loop(&state, loop);
+        ir_add_note(fn, "licm: loop at %s (%d blocks): %d hoisted", label ? label : "entry", loop->count, moved);
+        total += moved;
+    }
+    if (state.hoisted > 0) rebuild_code(&state);
+
+    free(state.def_block);
+    free(state.quad_block);
+    free(state.hoist_stamp);
+    free(state.hoist_order);
+    release_loops(&forest);
+    return total;
+}
@@ -0,0 +1,23 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "ssa.h"
+#include "loop.h"
+
+// ============================================================================
+// LOOP-INVARIANT CODE MOTION
+// ============================================================================
+// Works on SSA form, loops innermost first. A definition is invariant when
+// every operand is a literal or is defined outside the loop, or by another
+// invariant definition. Invariant pure definitions move to the end of the
+// preheader, where they run once even if the loop body never does; as SSA
+// names are assigned once, an extra evaluation cannot clobber a value.
+// An operation that may trap (division by a variable, string indexing)
+// only moves when it sits in the header behind nothing but pure code: the
+// header runs whenever the preheader does, so the trap would have happened
+// at the same point anyway. Loops without a preheader are left alone.
+
+// Returns the number of instructions hoisted, and notes the count per loop
+int hoist_loop_invariants(ssa_form* ssa);
+
+#endif // LICM_H
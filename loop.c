@@ -0,0 +1,281 @@
+#include "loop.h"
+
+static int by_size_then_header(const void* a, const void* b) {
+    const natural_loop* left = (const natural_loop*)a;
+    const natural_loop* right = (const natural_loop*)b;
+    if (left->count != right->count) return left->count - right->count;
+    return left->header - right->header;
+}
+
+static void push_block(int** list, int* count, int* capacity, int id) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 8;
+        *list = (int*)realloc(*list, *capacity * sizeof(int));
+    }
+    (*list)[(*count)++] = id;
+}
+
+void find_loops(cfg* graph, loop_forest* forest) {
+    memset(forest, 0, sizeof(loop_forest));
+    if (graph->count == 0) return;
+
+    // Depth-first search recording back edges as (source, header) pairs;
+    // state 1 is on the stack, 2 is finished
+    char* state = (char*)calloc(graph->count, 1);
+    int* stack = (int*)malloc(graph->count * sizeof(int));
+    int* next_succ = (int*)calloc(graph->count, sizeof(int));
+    int* back_edges = NULL;
+    int back_count = 0, back_capacity = 0;
+    int depth = 0;
+    stack[depth++] = 0;
+    state[0] = 1;
+    while (depth > 0) {
+        basic_block* block = &graph->blocks[stack[depth - 1]];
+        if (next_succ[block->id] == block->succ_count) {
+            state[block->id] = 2;
+            depth--;
+            continue;
+        }
+        int succ = block->succs[next_succ[block->id]++];
+        if (state[succ] == 1) {
+            push_block(&back_edges, &back_count, &back_capacity, block->id);
+            push_block(&back_edges, &back_count, &back_capacity, succ);
+        } else if (state[succ] == 0) {
+            state[succ] = 1;
+            stack[depth++] = succ;
+        }
+    }
+
+    // Body of each header: everything that reaches one of its back edge
+    // sources without passing through the header
+    int* mark = (int*)malloc(graph->count * sizeof(int));
+    for (int b = 0; b < graph->count; b++) {
+        mark[b] = -1;
+    }
+    int capacity = 0;
+    for (int e = 0; e < back_count; e += 2) {
+        int h = back_edges[e + 1];
+        if (mark[h] == h) continue;
+        mark[h] = h;
+
+        int top = 0;
+        for (int k = e; k < back_count; k += 2) {
+            int source = back_edges[k];
+            if (back_edges[k + 1] != h || mark[source] == h) continue;
+            mark[source] = h;
+            stack[top++] = source;
+        }
+        while (top > 0) {
+            basic_block* block = &graph->blocks[stack[--top]];
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (!state[pred] || mark[pred] == h) continue;
+                mark[pred] = h;
+                stack[top++] = pred;
+            }
+        }
+
+        if (forest->count == capacity) {
+            capacity = capacity ? capacity * 2 : 4;
+            forest->loops = (natural_loop*)realloc(forest->loops, capacity * sizeof(natural_loop));
+        }
+        natural_loop* loop = &forest->loops[forest->count++];
+        loop->header = h;
+        loop->count = 0;
+        for (int b = 0; b < graph->count; b++) {
+            if (mark[b] == h) loop->count++;
+        }
+        loop->blocks = (int*)malloc(loop->count * sizeof(int));
+        loop->count = 0;
+        for (int b = 0; b < graph->count; b++) {
+            if (mark[b] == h) loop->blocks[loop->count++] = b;
+        }
+
+        int outside = -1, outside_count = 0;
+        for (int p = 0; p < graph->blocks[h].pred_count; p++) {
+            int pred = graph->blocks[h].preds[p];
+            if (!state[pred] || loop_contains(loop, pred)) continue;
+            outside = pred;
+            outside_count++;
+        }
+        loop->preheader = (outside_count == 1 && graph->blocks[outside].succ_count == 1) ? outside : -1;
+    }
+
+    qsort(forest->loops, forest->count, sizeof(natural_loop), by_size_then_header);
+
+    free(state);
+    free(stack);
+    free(next_succ);
+    free(back_edges);
+    free(mark);
+}
+
+void release_loops(loop_forest* forest) {
+    for (int i = 0; i < forest->count; i++) {
+        free(forest->loops[i].blocks);
+    }
+    free(forest->loops);
+    memset(forest, 0, sizeof(loop_forest));
+}
+
+int loop_contains(natural_loop* loop, int block) {
+    int low = 0, high = loop->count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (loop->blocks[mid] == block) return 1;
+        if (loop->blocks[mid] < block) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return 0;
+}
+
+int insert_preheaders(ir_function* fn) {
+    if (fn->count == 0) return 0;
+
+    cfg graph;
+    cfg_build(&graph, fn);
+    loop_forest forest;
+    find_loops(&graph, &forest);
+
+    // Preheader label of each header that needs one
+    char** preheader_label = (char**)calloc(graph.count, sizeof(char*));
+    int inserted = 0;
+    for (int l = 0; l < forest.count; l++) {
+        natural_loop* loop = &forest.loops[l];
+        basic_block* header = &graph.blocks[loop->header];
+        if (loop->preheader >= 0 || !header->label) continue;
+
+        char* label = ir_new_label(fn);
+        preheader_label[loop->header] = label;
+        inserted++;
+
+        // Outside predecessors jump to the new label; a fallthrough from
+        // outside, or the function entry, reaches it because it goes right
+        // before the header
+        for (int p = 0; p < header->pred_count; p++) {
+            basic_block* pred = &graph.blocks[header->preds[p]];
+            quad* last = cfg_last_quad(&graph, pred);
+            if (loop_contains(loop, pred->id) || !last || !is_jump_opcode(last->opcode)) continue;
+            if (cfg_block_of_label(&graph, last->target) == loop->header) last->target = label;
+        }
+    }
+
+    // Insert from the bottom up so the block ranges stay valid
+    for (int b = graph.count - 1; b >= 0; b--) {
+        if (!preheader_label[b]) continue;
+        ir_insert(fn, graph.blocks[b].first, IR_LABEL)->target = preheader_label[b];
+        if (b == 0) continue;
+
+        // A latch that fell into the header must now jump over the preheader
+        natural_loop* loop = NULL;
+        for (int l = 0; l < forest.count; l++) {
+            if (forest.loops[l].header == b) loop = &forest.loops[l];
+        }
+        quad* last = cfg_last_quad(&graph, &graph.blocks[b - 1]);
+        int falls_through = !last || (last->opcode != IR_GOTO && last->opcode != IR_RETURN &&
+                                      last->opcode != IR_TAIL_CALL);
+        if (falls_through && loop_contains(loop, b - 1)) {
+            ir_insert(fn, graph.blocks[b].first, IR_GOTO)->target = graph.blocks[b].label;
+        }
+    }
+
+    free(preheader_label);
+    release_loops(&forest);
+    cfg_release(&graph);
+    return inserted;
+}
+
+// Index of the conditional jump ending the test after the label at index
+// start, or -1 if the test is not short straight-line code
+static int rotatable_test_end(ir_function* fn, int start) {
+    for (int i = start + 1; i < fn->count && i <= start + LOOP_ROTATE_MAX_TEST + 1; i++) {
+        quad* q = &fn->code[i];
+        if (q->opcode == IR_LABEL || q->opcode == IR_RETURN || q->opcode == IR_TAIL_CALL || q->opcode == IR_GOTO) return -1;
+        if (q->opcode != IR_IF_FALSE && q->opcode != IR_IF_TRUE) continue;
+        return q->target == fn->code[start].target ? -1 : i;
+    }
+    return -1;
+}
+
+// The test at index end must leave the loop ending at the goto at index
+// back, and be its only exit: with more exits, such as the later tests of
+// an "and" condition, the values leaving the loop would have to be merged
+static int is_single_exit(ir_function* fn, int* label_at, int end, int back) {
+    char* exit = fn->code[end].target;
+    int exit_at = label_at[ir_label_number(fn, exit)];
+    if (exit_at <= back) return 0;
+    for (int i = end + 1; i < back; i++) {
+        if (is_jump_opcode(fn->code[i].opcode) && fn->code[i].target == exit) return 0;
+    }
+    return 1;
+}
+
+int rotate_loops(ir_function* fn) {
+    int* label_at = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        label_at[l] = -1;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        if (fn->code[i].opcode != IR_LABEL) continue;
+        int label = ir_label_number(fn, fn->code[i].target);
+        if (label) label_at[label] = i;
+    }
+
+    // Find the loop tests: labels a later goto jumps back to
+    int* test_end = (int*)malloc(fn->count * sizeof(int));
+    char** body_label = (char**)calloc(fn->count, sizeof(char*));
+    int rotated = 0;
+    for (int i = 0; i < fn->count; i++) {
+        test_end[i] = -1;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        if (q->opcode != IR_GOTO) continue;
+        int start = label_at[ir_label_number(fn, q->target)];
+        if (start < 0 || start > i) continue;
+        if (test_end[start] < 0) test_end[start] = rotatable_test_end(fn, start);
+        int end = test_end[start];
+        if (end < 0 || end > i || !is_single_exit(fn, label_at, end, i)) continue;
+        if (!body_label[end]) {
+            body_label[end] = ir_new_label(fn);
+            rotated++;
+        }
+    }
+
+    if (rotated > 0) {
+        quad* code = fn->code;
+        int count = fn->count;
+        fn->code = NULL;
+        fn->count = 0;
+        fn->capacity = 0;
+        for (int i = 0; i < count; i++) {
+            quad* q = &code[i];
+            int start = q->opcode == IR_GOTO ? label_at[ir_label_number(fn, q->target)] : -1;
+            int end = start >= 0 && start < i ? test_end[start] : -1;
+            if (end < 0 || end > i || !body_label[end]) {
+                *ir_append(fn, q->opcode) = *q;
+                if (body_label[i]) ir_emit_label(fn, body_label[i]);
+                continue;
+            }
+
+            // Copy the test with its jump inverted to stay in the loop
+            for (int k = start + 1; k < end; k++) {
+                *ir_append(fn, code[k].opcode) = code[k];
+            }
+            quad* test = ir_append(fn, code[end].opcode);
+            *test = code[end];
+            test->opcode = code[end].opcode == IR_IF_FALSE ? IR_IF_TRUE : IR_IF_FALSE;
+            test->target = body_label[end];
+            ir_emit_goto(fn, code[end].target);
+        }
+        free(code);
+    }
+
+    free(label_at);
+    free(test_end);
+    free(body_label);
+    return rotated;
+}
@@ -0,0 +1,59 @@
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "cfg.h"
+
+// ============================================================================
+// NATURAL LOOPS
+// ============================================================================
+// A back edge is an edge to a block that is still on the depth-first
+// search stack. The generated code only contains while loops and if
+// chains, so its graphs are reducible and every back edge goes to a block
+// dominating its source. The natural loop of a header is the header plus
+// every block that reaches a back edge source without passing the header;
+// back edges to the same header share one loop.
+
+typedef struct natural_loop {
+    int header;
+    int* blocks;          // Block ids of the body, ascending, header included
+    int count;
+    int preheader;        // Only outside predecessor when it has no other successor, else -1
+} natural_loop;
+
+typedef struct loop_forest {
+    natural_loop* loops;  // Inner loops before the loops containing them
+    int count;
+} loop_forest;
+
+// ============================================================================
+// DETECTION AND PREHEADERS
+// ============================================================================
+
+void find_loops(cfg* graph, loop_forest* forest);
+void release_loops(loop_forest* forest);
+int loop_contains(natural_loop* loop, int block);
+
+// Give every loop header a single outside predecessor that falls into it
+// and nothing else; returns the number of preheader labels inserted
+int insert_preheaders(ir_function* fn);
+
+// ============================================================================
+// ROTATION
+// ============================================================================
+// A while loop is generated as
+//     Ls: <test>; if_false c goto Le; <body>; goto Ls; Le:
+// which takes a conditional and an unconditional branch per iteration.
+// Rotation keeps the top test as a guard that runs once and turns every
+// backward goto Ls into a copy of the test that jumps back to the top of
+// the body when it holds:
+//     Ls: <test>; if_false c goto Le; Lb: <body>; <test>; if_true c goto Lb; goto Le
+// The trailing goto is removed later when Le follows. The test is evaluated
+// exactly as often as before. Only loops whose single exit is that test
+// are rotated, and only tests of at most this many straight-line
+// instructions are copied.
+#define LOOP_ROTATE_MAX_TEST 8
+
+// Returns the number of loops rotated
+int rotate_loops(ir_function* fn);
+
+#endif // LOOP_H
@@ -0,0 +1,481 @@
+#include <math.h>
+#include <limits.h>
+#include "optimize.h"
+#include "intern.h"
+#include "ssa.h"
+#include "dce.h"
+#include "peephole.h"
+#include "gvn.h"
+#include "simplify.h"
+#include "loop.h"
+#include "licm.h"
+#include "inline.h"
+#include "tailcall.h"
+#include "consteval.h"
+#include "specialize.h"
+#include "jumptable.h"
+
+int optimize_level = 0;
+int optimize_report = 0;
+
+// Check the leading characters shared by every numeric literal
+static int starts_like_number(const char* operand) {
+    if (!operand) return 0;
+    if (operand[0] == '-') operand++;
+    return operand[0] >= '0' && operand[0] <= '9';
+}
+
+// Integer literal that fits the 32-bit int type
+int is_int_literal(const char* operand) {
+    if (!starts_like_number(operand)) return 0;
+
+    char* end;
+    long long value = strtoll(operand, &end, 10);
+    return *end == '\0' && value >= INT_MIN && value <= INT_MAX;
+}
+
+// Float literal; folded results may also use exponent notation
+int is_float_literal(const char* operand) {
+    if (!starts_like_number(operand)) return 0;
+    if (!strchr(operand, '.') && !strchr(operand, 'e')) return 0;
+
+    char* end;
+    strtod(operand, &end);
+    return *end == '\0';
+}
+
+int is_numeric_literal(const char* operand) {
+    return is_int_literal(operand) || is_float_literal(operand);
+}
+
+// Operands are interned, so boolean literals are compared by pointer.
+// True/False are identifiers to the lexer and may name variables.
+int is_bool_literal(const char* operand) {
+    return operand == ATOM_TRUE || operand == ATOM_FALSE;
+}
+
+int bool_literal_value(const char* operand) {
+    return operand == ATOM_TRUE;
+}
+
+char* make_int_literal(long long value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%lld", value);
+    return intern(buffer);
+}
+
+// Print a float so that it reads back exactly and still looks like a float
+char* make_float_literal(double value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+
+    // Prefer the shortest spelling that round-trips
+    for (int precision = 1; precision < 17; precision++) {
+        char shorter[64];
+        snprintf(shorter, sizeof(shorter), "%.*g", precision, value);
+        if (strtod(shorter, NULL) == value) {
+            strcpy(buffer, shorter);
+            break;
+        }
+    }
+
+    if (!strchr(buffer, '.') && !strchr(buffer, 'e')) {
+        strcat(buffer, ".0");
+    }
+    return intern(buffer);
+}
+
+char* make_bool_literal(int value) {
+    return value ? ATOM_TRUE : ATOM_FALSE;
+}
+
+char* convert_literal(char* operand, int type) {
+    if (type == TYPE_FLOAT && is_int_literal(operand)) return make_float_literal(strtod(operand, NULL));
+    return operand;
+}
+
+// Fold an int operation; NULL if the result is not a well-defined 32-bit int
+static char* fold_int_binary(ir_op op, long long a, long long b) {
+    long long result;
+
+    switch (op) {
+        case OP_ADD: result = a + b; break;
+        case OP_SUB: result = a - b; break;
+        case OP_MUL: result = a * b; break;
+        case OP_DIV:
+        case OP_MOD:
+            // Division truncates toward zero and the remainder takes the
+            // sign of the dividend, as strength reduction assumes too
+            if (b == 0) return NULL;
+            result = (op == OP_DIV) ? a / b : a % b;
+            break;
+        case OP_POW:
+            if (b < 0) return NULL;
+            result = 1;
+            for (long long i = 0; i < b; i++) {
+                result *= a;
+                if (result > INT_MAX || result < INT_MIN) return NULL;
+                // 0, 1 and -1 can reach any exponent without overflowing
+                if (result == 0 || result == 1) break;
+                if (result == -1) {
+                    result = ((b - i - 1) % 2 == 0) ? -1 : 1;
+                    break;
+                }
+            }
+            break;
+        case OP_EQ: return make_bool_literal(a == b);
+        case OP_NE: return make_bool_literal(a != b);
+        case OP_LT: return make_bool_literal(a < b);
+        case OP_GT: return make_bool_literal(a > b);
+        case OP_LE: return make_bool_literal(a <= b);
+        case OP_GE: return make_bool_literal(a >= b);
+        // Strength reduction shifts 32-bit values by 0 to 31 places
+        case OP_SHL:
+            if (b < 0 || b > 31) return NULL;
+            result = a * (1LL << b);
+            break;
+        case OP_SHR:
+            if (b < 0 || b > 31) return NULL;
+            result = a >> b;
+            break;
+        case OP_BITAND: result = a & b; break;
+        case OP_MULHI: result = (a * b) >> 32; break;
+        default: return NULL;
+    }
+
+    if (result > INT_MAX || result < INT_MIN) return NULL;
+    return make_int_literal(result);
+}
+
+// Fold a float operation; NULL if the result is not a finite number
+static char* fold_float_binary(ir_op op, double a, double b) {
+    double result;
+
+    switch (op) {
+        case OP_ADD: result = a + b; break;
+        case OP_SUB: result = a - b; break;
+        case OP_MUL: result = a * b; break;
+        case OP_DIV:
+            if (b == 0.0) return NULL;
+            result = a / b;
+            break;
+        case OP_MOD:
+            // fmod: the remainder takes the sign of the dividend
+            if (b == 0.0) return NULL;
+            result = fmod(a, b);
+            break;
+        case OP_POW: result = pow(a, b); break;
+        case OP_EQ: return make_bool_literal(a == b);
+        case OP_NE: return make_bool_literal(a != b);
+        case OP_LT: return make_bool_literal(a < b);
+        case OP_GT: return make_bool_literal(a > b);
+        case OP_LE: return make_bool_literal(a <= b);
+        case OP_GE: return make_bool_literal(a >= b);
+        default: return NULL;
+    }
+
+    if (!isfinite(result)) return NULL;
+    return make_float_literal(result);
+}
+
+// Fold a binary operation on two literals, following the typing rules of
+// get_expression_type: int op int is int, any float operand makes it float
+char* fold_binary(ir_op op, char* left, char* right) {
+    if (!left || !right) return NULL;
+
+    if (is_int_literal(left) && is_int_literal(right)) {
+        return fold_int_binary(op, strtoll(left, NULL, 10), strtoll(right, NULL, 10));
+    }
+
+    if (is_numeric_literal(left) && is_numeric_literal(right)) {
+        return fold_float_binary(op, strtod(left, NULL), strtod(right, NULL));
+    }
+
+    if (is_bool_literal(left) && is_bool_literal(right)) {
+        if (op == OP_EQ) return make_bool_literal(bool_literal_value(left) == bool_literal_value(right));
+        if (op == OP_NE) return make_bool_literal(bool_literal_value(left) != bool_literal_value(right));
+    }
+
+    return NULL;
+}
+
+char* fold_not(char* operand) {
+    if (!is_bool_literal(operand)) return NULL;
+    return make_bool_literal(!bool_literal_value(operand));
+}
+
+// Can evaluating this instruction stop the program? Division by a
+// non-literal or zero divisor and string indexing can fail at run time.
+int quad_may_trap(quad* q) {
+    if (q->opcode == IR_INDEX) return 1;
+    if (q->opcode != IR_BINARY || (q->op != OP_DIV && q->op != OP_MOD)) return 0;
+    return !is_numeric_literal(q->args[1]) || strtod(q->args[1], NULL) == 0.0;
+}
+
+// Instructions whose only effect is the value they write
+int is_pure_definition(quad* q) {
+    switch (q->opcode) {
+        case IR_COPY:
+        case IR_BINARY:
+        case IR_NOT:
+        case IR_INDEX:
+        case IR_SLICE:
+        case IR_SLICE_STEP:
+            return !quad_may_trap(q);
+        default:
+            return 0;
+    }
+}
+
+// Lifetime of one temporary as a range of instruction indexes
+typedef struct temp_range {
+    int start;
+    int end;
+    int starts_with_use;  // First occurrence reads the temporary
+    int slot;
+} temp_range;
+
+static void note_occurrence(temp_range* range, int index, int is_use) {
+    if (range->start < 0) {
+        range->start = index;
+        range->starts_with_use = is_use;
+    }
+    range->end = index;
+}
+
+// A temporary live around a back edge must keep its name for the whole
+// loop. Without a CFG every range that crosses the loop boundary, or that
+// is read before it is written, is widened to cover the loop.
+static void extend_ranges_over_loops(ir_function* fn, temp_range* ranges, int* label_index) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int j = 0; j < fn->count; j++) {
+            quad* q = &fn->code[j];
+            if (q->opcode != IR_GOTO && q->opcode != IR_IF_FALSE && q->opcode != IR_IF_TRUE) continue;
+
+            int label = ir_label_number(fn, q->target);
+            if (!label || label_index[label] < 0 || label_index[label] > j) continue;
+            int head = label_index[label];
+
+            for (int t = 1; t <= fn->temp_count; t++) {
+                temp_range* range = &ranges[t];
+                if (range->start < 0 || range->start > j || range->end < head) continue;
+
+                int contained = range->start >= head && range->end <= j;
+                if (contained && !range->starts_with_use) continue;
+                if (range->start <= head && range->end >= j) continue;
+
+                if (range->start > head) range->start = head;
+                if (range->end < j) range->end = j;
+                changed = 1;
+            }
+        }
+    }
+}
+
+// Ranges ordered by start for the linear scan
+static temp_range* sort_ranges;
+
+static int by_start(const void* a, const void* b) {
+    int left = *(const int*)a;
+    int right = *(const int*)b;
+    if (sort_ranges[left].start != sort_ranges[right].start) {
+        return sort_ranges[left].start - sort_ranges[right].start;
+    }
+    return left - right;
+}
+
+// Min-heap of active temporaries keyed by the end of their range
+static void heap_push(int* heap, int* size, temp_range* ranges, int t) {
+    int i = (*size)++;
+    heap[i] = t;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (ranges[heap[parent]].end <= ranges[heap[i]].end) break;
+        int swap = heap[parent];
+        heap[parent] = heap[i];
+        heap[i] = swap;
+        i = parent;
+    }
+}
+
+static int heap_pop(int* heap, int* size, temp_range* ranges) {
+    int top = heap[0];
+    heap[0] = heap[--(*size)];
+    int i = 0;
+    for (;;) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        if (left < *size && ranges[heap[left]].end < ranges[heap[smallest]].end) smallest = left;
+        if (right < *size && ranges[heap[right]].end < ranges[heap[smallest]].end) smallest = right;
+        if (smallest == i) break;
+        int swap = heap[smallest];
+        heap[smallest] = heap[i];
+        heap[i] = swap;
+        i = smallest;
+    }
+    return top;
+}
+
+int reuse_temporaries(ir_function* fn) {
+    int temps = fn->temp_count;
+    if (temps == 0) return 0;
+
+    temp_range* ranges = (temp_range*)malloc((temps + 1) * sizeof(temp_range));
+    for (int t = 0; t <= temps; t++) {
+        ranges[t].start = -1;
+        ranges[t].end = -1;
+        ranges[t].starts_with_use = 0;
+        ranges[t].slot = -1;
+    }
+    int* label_index = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        label_index[l] = -1;
+    }
+
+    // Operands are read before the result is written
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        if (q->opcode == IR_LABEL) {
+            int label = ir_label_number(fn, q->target);
+            if (label) label_index[label] = i;
+            continue;
+        }
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            int t = ir_temp_number(fn, q->args[a]);
+            if (t) note_occurrence(&ranges[t], i, 1);
+        }
+        int t = ir_temp_number(fn, q->result);
+        if (t) note_occurrence(&ranges[t], i, 0);
+    }
+    extend_ranges_over_loops(fn, ranges, label_index);
+
+    // Linear scan: a range takes the slot of one that ended before it.
+    // It may also take the slot of an operand of its own defining instruction.
+    int* order = (int*)malloc(temps * sizeof(int));
+    int* active = (int*)malloc(temps * sizeof(int));
+    int* free_slots = (int*)malloc(temps * sizeof(int));
+    int ordered = 0, active_count = 0, free_count = 0, slots = 0;
+
+    for (int t = 1; t <= temps; t++) {
+        if (ranges[t].start >= 0) order[ordered++] = t;
+    }
+    sort_ranges = ranges;
+    qsort(order, ordered, sizeof(int), by_start);
+
+    for (int k = 0; k < ordered; k++) {
+        temp_range* range = &ranges[order[k]];
+        while (active_count > 0) {
+            temp_range* oldest = &ranges[active[0]];
+            int expired = oldest->end < range->start ||
+                          (oldest->end == range->start && !range->starts_with_use);
+            if (!expired) break;
+            free_slots[free_count++] = ranges[heap_pop(active, &active_count, ranges)].slot;
+        }
+        range->slot = free_count > 0 ? free_slots[--free_count] : slots++;
+        heap_push(active, &active_count, ranges, order[k]);
+    }
+
+    // Rewrite every operand with the name of its slot
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            int t = ir_temp_number(fn, q->args[a]);
+            if (t) q->args[a] = ir_temp_name(ranges[t].slot + 1);
+        }
+        int t = ir_temp_number(fn, q->result);
+        if (t) q->result = ir_temp_name(ranges[t].slot + 1);
+    }
+    fn->temp_count = slots;
+
+    free(ranges);
+    free(label_index);
+    free(order);
+    free(active);
+    free(free_slots);
+    return slots;
+}
+
+// Run every 3AC optimization over one generated function
+void optimize_function(ir_program* program, ir_function* fn) {
+    // Calls with literal arguments first, then again once SSA has
+    // propagated constants into more of them
+    constant_call_stats evaluated, reevaluated;
+    evaluate_constant_calls(program, fn, &evaluated);
+    int inlined = inline_calls(program, fn);
+    ir_add_note(fn, "inline: %d calls inlined", inlined);
+    specialize_stats specialized;
+    specialize_calls(program, fn, &specialized);
+    ir_add_note(fn, "specialize: %d call sites retargeted, %d clones created",
+                specialized.retargeted, specialized.created);
+    tail_call_stats tail;
+    eliminate_tail_calls(fn, &tail);
+    ir_add_note(fn, "tail calls: %d to itself turned into jumps, %d into TailCall", tail.self, tail.other);
+
+    // Clean up the generator's patterns first, and what the passes leave at the end
+    peephole_optimize(fn);
+    int simplified = simplify_algebra(fn);
+    int unreachable = remove_unreachable_code(fn);
+    int rotated = rotate_loops(fn);
+    int preheaders = insert_preheaders(fn);
+    ir_add_note(fn, "loops: %d rotated, %d preheaders inserted", rotated, preheaders);
+    int dead = 0;
+
+    ssa_form ssa;
+    if (ssa_build(&ssa, fn)) {
+        value_numbering_stats numbering;
+        number_values(&ssa, &numbering);
+        simplified += numbering.simplified;
+        ir_add_note(fn, "value numbering: %d redundant (%d local, %d global), %d folded, %d phis merged",
+                    numbering.local + numbering.global, numbering.local, numbering.global,
+                    numbering.folded, numbering.phis);
+        int hoisted = hoist_loop_invariants(&ssa);
+        ir_add_note(fn, "licm: %d hoisted", hoisted);
+        dead = remove_dead_assignments(&ssa);
+        ir_add_note(fn, "ssa: %d phis placed", ssa.phi_total);
+        int removed = ssa_destroy(&ssa);
+        ir_add_note(fn, "out of ssa: %d copies coalesced", removed);
+    } else {
+        ir_add_note(fn, "ssa: skipped, function too large");
+    }
+    evaluate_constant_calls(program, fn, &reevaluated);
+    ir_add_note(fn, "eval: %d calls folded, %d memo hits", evaluated.folded + reevaluated.folded,
+                evaluated.memo_hits + reevaluated.memo_hits);
+
+    int jumps = remove_redundant_jumps(fn);
+
+    int reduced = reduce_strength(fn);
+    ir_add_note(fn, "algebra: %d simplified, %d strength-reduced", simplified, reduced);
+
+    peephole_optimize(fn);
+    note_peephole_hits(fn);
+
+    // Sweep again for what the passes since SSA leave behind
+    unreachable += remove_unreachable_code(fn);
+    dead += remove_dead_temporaries(fn);
+    jumps += remove_redundant_jumps(fn);
+    ir_add_note(fn, "dead code: %d instructions removed (%d unreachable, %d dead assignments, %d jumps)",
+                unreachable + dead + jumps, unreachable, dead, jumps);
+
+    int generated = fn->temp_count;
+    int peak = reuse_temporaries(fn);
+    ir_add_note(fn, "temporaries: %d before reuse, peak %d live", generated, peak);
+
+    // Last, so no pass before has to follow a switch
+    int switches = lower_switches(fn);
+    ir_add_note(fn, "switch: %d if-elif chains lowered", switches);
+}
+
+// Print the notes the passes recorded for each function
+void print_optimization_report(FILE* out, ir_program* program) {
+    fprintf(out, "=== Optimization Report ===\n");
+    for (ir_function* fn = program->first; fn; fn = fn->next) {
+        fprintf(out, "%s:\n", ir_function_label(fn));
+        for (int i = 0; i < fn->note_count; i++) {
+            fprintf(out, "    %s\n", fn->notes[i]);
+        }
+    }
+    fprintf(out, "\n");
+}
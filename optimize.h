@@ -0,0 +1,74 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "semantic_analysis.h"
+#include "ir.h"
+
+// ============================================================================
+// GLOBAL STATE MANAGEMENT
+// ============================================================================
+
+// 0 emits the code exactly as generated; 1 (set by -O) enables optimizations
+extern int optimize_level;
+
+// Set by --report: print what the optimizations did to each function
+extern int optimize_report;
+
+// ============================================================================
+// LITERAL OPERANDS
+// ============================================================================
+// Operands are interned strings. A literal is recognized by its spelling:
+// identifiers and temporaries never start with a digit or '-'.
+
+int is_int_literal(const char* operand);
+int is_float_literal(const char* operand);
+int is_numeric_literal(const char* operand);
+int is_bool_literal(const char* operand);
+int bool_literal_value(const char* operand);
+char* make_int_literal(long long value);
+char* make_float_literal(double value);
+char* make_bool_literal(int value);
+
+// The operand as a value of a TYPE_*: an int literal bound to a float
+// becomes a float literal, anything else is returned as it is
+char* convert_literal(char* operand, int type);
+
+// ============================================================================
+// CONSTANT FOLDING
+// ============================================================================
+// Each folder returns the interned literal result, or NULL when the
+// operation cannot be evaluated safely at compile time.
+
+char* fold_binary(ir_op op, char* left, char* right);
+char* fold_not(char* operand);
+
+// ============================================================================
+// SIDE EFFECTS
+// ============================================================================
+// A pure definition can be removed when its result is unused, or moved,
+// without changing what the program does.
+
+int quad_may_trap(quad* q);
+int is_pure_definition(quad* q);
+
+// ============================================================================
+// TEMPORARY REUSE
+// ============================================================================
+// Renames the temporaries of a function so that temporaries with disjoint
+// lifetimes share a name. Returns the peak number of live temporaries.
+
+int reuse_temporaries(ir_function* fn);
+
+// ============================================================================
+// PASS PIPELINE
+// ============================================================================
+
+void optimize_function(ir_program* program, ir_function* fn);
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+void print_optimization_report(FILE* out, ir_program* program);
+
+#endif // OPTIMIZE_H
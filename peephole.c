@@ -0,0 +1,312 @@
+#include "peephole.h"
+#include "optimize.h"
+#include "cfg.h"
+
+int peephole_window = PEEPHOLE_DEFAULT_WINDOW;
+
+struct peephole_state {
+    ir_function* fn;
+    char* removed;        // Instructions deleted in this run
+    int* temp_uses;       // Reads of each temporary, by number
+    int* label_refs;      // Jumps to each label, by number
+    int* label_at;        // Index of each label's instruction, -1 if none
+};
+
+// ============================================================================
+// BOOKKEEPING
+// ============================================================================
+
+static void count_operands(peephole_state* state, quad* q, int delta) {
+    for (int a = 0; a < IR_MAX_ARGS; a++) {
+        int t = ir_temp_number(state->fn, q->args[a]);
+        if (t) state->temp_uses[t] += delta;
+    }
+    if (is_jump_opcode(q->opcode)) {
+        int l = ir_label_number(state->fn, q->target);
+        if (l) state->label_refs[l] += delta;
+    }
+}
+
+static void remove_quad(peephole_state* state, int i) {
+    count_operands(state, &state->fn->code[i], -1);
+    state->removed[i] = 1;
+}
+
+static void retarget_jump(peephole_state* state, quad* q, char* label) {
+    int old = ir_label_number(state->fn, q->target);
+    int l = ir_label_number(state->fn, label);
+    if (old) state->label_refs[old]--;
+    if (l) state->label_refs[l]++;
+    q->target = label;
+}
+
+// Next instruction still in the code, skipping comments; -1 at the end
+static int next_quad(peephole_state* state, int i) {
+    for (int j = i + 1; j < state->fn->count; j++) {
+        if (!state->removed[j] && state->fn->code[j].opcode != IR_COMMENT) return j;
+    }
+    return -1;
+}
+
+// First instruction after a label and any labels that follow it
+static int code_after_label(peephole_state* state, char* label) {
+    int l = ir_label_number(state->fn, label);
+    if (!l || state->label_at[l] < 0) return -1;
+    int j = next_quad(state, state->label_at[l]);
+    while (j >= 0 && state->fn->code[j].opcode == IR_LABEL) {
+        j = next_quad(state, j);
+    }
+    return j;
+}
+
+static int defines_value(quad* q) {
+    return q->result && q->opcode != IR_LABEL && q->opcode != IR_COMMENT;
+}
+
+// ============================================================================
+// RULES
+// ============================================================================
+
+// t = <expr>; x = t   =>   x = <expr>   when that copy is t's only read
+static int fold_copy_of_temp(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    int t = ir_temp_number(state->fn, q->result);
+    if (!t || !defines_value(q) || state->temp_uses[t] != 1) return 0;
+
+    int j = next_quad(state, i);
+    if (j < 0) return 0;
+    quad* copy = &state->fn->code[j];
+    if (copy->opcode != IR_COPY || copy->args[0] != q->result) return 0;
+
+    q->result = copy->result;
+    if (copy->type) q->type = copy->type;
+    remove_quad(state, j);
+    return 1;
+}
+
+// t = <literal>; ... use t   =>   ... use <literal>   for a temporary read
+// once within the window, with no label in between
+static int propagate_literal_temp(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    int t = ir_temp_number(state->fn, q->result);
+    if (!t || q->opcode != IR_COPY || ir_is_variable(q->args[0])) return 0;
+    if (state->temp_uses[t] != 1) return 0;
+
+    int j = i;
+    for (int step = 0; step < peephole_window; step++) {
+        j = next_quad(state, j);
+        if (j < 0 || state->fn->code[j].opcode == IR_LABEL) return 0;
+
+        quad* use = &state->fn->code[j];
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            if (use->args[a] != q->result) continue;
+            use->args[a] = q->args[0];
+            state->temp_uses[t]--;
+            remove_quad(state, i);
+            return 1;
+        }
+        if (use->result == q->result || is_jump_opcode(use->opcode) || use->opcode == IR_RETURN ||
+            use->opcode == IR_TAIL_CALL) return 0;
+    }
+    return 0;
+}
+
+// x = x
+static int remove_self_copy(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    if (q->opcode != IR_COPY || q->result != q->args[0]) return 0;
+    remove_quad(state, i);
+    return 1;
+}
+
+// if_false/if_true on a condition known at compile time becomes a goto
+// when it always jumps, and is removed when it never does
+static int fold_constant_branch(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    if (q->opcode != IR_IF_FALSE && q->opcode != IR_IF_TRUE) return 0;
+
+    char* condition = q->op != OP_NONE ? fold_binary(q->op, q->args[0], q->args[1]) : q->args[0];
+    if (!is_bool_literal(condition)) return 0;
+    if (bool_literal_value(condition) != (q->opcode == IR_IF_TRUE)) {
+        remove_quad(state, i);
+        return 1;
+    }
+
+    count_operands(state, q, -1);
+    char* target = q->target;
+    memset(q, 0, sizeof(quad));
+    q->opcode = IR_GOTO;
+    q->op = OP_NONE;
+    q->target = target;
+    count_operands(state, q, 1);
+    return 1;
+}
+
+// goto L; L:   =>   L:   (also for a conditional jump)
+static int remove_jump_to_next(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    if (!is_jump_opcode(q->opcode)) return 0;
+
+    for (int j = next_quad(state, i); j >= 0 && state->fn->code[j].opcode == IR_LABEL; j = next_quad(state, j)) {
+        if (state->fn->code[j].target == q->target) {
+            remove_quad(state, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// goto L1 ... L1: goto L2   =>   goto L2 ... L1: goto L2
+static int thread_jump(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    if (!is_jump_opcode(q->opcode)) return 0;
+
+    char* target = q->target;
+    for (int hops = 0; hops <= state->fn->label_count; hops++) {
+        int j = code_after_label(state, target);
+        if (j < 0 || state->fn->code[j].opcode != IR_GOTO) break;
+        if (state->fn->code[j].target == target || state->fn->code[j].target == q->target) break;
+        target = state->fn->code[j].target;
+    }
+    if (target == q->target) return 0;
+
+    retarget_jump(state, q, target);
+    return 1;
+}
+
+// A label no jump refers to
+static int remove_unused_label(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    if (q->opcode != IR_LABEL) return 0;
+    int l = ir_label_number(state->fn, q->target);
+    if (!l || state->label_refs[l] > 0) return 0;
+
+    state->label_at[l] = -1;
+    remove_quad(state, i);
+    return 1;
+}
+
+// goto L / return / TailCall, then instructions before the next label
+static int remove_code_after_jump(peephole_state* state, int i) {
+    quad* q = &state->fn->code[i];
+    if (q->opcode != IR_GOTO && q->opcode != IR_RETURN && q->opcode != IR_TAIL_CALL) return 0;
+
+    int hits = 0;
+    for (int j = i + 1; j < state->fn->count; j++) {
+        if (state->removed[j]) continue;
+        if (state->fn->code[j].opcode == IR_LABEL) break;
+        remove_quad(state, j);
+        hits = 1;
+    }
+    return hits;
+}
+
+static peephole_rule rules[] = {
+    {"copy-fold", "t = <expr>; x = t becomes x = <expr>", fold_copy_of_temp, 1, 0},
+    {"literal-temp", "a temporary holding a literal is replaced by the literal", propagate_literal_temp, 1, 0},
+    {"self-copy", "x = x is removed", remove_self_copy, 1, 0},
+    {"constant-branch", "a conditional jump on a constant condition becomes a goto or is removed", fold_constant_branch, 1, 0},
+    {"jump-next", "a jump to the label that follows is removed", remove_jump_to_next, 1, 0},
+    {"jump-chain", "a jump to a goto jumps to its target instead", thread_jump, 1, 0},
+    {"unused-label", "labels no jump refers to are removed", remove_unused_label, 1, 0},
+    {"dead-after-jump", "code between a goto or return and the next label is removed", remove_code_after_jump, 1, 0},
+};
+
+#define RULE_COUNT ((int)(sizeof(rules) / sizeof(rules[0])))
+
+// ============================================================================
+// CONFIGURATION AND ENTRY POINT
+// ============================================================================
+
+// Enable only the rules in a comma-separated list ("none" disables all).
+// Returns 0 if the list names an unknown rule.
+int configure_peephole(const char* rule_list) {
+    for (int r = 0; r < RULE_COUNT; r++) {
+        rules[r].enabled = 0;
+    }
+    if (strcmp(rule_list, "none") == 0) return 1;
+
+    const char* p = rule_list;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        int found = 0;
+        for (int r = 0; r < RULE_COUNT; r++) {
+            if (strlen(rules[r].name) == length && strncmp(rules[r].name, p, length) == 0) {
+                rules[r].enabled = 1;
+                found = 1;
+            }
+        }
+        if (!found) return 0;
+        p += length;
+        if (*p == ',') p++;
+    }
+    return 1;
+}
+
+void print_peephole_rules(FILE* out) {
+    for (int r = 0; r < RULE_COUNT; r++) {
+        fprintf(out, "  %-16s %s\n", rules[r].name, rules[r].description);
+    }
+}
+
+// Apply the enabled rules until none fires; returns the number of rewrites
+int peephole_optimize(ir_function* fn) {
+    peephole_state state;
+    state.fn = fn;
+    state.removed = (char*)calloc(fn->count + 1, 1);
+    state.temp_uses = (int*)calloc(fn->temp_count + 1, sizeof(int));
+    state.label_refs = (int*)calloc(fn->label_count + 1, sizeof(int));
+    state.label_at = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        state.label_at[l] = -1;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        count_operands(&state, &fn->code[i], 1);
+        if (fn->code[i].opcode == IR_LABEL) {
+            int l = ir_label_number(fn, fn->code[i].target);
+            if (l) state.label_at[l] = i;
+        }
+    }
+
+    int total = 0;
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < fn->count; i++) {
+            for (int r = 0; r < RULE_COUNT && !state.removed[i]; r++) {
+                if (!rules[r].enabled || !rules[r].apply(&state, i)) continue;
+                rules[r].hits++;
+                total++;
+                changed = 1;
+            }
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < fn->count; i++) {
+        if (!state.removed[i]) fn->code[kept++] = fn->code[i];
+    }
+    fn->count = kept;
+
+    free(state.removed);
+    free(state.temp_uses);
+    free(state.label_refs);
+    free(state.label_at);
+    return total;
+}
+
+// Add the hits of every rule since the last call to the report of fn
+void note_peephole_hits(ir_function* fn) {
+    char line[256];
+    int length = snprintf(line, sizeof(line), "peephole:");
+    int total = 0;
+    for (int r = 0; r < RULE_COUNT; r++) {
+        if (rules[r].hits && length < (int)sizeof(line)) {
+            length += snprintf(line + length, sizeof(line) - length, " %s %d", rules[r].name, rules[r].hits);
+        }
+        total += rules[r].hits;
+        rules[r].hits = 0;
+    }
+    ir_add_note(fn, "%s", total ? line : "peephole: no rewrites");
+}
@@ -0,0 +1,41 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "ir.h"
+
+// ============================================================================
+// PEEPHOLE OPTIMIZER
+// ============================================================================
+// Slides over the quads of a function and lets every enabled rule of the
+// rule table rewrite the instructions at the current position, repeating
+// until no rule applies. Each rule counts its hits until they are written
+// to the function's report.
+
+#define PEEPHOLE_DEFAULT_WINDOW 4
+
+typedef struct peephole_state peephole_state;
+
+// A rule looks at the code from position i and returns 1 if it rewrote it
+typedef int (*peephole_rule_fn)(peephole_state* state, int i);
+
+typedef struct peephole_rule {
+    const char* name;
+    const char* description;
+    peephole_rule_fn apply;
+    int enabled;
+    int hits;             // Rewrites since the last note_peephole_hits
+} peephole_rule;
+
+// How many following instructions a rule may look at (--peephole-window)
+extern int peephole_window;
+
+// ============================================================================
+// CONFIGURATION AND ENTRY POINT
+// ============================================================================
+
+int configure_peephole(const char* rule_list);
+void print_peephole_rules(FILE* out);
+int peephole_optimize(ir_function* fn);
+void note_peephole_hits(ir_function* fn);
+
+#endif // PEEPHOLE_H
@@ -20,6 +20,22 @@ if [ $? -ne 0 ]; then
     exit 1
 fi
 
+# Compile arena allocator
+echo "Compiling arena allocator..."
+cc -c arena.c -o arena.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Arena allocator compilation failed!"
+    exit 1
+fi
+
+# Compile string intern table
+echo "Compiling intern table..."
+cc -c intern.c -o intern.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Intern table compilation failed!"
+    exit 1
+fi
+
 # Compile semantic analysis module
 echo "Compiling semantic analysis..."
 cc -c semantic_analysis.c -o semantic_analysis.o
@@ -28,6 +44,142 @@ if [ $? -ne 0 ]; then
     exit 1
 fi
 
+# Compile 3AC intermediate representation
+echo "Compiling IR..."
+cc -c ir.c -o ir.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: IR compilation failed!"
+    exit 1
+fi
+
+# Compile stack frame layout
+echo "Compiling frame layout..."
+cc -c frame.c -o frame.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Frame layout compilation failed!"
+    exit 1
+fi
+
+# Compile call graph
+echo "Compiling call graph..."
+cc -c callgraph.c -o callgraph.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Call graph compilation failed!"
+    exit 1
+fi
+
+# Compile control-flow graph construction
+echo "Compiling control-flow graph..."
+cc -c cfg.c -o cfg.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Control-flow graph compilation failed!"
+    exit 1
+fi
+
+# Compile SSA form
+echo "Compiling SSA form..."
+cc -c ssa.c -o ssa.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: SSA form compilation failed!"
+    exit 1
+fi
+
+# Compile value numbering
+echo "Compiling value numbering..."
+cc -c gvn.c -o gvn.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Value numbering compilation failed!"
+    exit 1
+fi
+
+# Compile algebraic simplification
+echo "Compiling algebraic simplification..."
+cc -c simplify.c -o simplify.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Algebraic simplification compilation failed!"
+    exit 1
+fi
+
+# Compile natural loops
+echo "Compiling natural loops..."
+cc -c loop.c -o loop.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Natural loops compilation failed!"
+    exit 1
+fi
+
+# Compile loop-invariant code motion
+echo "Compiling loop-invariant code motion..."
+cc -c licm.c -o licm.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Loop-invariant code motion compilation failed!"
+    exit 1
+fi
+
+# Compile compile-time call evaluation
+echo "Compiling compile-time call evaluation..."
+cc -c consteval.c -o consteval.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Compile-time call evaluation compilation failed!"
+    exit 1
+fi
+
+# Compile function inlining
+echo "Compiling function inlining..."
+cc -c inline.c -o inline.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Function inlining compilation failed!"
+    exit 1
+fi
+
+# Compile tail call elimination
+echo "Compiling tail call elimination..."
+cc -c tailcall.c -o tailcall.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Tail call elimination compilation failed!"
+    exit 1
+fi
+
+# Compile function specialization
+echo "Compiling function specialization..."
+cc -c specialize.c -o specialize.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Function specialization compilation failed!"
+    exit 1
+fi
+
+# Compile switch lowering
+echo "Compiling switch lowering..."
+cc -c jumptable.c -o jumptable.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Switch lowering compilation failed!"
+    exit 1
+fi
+
+# Compile dead code elimination
+echo "Compiling dead code elimination..."
+cc -c dce.c -o dce.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Dead code elimination compilation failed!"
+    exit 1
+fi
+
+# Compile peephole optimizer
+echo "Compiling peephole optimizer..."
+cc -c peephole.c -o peephole.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Peephole optimizer compilation failed!"
+    exit 1
+fi
+
+# Compile optimizer
+echo "Compiling optimizer..."
+cc -c optimize.c -o optimize.o
+if [ $? -ne 0 ]; then
+    echo "ERROR: Optimizer compilation failed!"
+    exit 1
+fi
+
 # Compile code generation module
 echo "Compiling code generation..."
 cc -c codegen.c -o codegen.o
@@ -38,7 +190,7 @@ fi
 
 # Link everything together
 echo "Linking..."
-cc -o ast y.tab.c semantic_analysis.o codegen.o -ll -Ly
+cc -o ast y.tab.c arena.o intern.o semantic_analysis.o frame.o callgraph.o ir.o cfg.o ssa.o gvn.o simplify.o loop.o licm.o consteval.o inline.o tailcall.o specialize.o jumptable.o dce.o peephole.o optimize.o codegen.o -ll -Ly -lm
 if [ $? -ne 0 ]; then
     echo "ERROR: Linking failed!"
     exit 1
@@ -1,4 +1,5 @@
 #include "semantic_analysis.h"
+#include "intern.h"
 
 // Debug level flag: 0 = errors only, 1 = basic info, 2 = verbose debug
 int debug_level = 0;  // Default: show basic info, but not detailed debug
@@ -56,7 +57,7 @@ void log_error_format(const char* format, ...) {
 }
 
 // Global variable to track declared functions
-function_info* declared_functions = NULL;
+function_table declared_functions = {NULL, 0, NULL, 0, 0};
 // Global variable to track current function context for return type validation
 function_info* current_function = NULL;
 // Global counter for tracking declaration order
@@ -69,38 +70,111 @@ int current_position = 0;
 // Helper function to create a new function_info
 function_info* create_function_info(char* name, int return_type) {
     function_info* new_func = (function_info*)malloc(sizeof(function_info));
-    new_func->name = strdup(name);
+    new_func->name = intern(name);
     new_func->param_count = 0;
     new_func->param_types = NULL;
     new_func->param_names = NULL;
     new_func->has_default = NULL;
+    new_func->default_values = NULL;
     new_func->return_type = return_type;
     new_func->declaration_position = 0;
-    new_func->next = declared_functions;
+    new_func->local_names = NULL;
+    new_func->local_types = NULL;
+    new_func->local_count = 0;
+    new_func->local_capacity = 0;
     return new_func;
 }
 
-// Helper function to find a function by name in the global list
+// Find the slot holding func_name, or the empty slot where it would go
+function_info** find_function_slot(char* func_name) {
+    unsigned int mask = declared_functions.capacity - 1;
+    unsigned int index = hash_name(func_name) & mask;
+    while (declared_functions.slots[index] && declared_functions.slots[index]->name != func_name) {
+        index = (index + 1) & mask;
+    }
+    return &declared_functions.slots[index];
+}
+
+// Helper function to find a function by name (func_name must be interned)
 function_info* find_function_by_name(char* func_name) {
-    function_info* current = declared_functions;
-    while (current) {
-        if (strcmp(current->name, func_name) == 0) {
-            return current;
+    if (declared_functions.count == 0) {
+        return NULL;
+    }
+    return *find_function_slot(func_name);
+}
+
+// Double the slot array of the function table and re-insert every function
+void grow_function_table(void) {
+    int old_capacity = declared_functions.capacity;
+    function_info** old_slots = declared_functions.slots;
+    
+    declared_functions.capacity = old_capacity ? old_capacity * 2 : FUNCTION_TABLE_INITIAL_CAPACITY;
+    declared_functions.slots = (function_info**)calloc(declared_functions.capacity, sizeof(function_info*));
+    
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_slots[i]) {
+            *find_function_slot(old_slots[i]->name) = old_slots[i];
         }
-        current = current->next;
     }
-    return NULL;
+    
+    free(old_slots);
 }
 
-// Helper function to get type from string
+// Add a function to the table and to the declaration order
+void insert_function(function_info* func) {
+    // Keep the load factor below 1/2
+    if ((declared_functions.count + 1) * 2 > declared_functions.capacity) {
+        grow_function_table();
+    }
+    *find_function_slot(func->name) = func;
+    
+    if (declared_functions.count == declared_functions.order_capacity) {
+        declared_functions.order_capacity = declared_functions.order_capacity ? declared_functions.order_capacity * 2 : FUNCTION_TABLE_INITIAL_CAPACITY;
+        declared_functions.in_order = (function_info**)realloc(declared_functions.in_order, 
+                                            declared_functions.order_capacity * sizeof(function_info*));
+    }
+    declared_functions.in_order[declared_functions.count++] = func;
+}
+
+// Empty the function table
+void reset_function_table(void) {
+    free(declared_functions.slots);
+    free(declared_functions.in_order);
+    declared_functions.slots = NULL;
+    declared_functions.capacity = 0;
+    declared_functions.in_order = NULL;
+    declared_functions.count = 0;
+    declared_functions.order_capacity = 0;
+}
+
+// Helper function to get type from string (type_str must be an interned token)
 int get_type(char* type_str) {
-    if (strcmp(type_str, "int") == 0) return TYPE_INT;
-    if (strcmp(type_str, "string") == 0) return TYPE_STRING;
-    if (strcmp(type_str, "bool") == 0) return TYPE_BOOL;
-    if (strcmp(type_str, "float") == 0) return TYPE_FLOAT;
+    if (type_str == ATOM_INT) return TYPE_INT;
+    if (type_str == ATOM_STRING) return TYPE_STRING;
+    if (type_str == ATOM_BOOL) return TYPE_BOOL;
+    if (type_str == ATOM_FLOAT) return TYPE_FLOAT;
     return 0; // none
 }
 
+// Helper function to get the source spelling of a binary operator
+const char* binary_op_name(binary_op op) {
+    switch(op) {
+        case OP_ADD: return "+";
+        case OP_SUB: return "-";
+        case OP_MUL: return "*";
+        case OP_DIV: return "/";
+        case OP_MOD: return "%";
+        case OP_POW: return "**";
+        case OP_EQ: return "==";
+        case OP_NE: return "!=";
+        case OP_LT: return "<";
+        case OP_GT: return ">";
+        case OP_LE: return "<=";
+        case OP_GE: return ">=";
+        default: return "?";
+    }
+}
+
 // Helper function to get type name from type integer
 char* get_type_name(int type) {
     switch(type) {
@@ -116,18 +190,62 @@ char* get_type_name(int type) {
 scope* mkscope(scope* parent) {
     scope* new_scope = (scope*)malloc(sizeof(scope));
     new_scope->variables = NULL;
+    new_scope->capacity = 0;
+    new_scope->count = 0;
     new_scope->parent = parent;
     new_scope->scope_name = NULL;
     return new_scope;
 }
 
+// Hash an interned name by its address
+unsigned int hash_name(char* name) {
+    return (unsigned int)(((size_t)name >> 3) * 2654435761u);
+}
+
+// Find the slot holding name, or the empty slot where it would go
+var** find_scope_slot(scope* curr_scope, char* name) {
+    unsigned int mask = curr_scope->capacity - 1;
+    unsigned int index = hash_name(name) & mask;
+    while (curr_scope->variables[index] && curr_scope->variables[index]->name != name) {
+        index = (index + 1) & mask;
+    }
+    return &curr_scope->variables[index];
+}
+
+// Double the slot array of a scope and re-insert every variable
+void grow_scope(scope* curr_scope) {
+    int old_capacity = curr_scope->capacity;
+    var** old_slots = curr_scope->variables;
+    
+    curr_scope->capacity = old_capacity ? old_capacity * 2 : SCOPE_INITIAL_CAPACITY;
+    curr_scope->variables = (var**)calloc(curr_scope->capacity, sizeof(var*));
+    
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_slots[i]) {
+            *find_scope_slot(curr_scope, old_slots[i]->name) = old_slots[i];
+        }
+    }
+    
+    free(old_slots);
+}
+
 // Add a variable to the current scope
 void add_variable(scope* curr_scope, char* name, int type) {
     var* new_var = (var*)malloc(sizeof(var));
-    new_var->name = strdup(name);
+    new_var->name = intern(name);
     new_var->type = type;
-    new_var->next = curr_scope->variables;
-    curr_scope->variables = new_var;
+    
+    // Keep the load factor below 1/2
+    if ((curr_scope->count + 1) * 2 > curr_scope->capacity) {
+        grow_scope(curr_scope);
+    }
+    
+    // A later declaration of the same name in this scope replaces the earlier one
+    var** slot = find_scope_slot(curr_scope, new_var->name);
+    if (!*slot) {
+        curr_scope->count++;
+    }
+    *slot = new_var;
     
     log_debug_format("Added variable '%s' of type '%s' to scope %s", 
                    name, get_type_name(type), 
@@ -137,19 +255,15 @@ void add_variable(scope* curr_scope, char* name, int type) {
 // Helper function to add a function declaration
 function_info* add_function_declaration(char* func_name, int return_type) {
     // Check if function already exists
-    function_info* current = declared_functions;
-    while (current) {
-        if (strcmp(current->name, func_name) == 0) {
-            log_error_format("Function '%s' already declared", func_name);
-            return NULL;
-        }
-        current = current->next;
+    if (find_function_by_name(func_name)) {
+        log_error_format("Function '%s' already declared", func_name);
+        return NULL;
     }
     
     // Create new function info
     function_info* new_func = create_function_info(func_name, return_type);
     new_func->declaration_position = declaration_counter++;
-    declared_functions = new_func;
+    insert_function(new_func);
     
     if (return_type != 0) {
         log_info_format("Function '%s' declared successfully (return type: %s)", 
@@ -162,18 +276,33 @@ function_info* add_function_declaration(char* func_name, int return_type) {
 }
 
 // Helper function to add a parameter to a function_info
-void add_parameter_to_function(function_info* func, char* param_name, int param_type, int has_default_value) {
+void add_parameter_to_function(function_info* func, char* param_name, int param_type, node* default_value) {
     func->param_count++;
     
     func->param_types = (int*)realloc(func->param_types, func->param_count * sizeof(int));
     func->param_names = (char**)realloc(func->param_names, func->param_count * sizeof(char*));
     func->has_default = (int*)realloc(func->has_default, func->param_count * sizeof(int));
+    func->default_values = (node**)realloc(func->default_values, func->param_count * sizeof(node*));
     
     // Add the new parameter (at the end)
     int index = func->param_count - 1;
     func->param_types[index] = param_type;
-    func->param_names[index] = strdup(param_name);
-    func->has_default[index] = has_default_value;
+    func->param_names[index] = intern(param_name);
+    func->has_default[index] = default_value != NULL;
+    func->default_values[index] = default_value;
+}
+
+// Record a variable declared in a function body; code generation sizes
+// the frame from this list
+void add_local_to_function(function_info* func, char* local_name, int local_type) {
+    if (func->local_count == func->local_capacity) {
+        func->local_capacity = func->local_capacity ? func->local_capacity * 2 : 8;
+        func->local_names = (char**)realloc(func->local_names, func->local_capacity * sizeof(char*));
+        func->local_types = (int*)realloc(func->local_types, func->local_capacity * sizeof(int));
+    }
+    func->local_names[func->local_count] = local_name;
+    func->local_types[func->local_count] = local_type;
+    func->local_count++;
 }
 
 // Count the number of arguments in a function call
@@ -181,7 +310,7 @@ int count_function_arguments(node* args_node) {
     if (!args_node) return 0;
     
     // If this is a direct argument (not a comma-separated list)
-    if (args_node->token && strcmp(args_node->token, "") != 0) {
+    if (args_node->kind != NODE_SEQ) {
         return 1;  // This is a single argument
     }
     
@@ -194,7 +323,7 @@ int count_function_arguments(node* args_node) {
     
     curr = curr->right;
     while (curr) {
-        if (curr->token && strcmp(curr->token, "") != 0) {
+        if (curr->kind != NODE_SEQ) {
             count++;
             break;
         } else if (curr->left) {
@@ -245,7 +374,7 @@ int count_list_items(node* list) {
     if (!list) return 0;
     
     // If this is a leaf node (has token), it's one item
-    if (list->token && strlen(list->token) > 0) {
+    if (list->kind != NODE_SEQ) {
         return 1;
     }
     
@@ -262,7 +391,7 @@ void extract_from_list(node* list, node** array, int* index) {
     if (!list || !array) return;
     
     // If this is a leaf node (has token), add it
-    if (list->token && strlen(list->token) > 0) {
+    if (list->kind != NODE_SEQ) {
         array[(*index)++] = list;
         return;
     }
@@ -326,7 +455,7 @@ node** extract_function_arguments(node* args_node, int* arg_count) {
     int index = 0;
     
     // If this is a direct argument (not a comma-separated list)
-    if (args_node->token && strcmp(args_node->token, "") != 0) {
+    if (args_node->kind != NODE_SEQ) {
         arg_nodes[0] = args_node;
         return arg_nodes;
     }
@@ -341,7 +470,7 @@ node** extract_function_arguments(node* args_node, int* arg_count) {
     
     curr = curr->right;
     while (curr && index < *arg_count) {
-        if (curr->token && strcmp(curr->token, "") != 0) {
+        if (curr->kind != NODE_SEQ) {
             arg_nodes[index++] = curr;
             break;
         } else if (curr->left) {
@@ -360,7 +489,7 @@ void validate_main_function(node* func_node, scope* func_scope) {
     }
     
     // Check if this is the __main__ function
-    if (strcmp(func_node->left->token, "__main__") != 0) {
+    if (func_node->left->token != ATOM_MAIN) {
         return;
     }
     
@@ -381,12 +510,12 @@ void validate_main_function(node* func_node, scope* func_scope) {
         if (!current) continue;
         
         if (current->token) {
-            if (strcmp(current->token, "params") == 0) {
+            if (current->kind == NODE_PARAMS) {
                 if (current->left || current->right) {
                     has_params = 1;
                 }
             }
-            else if (strcmp(current->token, "return_type") == 0) {
+            else if (current->kind == NODE_RETURN_TYPE) {
                 has_return_type = 1;
             }
         }
@@ -414,15 +543,12 @@ void validate_main_function(node* func_node, scope* func_scope) {
 }
 
 // Check if variable exists in current scope (for redeclaration check)
+// Variable names are interned, so names are compared by pointer
 var* find_variable_in_scope(scope* curr_scope, char* name) {
-    var* current = curr_scope->variables;
-    while (current) {
-        if (strcmp(current->name, name) == 0) {
-            return current;
-        }
-        current = current->next;
+    if (curr_scope->count == 0) {
+        return NULL;
     }
-    return NULL;
+    return *find_scope_slot(curr_scope, name);
 }
 
 // Uncomment log_debug_format lines to enable a more deep debug logging
@@ -431,16 +557,14 @@ var* find_variable_in_scope_hierarchy(scope* curr_scope, char* name) {
     // log_debug_format("Looking for variable '%s' in scope hierarchy", name);
     scope* temp_scope = curr_scope;
     
+    // The innermost declaration wins, which gives shadowing
     while (temp_scope != NULL) {
         // log_debug_format("Checking scope: %s", temp_scope->scope_name ? temp_scope->scope_name : "unnamed");
-        var* temp_var = temp_scope->variables;
-        while (temp_var != NULL) {
-            if (strcmp(temp_var->name, name) == 0) {
-                // log_debug_format("Found variable '%s' in scope %s", name, 
-                                // temp_scope->scope_name ? temp_scope->scope_name : "unnamed");
-                return temp_var;
-            }
-            temp_var = temp_var->next;
+        var* temp_var = find_variable_in_scope(temp_scope, name);
+        if (temp_var) {
+            // log_debug_format("Found variable '%s' in scope %s", name, 
+                            // temp_scope->scope_name ? temp_scope->scope_name : "unnamed");
+            return temp_var;
         }
         // log_debug_format("Variable '%s' not found in scope %s, checking parent", name, 
                         // temp_scope->scope_name ? temp_scope->scope_name : "unnamed");
@@ -471,273 +595,265 @@ void handle_variable_usage(node* var_node, scope* curr_scope) {
     log_debug_format("Variable '%s' used (type: %s)", var_name, get_type_name(found_var->type));
 }
 
-// Function to detect string literals
-int looks_like_string_literal(char* token) {
-    if (!token) return 0;
+// Get the type of an arithmetic operation (+, -, *, /, %, **)
+int get_arithmetic_type(node* expr_node, scope* curr_scope) {
+    log_debug("Detected arithmetic operator");
     
-    // Check if token starts and ends with quotes (double or single)
-    int len = strlen(token);
-    if (len >= 2) {
-        if ((token[0] == '"' && token[len-1] == '"') ||
-            (token[0] == '\'' && token[len-1] == '\'')) {
-            return 1;
-        }
-    }
+    // Get types of operands
+    int left_type = get_expression_type(expr_node->left, curr_scope);
+    int right_type = get_expression_type(expr_node->right, curr_scope);
     
-    // Check for common string literal patterns
-    // If it contains spaces, it's likely a string literal
-    if (strchr(token, ' ') != NULL) return 1;
+    // Special case for string concatenation (only for + operator)
+    if (expr_node->op == OP_ADD && 
+        (left_type == TYPE_STRING || right_type == TYPE_STRING)) {
+        return TYPE_STRING;  // Result of string concatenation is a string
+    }
     
-    // If it contains quotes (escaped), it's a string literal
-    if (strstr(token, "\\\"") != NULL || strstr(token, "\\'") != NULL) return 1;
+    // Skip type checking if either operand has unknown type (likely undeclared variable)
+    if (left_type == 0 || right_type == 0) {
+        return 0; // Don't report additional type errors
+    }
     
-    // If it contains common escape sequences
-    if (strstr(token, "\\n") != NULL || strstr(token, "\\t") != NULL || 
-        strstr(token, "\\\\") != NULL) return 1;
+    // Type checking for arithmetic operators (only if both types are known)
+    if (left_type != TYPE_INT && left_type != TYPE_FLOAT) {
+        log_error_format("Left operand of '%s' must be numeric (int or float), got '%s'", 
+                    expr_node->token, get_type_name(left_type));
+        return 0; 
+    }
     
-    // If it contains special characters that are common in strings
-    if (strchr(token, ':') != NULL || strchr(token, '@') != NULL || 
-        strchr(token, '#') != NULL || strchr(token, '$') != NULL ||
-        strchr(token, '%') != NULL || strchr(token, '^') != NULL ||
-        strchr(token, '&') != NULL || strchr(token, '*') != NULL ||
-        strchr(token, '(') != NULL || strchr(token, ')') != NULL) return 1;
+    // Right operand must also be numeric
+    if (right_type != TYPE_INT && right_type != TYPE_FLOAT) {
+        log_error_format("Right operand of '%s' must be numeric (int or float), got '%s'", 
+                    expr_node->token, get_type_name(right_type));
+        return 0; 
+    }
     
-    return 0;
+    // Result is int if both operands are int, otherwise float
+    if (left_type == TYPE_INT && right_type == TYPE_INT) {
+        return TYPE_INT;
+    } else {
+        return TYPE_FLOAT;
+    }
 }
 
-// Get the type of an expression node
-int get_expression_type(node* expr_node, scope* curr_scope) {
-    if (!expr_node || !expr_node->token) {
-        return 0; // Unknown type
-    }
+// Get the type of an ordering comparison (<, >, <=, >=)
+int get_comparison_type(node* expr_node, scope* curr_scope) {
+    log_debug("Detected comparison operator");
     
-    log_debug_format("get_expression_type: analyzing token='%s'", expr_node->token);
+    int left_type = get_expression_type(expr_node->left, curr_scope);
+    int right_type = get_expression_type(expr_node->right, curr_scope);
     
-    // Handle arithmetic operators
-    if (strcmp(expr_node->token, "+") == 0 || 
-        strcmp(expr_node->token, "-") == 0 ||
-        strcmp(expr_node->token, "*") == 0 || 
-        strcmp(expr_node->token, "/") == 0 ||
-        strcmp(expr_node->token, "%") == 0 ||
-        strcmp(expr_node->token, "**") == 0) {
-        
-        log_debug("Detected arithmetic operator");
-        
-        // Get types of operands
-        int left_type = get_expression_type(expr_node->left, curr_scope);
-        int right_type = get_expression_type(expr_node->right, curr_scope);
-        
-        // Special case for string concatenation (only for + operator)
-        if (strcmp(expr_node->token, "+") == 0 && 
-            (left_type == TYPE_STRING || right_type == TYPE_STRING)) {
-            return TYPE_STRING;  // Result of string concatenation is a string
-        }
-        
-        // Skip type checking if either operand has unknown type (likely undeclared variable)
-        if (left_type == 0 || right_type == 0) {
-            return 0; // Don't report additional type errors
-        }
-        
-        // Type checking for arithmetic operators (only if both types are known)
-        if (left_type != TYPE_INT && left_type != TYPE_FLOAT) {
-            log_error_format("Left operand of '%s' must be numeric (int or float), got '%s'", 
-                        expr_node->token, get_type_name(left_type));
-            return 0; 
-        }
-        
-        // Right operand must also be numeric
-        if (right_type != TYPE_INT && right_type != TYPE_FLOAT) {
-            log_error_format("Right operand of '%s' must be numeric (int or float), got '%s'", 
-                        expr_node->token, get_type_name(right_type));
-            return 0; 
-        }
-        
-        // Result is int if both operands are int, otherwise float
-        if (left_type == TYPE_INT && right_type == TYPE_INT) {
-            return TYPE_INT;
-        } else {
-            return TYPE_FLOAT;
-        }
+    // Skip type checking if either operand has unknown type
+    if (left_type == 0 || right_type == 0) {
+        return TYPE_BOOL; // Still return bool for the comparison, but don't report type errors
     }
     
-    // Handle logical operators: and, or
-    if (strcmp(expr_node->token, "and") == 0 || strcmp(expr_node->token, "or") == 0) {
-        log_debug("Detected logical operator");
-        
-        int left_type = get_expression_type(expr_node->left, curr_scope);
-        int right_type = get_expression_type(expr_node->right, curr_scope);
-        
-        // Both operands must be boolean
-        if (left_type != TYPE_BOOL) {
-            log_error_format("Left operand of '%s' must be boolean, got '%s'", 
-                           expr_node->token, get_type_name(left_type));
-            return 0; 
-        }
-        
-        if (right_type != TYPE_BOOL) {
-            log_error_format("Right operand of '%s' must be boolean, got '%s'", 
-                           expr_node->token, get_type_name(right_type));
-            return 0; 
-        }
-        
-        return TYPE_BOOL; // Result is boolean
+    // Both operands must be numeric (int or float)
+    if (left_type != TYPE_INT && left_type != TYPE_FLOAT) {
+        log_error_format("Left operand of '%s' must be numeric (int or float), got '%s'", 
+                    expr_node->token, get_type_name(left_type));
+        return 0; 
     }
     
-    // Handle not operator
-    if (strcmp(expr_node->token, "not") == 0) {
-        log_debug("Detected 'not' operator");
-        
-        int operand_type = get_expression_type(expr_node->right, curr_scope);
-        
-        // Operand must be boolean
-        if (operand_type != TYPE_BOOL) {
-            log_error_format("Operand of 'not' must be boolean, got '%s'", 
-                           get_type_name(operand_type));
-            return 0; 
-        }
-        
-        return TYPE_BOOL; // Result is boolean
+    if (right_type != TYPE_INT && right_type != TYPE_FLOAT) {
+        log_error_format("Right operand of '%s' must be numeric (int or float), got '%s'", 
+                    expr_node->token, get_type_name(right_type));
+        return 0; 
     }
     
-    // Handle comparison operators: <, >, <=, >=
-    if (strcmp(expr_node->token, "<") == 0 || 
-        strcmp(expr_node->token, ">") == 0 ||
-        strcmp(expr_node->token, "<=") == 0 || 
-        strcmp(expr_node->token, ">=") == 0) {
-        
-        log_debug("Detected comparison operator");
-        
-        int left_type = get_expression_type(expr_node->left, curr_scope);
-        int right_type = get_expression_type(expr_node->right, curr_scope);
-        
-        // Skip type checking if either operand has unknown type
-        if (left_type == 0 || right_type == 0) {
-            return TYPE_BOOL; // Still return bool for the comparison, but don't report type errors
-        }
-        
-        // Both operands must be numeric (int or float)
-        if (left_type != TYPE_INT && left_type != TYPE_FLOAT) {
-            log_error_format("Left operand of '%s' must be numeric (int or float), got '%s'", 
-                        expr_node->token, get_type_name(left_type));
-            return 0; 
-        }
-        
-        if (right_type != TYPE_INT && right_type != TYPE_FLOAT) {
-            log_error_format("Right operand of '%s' must be numeric (int or float), got '%s'", 
-                        expr_node->token, get_type_name(right_type));
-            return 0; 
-        }
-        
-        return TYPE_BOOL; // Result is always boolean
-    }
+    return TYPE_BOOL; // Result is always boolean
+}
+
+// Get the type of an equality comparison (==, !=)
+int get_equality_type(node* expr_node, scope* curr_scope) {
+    log_debug("Detected equality operator");
     
-    // Handle equality operators: ==, !=
-    if (strcmp(expr_node->token, "==") == 0 || strcmp(expr_node->token, "!=") == 0) {
-        log_debug("Detected equality operator");
-        
-        int left_type = get_expression_type(expr_node->left, curr_scope);
-        int right_type = get_expression_type(expr_node->right, curr_scope);
-        
-        // Both operands must be of the same type
-        if (left_type != right_type) {
-            log_error_format("Operands of '%s' must be of the same type, got '%s' and '%s'", 
-                           expr_node->token, get_type_name(left_type), get_type_name(right_type));
-            return 0; 
-        }
-        
-        return TYPE_BOOL; // Result is always boolean
-    }
+    int left_type = get_expression_type(expr_node->left, curr_scope);
+    int right_type = get_expression_type(expr_node->right, curr_scope);
     
-    // Handle string indexing
-    if (strcmp(expr_node->token, "index") == 0) {
-        log_debug("Detected string indexing operation");
-        return check_index_operation(expr_node, curr_scope);
+    // Both operands must be of the same type
+    if (left_type != right_type) {
+        log_error_format("Operands of '%s' must be of the same type, got '%s' and '%s'", 
+                       expr_node->token, get_type_name(left_type), get_type_name(right_type));
+        return 0; 
     }
+    
+    return TYPE_BOOL; // Result is always boolean
+}
 
-    // Handle string slicing
-    if (strcmp(expr_node->token, "slice") == 0) {
-        log_debug("Detected string slicing operation");
-        return check_slice_operation(expr_node, curr_scope);
+// Get the type of a logical operation (and, or)
+int get_logical_type(node* expr_node, scope* curr_scope) {
+    log_debug("Detected logical operator");
+    
+    int left_type = get_expression_type(expr_node->left, curr_scope);
+    int right_type = get_expression_type(expr_node->right, curr_scope);
+    
+    // Both operands must be boolean
+    if (left_type != TYPE_BOOL) {
+        log_error_format("Left operand of '%s' must be boolean, got '%s'", 
+                       expr_node->token, get_type_name(left_type));
+        return 0; 
+    }
+    
+    if (right_type != TYPE_BOOL) {
+        log_error_format("Right operand of '%s' must be boolean, got '%s'", 
+                       expr_node->token, get_type_name(right_type));
+        return 0; 
     }
+    
+    return TYPE_BOOL; // Result is boolean
+}
 
-    // Handle string slicing with step
-    if (strcmp(expr_node->token, "slice_step") == 0) {
-        log_debug("Detected string slicing with step operation");
-        return check_slice_operation(expr_node, curr_scope);
+// Get the return type of a function call expression
+int get_call_type(node* expr_node) {
+    if (!expr_node->left || !expr_node->left->token) {
+        log_debug("Invalid function call in expression");
+        return 0;
     }
     
-    // Check if it's a variable - look up its declared type
-    var* found_var = find_variable_in_scope_hierarchy(curr_scope, expr_node->token);
-    if (found_var) {
-        log_debug_format("Found variable '%s' with type %d", expr_node->token, found_var->type);
-        return found_var->type;
+    char* func_name = expr_node->left->token;
+    log_debug_format("Getting return type for function call: %s", func_name);
+    
+    // Find the function in our declared functions list
+    function_info* func_info = find_function_by_name(func_name);
+    if (!func_info) {
+        log_error_format("Function '%s' called before declaration", func_name); 
+        log_debug_format("Function '%s' not found, can't determine return type", func_name);
+        return 0;
     }
     
-    // Check if it's a number literal
-    if (expr_node->token[0] >= '0' && expr_node->token[0] <= '9') {
-        if (strchr(expr_node->token, '.') != NULL) {
-            log_debug("Detected float literal");
-            return TYPE_FLOAT;
-        } else {
-            log_debug("Detected int literal");
-            return TYPE_INT;
-        }
+    // Check if function was declared before current position
+    if (func_info->declaration_position >= current_position) {
+        log_error_format("Function '%s' called before declaration", func_name);
+        return 0;
     }
     
-    // Check if it's a boolean literal
-    if (strcmp(expr_node->token, "True") == 0 || strcmp(expr_node->token, "False") == 0 ||
-        strcmp(expr_node->token, "true") == 0 || strcmp(expr_node->token, "false") == 0) {
-        log_debug("Detected boolean literal");
-        return TYPE_BOOL;
+    // Return the function's return type
+    log_debug_format("Function '%s' has return type: %s", 
+                func_name, get_type_name(func_info->return_type));
+    return func_info->return_type;
+}
+
+// Get the type of an expression node, computing it only the first time
+int get_expression_type(node* expr_node, scope* curr_scope) {
+    if (!expr_node || !expr_node->token) {
+        return 0; // Unknown type
     }
     
-    // Check if it looks like a string literal
-    if (looks_like_string_literal(expr_node->token)) {
-        log_debug("Detected string literal by pattern");
-        return TYPE_STRING;
+    if (!expr_node->typed) {
+        expr_node->type = compute_expression_type(expr_node, curr_scope);
+        expr_node->typed = 1;
+    }
+    return expr_node->type;
+}
+
+// Read the type cached on a node; 0 if it was never typed
+int get_node_type(node* expr_node) {
+    if (!expr_node || !expr_node->typed) {
+        return 0;
     }
+    return expr_node->type;
+}
+
+// Infer the type of an expression node
+int compute_expression_type(node* expr_node, scope* curr_scope) {
+    log_debug_format("get_expression_type: analyzing token='%s'", expr_node->token);
     
-    // Check if it's a function call
-    if (strcmp(expr_node->token, "call") == 0) {
-        if (!expr_node->left || !expr_node->left->token) {
-            log_debug("Invalid function call in expression");
-            return 0;
-        }
+    switch (expr_node->kind) {
+        case NODE_BINARY:
+            switch (expr_node->op) {
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_DIV:
+                case OP_MOD:
+                case OP_POW:
+                    return get_arithmetic_type(expr_node, curr_scope);
+                case OP_LT:
+                case OP_GT:
+                case OP_LE:
+                case OP_GE:
+                    return get_comparison_type(expr_node, curr_scope);
+                case OP_EQ:
+                case OP_NE:
+                    return get_equality_type(expr_node, curr_scope);
+                default:
+                    return 0;
+            }
         
-        char* func_name = expr_node->left->token;
-        log_debug_format("Getting return type for function call: %s", func_name);
+        case NODE_AND:
+        case NODE_OR:
+            return get_logical_type(expr_node, curr_scope);
         
-        // Find the function in our declared functions list
-        function_info* func_info = find_function_by_name(func_name);
-        if (!func_info) {
-            log_error_format("Function '%s' called before declaration", func_name); 
-            log_debug_format("Function '%s' not found, can't determine return type", func_name);
-            return 0;
+        case NODE_NOT: {
+            log_debug("Detected 'not' operator");
+            
+            int operand_type = get_expression_type(expr_node->right, curr_scope);
+            
+            // Operand must be boolean
+            if (operand_type != TYPE_BOOL) {
+                log_error_format("Operand of 'not' must be boolean, got '%s'", 
+                               get_type_name(operand_type));
+                return 0; 
+            }
+            
+            return TYPE_BOOL; // Result is boolean
         }
         
-        // Check if function was declared before current position
-        if (func_info->declaration_position >= current_position) {
-            log_error_format("Function '%s' called before declaration", func_name);
-            return 0;
+        case NODE_INDEX:
+            log_debug("Detected string indexing operation");
+            return check_index_operation(expr_node, curr_scope);
+        
+        case NODE_SLICE:
+            log_debug("Detected string slicing operation");
+            return check_slice_operation(expr_node, curr_scope);
+        
+        case NODE_SLICE_STEP:
+            log_debug("Detected string slicing with step operation");
+            return check_slice_operation(expr_node, curr_scope);
+        
+        case NODE_CALL:
+            return get_call_type(expr_node);
+        
+        case NODE_NUMBER:
+            if (strchr(expr_node->token, '.') != NULL) {
+                log_debug("Detected float literal");
+                return TYPE_FLOAT;
+            }
+            log_debug("Detected int literal");
+            return TYPE_INT;
+        
+        case NODE_BOOL:
+            log_debug("Detected boolean literal");
+            return TYPE_BOOL;
+        
+        case NODE_STRING:
+            log_debug("Detected string literal");
+            return TYPE_STRING;
+        
+        case NODE_IDENT: {
+            // Look up the variable's declared type
+            var* found_var = find_variable_in_scope_hierarchy(curr_scope, expr_node->token);
+            if (found_var) {
+                log_debug_format("Found variable '%s' with type %d", expr_node->token, found_var->type);
+                return found_var->type;
+            }
+            
+            // Capitalized boolean literals are accepted as well
+            if (expr_node->token == ATOM_TRUE_CAP || expr_node->token == ATOM_FALSE_CAP) {
+                log_debug("Detected boolean literal");
+                return TYPE_BOOL;
+            }
+            
+            // This looks like an identifier that wasn't found
+            log_error_format("Variable '%s' used before declaration", expr_node->token);
+            return 0; // Still return 0, but we've reported the real error
         }
         
-        // Return the function's return type
-        log_debug_format("Function '%s' has return type: %s", 
-                    func_name, get_type_name(func_info->return_type));
-        return func_info->return_type;
-    }         
-    
-    // If we reach here, it's likely an undeclared variable or unknown operator
-    if (expr_node->token[0] >= 'a' && expr_node->token[0] <= 'z' || 
-        expr_node->token[0] >= 'A' && expr_node->token[0] <= 'Z' || 
-        expr_node->token[0] == '_') {
-        // This looks like an identifier that wasn't found
-        log_error_format("Variable '%s' used before declaration", expr_node->token);
-        return 0; // Still return 0, but we've reported the real error
+        default:
+            log_debug("Unknown expression node - returning unknown type");
+            return 0; // Return 0 to indicate we can't determine the type
     }
-
-    log_debug("Undeclared identifier - returning unknown type");
-    return 0; // Return 0 to indicate we can't determine the type
 }
 
 // Helper function to validate that an expression is of boolean type
@@ -768,7 +884,7 @@ void validate_condition_type(node* condition_node, scope* curr_scope, const char
 
 // Handle string indexing operations
 int check_index_operation(node* node, scope* current_scope) {
-    if (!node || strcmp(node->token, "index") != 0) {
+    if (!node || node->kind != NODE_INDEX) {
         log_error("Internal error: check_index_operation called on non-index node");
         return 0;
     }
@@ -841,7 +957,7 @@ int check_index_operation(node* node, scope* current_scope) {
 
 // Handle string slicing operations
 int check_slice_operation(node* node, scope* current_scope) {
-    if (!node || (strcmp(node->token, "slice") != 0 && strcmp(node->token, "slice_step") != 0)) {
+    if (!node || (node->kind != NODE_SLICE && node->kind != NODE_SLICE_STEP)) {
         log_error("Internal error: check_slice_operation called on non-slice node");
         return 0;
     }
@@ -882,9 +998,9 @@ int check_slice_operation(node* node, scope* current_scope) {
     
     // For regular slicing (slice), we have a node structure like:
     // node -> right -> (left, right) for start and end indices
-    if (strcmp(node->token, "slice") == 0) {
+    if (node->kind == NODE_SLICE) {
         // Check start index type (could be NULL for default)
-        if (node->right->left && strcmp(node->right->left->token, "0") != 0) {
+        if (node->right->left && node->right->left->token != ATOM_ZERO) {
             int start_type = get_expression_type(node->right->left, current_scope);
             if (start_type != TYPE_INT) {
                 log_error_format("String slice start index must be of integer type, got '%s'", 
@@ -894,7 +1010,7 @@ int check_slice_operation(node* node, scope* current_scope) {
         }
         
         // Check end index type (could be NULL for default)
-        if (node->right->right && strcmp(node->right->right->token, "-1") != 0) {
+        if (node->right->right && node->right->right->token != ATOM_MINUS_ONE) {
             int end_type = get_expression_type(node->right->right, current_scope);
             if (end_type != TYPE_INT) {
                 log_error_format("String slice end index must be of integer type, got '%s'", 
@@ -905,11 +1021,11 @@ int check_slice_operation(node* node, scope* current_scope) {
     }
     // For slice with step (slice_step), we have a more complex structure:
     // node -> right -> (left, right) where left is another node with (left, right) for start and end
-    else if (strcmp(node->token, "slice_step") == 0) {
+    else if (node->kind == NODE_SLICE_STEP) {
         // Check if we have a valid start/end node
         if (node->right->left) {
             // Check start index
-            if (node->right->left->left && strcmp(node->right->left->left->token, "0") != 0) {
+            if (node->right->left->left && node->right->left->left->token != ATOM_ZERO) {
                 int start_type = get_expression_type(node->right->left->left, current_scope);
                 if (start_type != TYPE_INT) {
                     log_error_format("String slice start index must be of integer type, got '%s'", 
@@ -919,7 +1035,7 @@ int check_slice_operation(node* node, scope* current_scope) {
             }
             
             // Check end index
-            if (node->right->left->right && strcmp(node->right->left->right->token, "-1") != 0) {
+            if (node->right->left->right && node->right->left->right->token != ATOM_MINUS_ONE) {
                 int end_type = get_expression_type(node->right->left->right, current_scope);
                 if (end_type != TYPE_INT) {
                     log_error_format("String slice end index must be of integer type, got '%s'", 
@@ -1085,11 +1201,9 @@ void handle_parameter(node* param_node, scope* func_scope) {
     char* param_name = NULL;
     
     if (param_node->left) {
-        if (param_node->left->token && strlen(param_node->left->token) > 0) {
-            if (get_type(param_node->left->token) == 0) {
-                param_name = param_node->left->token;
-            }
-        } else if (!param_node->left->token || strlen(param_node->left->token) == 0) {
+        if (param_node->left->kind != NODE_SEQ) {
+            param_name = param_node->left->token;
+        } else {
             if (param_node->left->left && param_node->left->left->token) {
                 param_name = param_node->left->left->token;
             }
@@ -1147,7 +1261,7 @@ void process_variable_list(node* var_list, int type, scope* curr_scope) {
     if (!var_list) return;
     
     // Handle init_var nodes (variables with initialization)
-    if (var_list->token && strcmp(var_list->token, "init_var") == 0) {
+    if (var_list->kind == NODE_INIT_VAR) {
         if (!var_list->left || !var_list->left->token) {
             log_error("Invalid init_var node structure");
             return;
@@ -1163,6 +1277,9 @@ void process_variable_list(node* var_list, int type, scope* curr_scope) {
         
         // Add variable to scope
         add_variable(curr_scope, var_name, type);
+        if (current_function) {
+            add_local_to_function(current_function, var_name, type);
+        }
         log_debug_format("Added variable '%s' of type '%s' to scope (with initialization)", 
                        var_name, get_type_name(type));
         
@@ -1181,13 +1298,16 @@ void process_variable_list(node* var_list, int type, scope* curr_scope) {
     }
     
     // Handle regular variable names (single variable)
-    if (var_list->token && strlen(var_list->token) > 0) {
+    if (var_list->kind != NODE_SEQ) {
         // Check for redeclaration in scope hierarchy 
         if (find_variable_in_scope_hierarchy(curr_scope, var_list->token)) {
             log_error_format("Variable '%s' already declared", var_list->token);
             return;
         }
         add_variable(curr_scope, var_list->token, type);
+        if (current_function) {
+            add_local_to_function(current_function, var_list->token, type);
+        }
         log_debug_format("Added variable '%s' of type '%s' to scope", 
                        var_list->token, get_type_name(type));
         return;
@@ -1220,7 +1340,7 @@ void handle_while_statement(node* while_node, scope* curr_scope) {
 void process_params(node* node, scope* func_scope) {
     if (!node) return;
     
-    if (node->token && get_type(node->token) != 0) {
+    if (node->kind == NODE_PARAM) {
         handle_parameter(node, func_scope);
     }
     
@@ -1234,86 +1354,30 @@ int is_variable_usage(node* var_node, node* parent_node) {
         return 0;
     }
     
-    if (strlen(var_node->token) == 0) {
-        return 0;
-    }
-    
-    if (looks_like_string_literal(var_node->token)) {
-        return 0;
-    }
-    
-    if (get_type(var_node->token) != 0) {
-        return 0;
-    }
-    
-    // Skip keywords/operators
-    if (strcmp(var_node->token, "assign") == 0 ||
-        strcmp(var_node->token, "declare") == 0 ||
-        strcmp(var_node->token, "init") == 0 ||
-        strcmp(var_node->token, "function") == 0 ||
-        strcmp(var_node->token, "params") == 0 ||
-        strcmp(var_node->token, "return_type") == 0 ||
-        strcmp(var_node->token, "call") == 0 ||
-        strcmp(var_node->token, "if") == 0 ||
-        strcmp(var_node->token, "if-else") == 0 ||  
-        strcmp(var_node->token, "if-elif") == 0 ||  
-        strcmp(var_node->token, "if-elif-else") == 0 || 
-        strcmp(var_node->token, "elif") == 0 ||
-        strcmp(var_node->token, "while") == 0 ||
-        strcmp(var_node->token, "pass") == 0 ||
-        strcmp(var_node->token, "index") == 0 ||
-        strcmp(var_node->token, "slice") == 0 ||    
-        strcmp(var_node->token, "slice_step") == 0 ||
-        strcmp(var_node->token, "return") == 0) {
-        return 0;
-    }
-
-    if (strcmp(var_node->token, "init_var") == 0) {
+    // Only identifiers can name variables
+    if (var_node->kind != NODE_IDENT) {
         return 0;
     }
     
-    if (strcmp(var_node->token, "+") == 0 ||
-        strcmp(var_node->token, "-") == 0 ||
-        strcmp(var_node->token, "*") == 0 ||
-        strcmp(var_node->token, "/") == 0 ||
-        strcmp(var_node->token, "%") == 0 ||
-        strcmp(var_node->token, "**") == 0 ||
-        strcmp(var_node->token, "==") == 0 ||
-        strcmp(var_node->token, "!=") == 0 ||
-        strcmp(var_node->token, "<") == 0 ||
-        strcmp(var_node->token, ">") == 0 ||
-        strcmp(var_node->token, "<=") == 0 ||
-        strcmp(var_node->token, ">=") == 0 ||
-        strcmp(var_node->token, "and") == 0 ||
-        strcmp(var_node->token, "or") == 0 ||
-        strcmp(var_node->token, "not") == 0) {
-        return 0;
-    }
-    
-    if (var_node->token[0] >= '0' && var_node->token[0] <= '9') {
-        return 0;
-    }
-    
-    if (strcmp(var_node->token, "True") == 0 ||
-        strcmp(var_node->token, "False") == 0 ||
-        strcmp(var_node->token, "true") == 0 ||
-        strcmp(var_node->token, "false") == 0) {
+    if (var_node->token == ATOM_TRUE_CAP ||
+        var_node->token == ATOM_FALSE_CAP) {
         return 0;
     }
     
     // Check all the skip conditions
-    if (parent_node && parent_node->token) {
-        if (strcmp(parent_node->token, "function") == 0) {
-            return 0;
-        }
-        if (strcmp(parent_node->token, "declare") == 0) {
-            return 0;
-        }
-        if (strcmp(parent_node->token, "assign") == 0 && parent_node->left == var_node) {
-            return 0;
-        }
-        if (strcmp(parent_node->token, "call") == 0 && parent_node->left == var_node) {
-            return 0;
+    if (parent_node) {
+        switch (parent_node->kind) {
+            case NODE_FUNCTION:
+            case NODE_DECLARE:
+                return 0;
+            case NODE_ASSIGN:
+            case NODE_CALL:
+                if (parent_node->left == var_node) {
+                    return 0;
+                }
+                break;
+            default:
+                break;
         }
     }
     return 1;
@@ -1492,7 +1556,7 @@ int extract_return_type(node* func_node) {
         node* check_node = nodes_to_check[front++];
         if (!check_node) continue;
         
-        if (check_node->token && strcmp(check_node->token, "return_type") == 0) {
+        if (check_node->kind == NODE_RETURN_TYPE) {
             // Found return_type node, extract the actual type
             if (check_node->left && check_node->left->token) {
                 return get_type(check_node->left->token);
@@ -1515,7 +1579,7 @@ void process_params_for_function(node* param_node, function_info* func_info, sco
     if (!param_node || !func_info) return;
     
     // Check if this is a parameter type node (int, string, float, bool)
-    if (param_node->token && get_type(param_node->token) != 0) {
+    if (param_node->kind == NODE_PARAM) {
         // This is a parameter type node
         int param_type = get_type(param_node->token);
         
@@ -1542,40 +1606,25 @@ void process_parameter_names_for_type(node* type_node, int param_type, function_
 void collect_parameter_names(node* node, int param_type, function_info* func_info, scope* func_scope) {
     if (!node) return;
     
-    // If this node has a token and it's not a type name, it might be a parameter name
-    if (node->token && strlen(node->token) > 0 && get_type(node->token) == 0) {
-        // This looks like a parameter name
-        char* param_name = node->token;
-        
-        // Check if this is actually a parameter name (not a default value)
-        if (is_valid_parameter_name(param_name)) {
-            
-            // Skip boolean literals used as default values:
-            if (strcmp(param_name, "true") == 0 || strcmp(param_name, "false") == 0) {
-                // This is a boolean default value, not a parameter name - SKIP IT!
-                return;
-            }
-            
-            // Skip numeric literals used as default values:
-            if (param_name[0] >= '0' && param_name[0] <= '9') {
-                // This is a numeric default value, not a parameter name - SKIP IT!
-                return;
-            }
-            
-            // Skip string literals used as default values:
-            if (param_name[0] == '"' || param_name[0] == '\'') {
-                // This is a string default value, not a parameter name - SKIP IT!
-                return;
-            }
+    switch (node->kind) {
+        case NODE_IDENT:
+        case NODE_DEFAULT_PARAM: {
+            char* param_name = node->token;
             
             log_info_format("Found parameter: %s %s", get_type_name(param_type), param_name);
             
-            // Add parameter to function
-            add_parameter_to_function(func_info, param_name, param_type, 0); // No default for now
+            // Add parameter to function, with its default expression if it has one
+            add_parameter_to_function(func_info, param_name, param_type,
+                                      node->kind == NODE_DEFAULT_PARAM ? node->left : NULL);
             
             // Add to function scope
             add_variable(func_scope, param_name, param_type);
+            
+            // A default value is an expression, not another parameter name
+            return;
         }
+        default:
+            break;
     }
     
     // Continue traversing to find more parameter names
@@ -1583,38 +1632,93 @@ void collect_parameter_names(node* node, int param_type, function_info* func_inf
     collect_parameter_names(node->right, param_type, func_info, func_scope);
 }
 
-// Check if a token is a valid parameter name
-int is_valid_parameter_name(char* token) {
-    if (!token || strlen(token) == 0) return 0;
+// Create a block scope named after the enclosing one, e.g. "main-if-block"
+scope* mkblockscope(scope* curr_scope, const char* block_name) {
+    scope* block_scope = mkscope(curr_scope);
+    if (curr_scope->scope_name) {
+        char name_buffer[256];
+        snprintf(name_buffer, sizeof(name_buffer), "%s-%s", curr_scope->scope_name, block_name);
+        block_scope->scope_name = strdup(name_buffer);
+    } else {
+        block_scope->scope_name = strdup(block_name);
+    }
+    return block_scope;
+}
+
+// Analyze a function declaration: record it, bind its parameters and walk its body
+void analyze_function(node* root, scope* curr_scope) {
+    // Create a scope for this function
+    scope* func_scope = mkscope(curr_scope);
     
-    // Skip type names
-    if (get_type(token) != 0) return 0;
+    if (!root->left || !root->left->token) {
+        return;
+    }
     
-    // Skip common keywords/operators
-    if (strcmp(token, "params") == 0 || 
-        strcmp(token, "return_type") == 0 ||
-        strcmp(token, "") == 0) return 0;
+    func_scope->scope_name = strdup(root->left->token);
+    log_info_format("Entering function scope: %s", func_scope->scope_name);
     
-    // Skip default value literals:
+    // Extract return type from AST
+    int return_type = extract_return_type(root);
     
-    // Skip boolean literals (default values)
-    if (strcmp(token, "true") == 0 || strcmp(token, "false") == 0 || 
-        strcmp(token, "True") == 0 || strcmp(token, "False") == 0) {
-        return 0;  // This is a default value, not a parameter name
+    // Create and track function declaration with return type
+    function_info* func_info = add_function_declaration(root->left->token, return_type);
+    if (!func_info) {
+        return;
     }
     
-    // Skip numeric literals (default values)
-    if (token[0] >= '0' && token[0] <= '9') {
-        return 0;  // This is a numeric default value
+    // SET CURRENT FUNCTION CONTEXT for return validation
+    function_info* previous_function = current_function;
+    current_function = func_info;
+    
+    validate_main_function(root, func_scope);
+    
+    // Find and process params node
+    node* current = root->right;
+    node* params_node = NULL;
+    
+    // Find the params node
+    node* nodes_to_check[50] = {current};
+    int front = 0, rear = 1;
+    
+    while (front < rear && rear < 50) {
+        node* check_node = nodes_to_check[front++];
+        if (!check_node) continue;
+        
+        if (check_node->kind == NODE_PARAMS) {
+            params_node = check_node;
+            break;
+        }
+        
+        if (check_node->left && rear < 50) {
+            nodes_to_check[rear++] = check_node->left;
+        }
+        if (check_node->right && rear < 50) {
+            nodes_to_check[rear++] = check_node->right;
+        }
     }
     
-    // Skip string literals (default values) 
-    if (token[0] == '"' || token[0] == '\'') {
-        return 0;  // This is a string default value
+    // Process params if found
+    if (params_node) {
+        log_info("Processing parameters...");
+        process_params_for_function(params_node, func_info, func_scope);
     }
     
-    // This looks like a valid parameter name
-    return 1;
+    // Now process the function body with the same scope
+    analyze_node(root->right, root, func_scope);
+    
+    // RESTORE PREVIOUS FUNCTION CONTEXT
+    current_function = previous_function;
+}
+
+// Analyze one operand of an index operation
+void analyze_index_operand(node* operand, node* index_node, scope* curr_scope) {
+    if (!operand) return;
+    
+    if (is_variable_usage(operand, index_node)) {
+        handle_variable_usage(operand, curr_scope);
+    } else {
+        analyze_node(operand, index_node, curr_scope);
+    }
 }
 
 // Function to analyze the AST and perform semantic checks
@@ -1627,334 +1731,158 @@ void analyze_node(node* root, node* parent, scope* curr_scope) {
     // Increment position counter
     current_position++;
    
-    // Check if this is a function declaration
-    if (root->token && strcmp(root->token, "function") == 0) {
-        // Create a scope for this function
-        scope* func_scope = mkscope(curr_scope);
-        
-        if (root->left && root->left->token) {
-            func_scope->scope_name = strdup(root->left->token);
-            log_info_format("Entering function scope: %s", func_scope->scope_name);
-            
-            // Extract return type from AST
-            int return_type = extract_return_type(root);
-            
-            // Create and track function declaration with return type
-            function_info* func_info = add_function_declaration(root->left->token, return_type);
+    switch (root->kind) {
+        case NODE_FUNCTION:
+            analyze_function(root, curr_scope);
+            return;
+
+        case NODE_IF_ELIF_ELSE:
+            log_info("Processing if-elif-else statement");
             
-            if (func_info) {
-                // SET CURRENT FUNCTION CONTEXT for return validation
-                function_info* previous_function = current_function;
-                current_function = func_info;
-                
-                validate_main_function(root, func_scope);
-                
-                // Find and process params node
-                node* current = root->right;
-                node* params_node = NULL;
-                
-                // Find the params node
-                node* nodes_to_check[50] = {current};
-                int front = 0, rear = 1;
-                
-                while (front < rear && rear < 50) {
-                    node* check_node = nodes_to_check[front++];
-                    if (!check_node) continue;
-                    
-                    if (check_node->token && strcmp(check_node->token, "params") == 0) {
-                        params_node = check_node;
-                        break;
-                    }
-                    
-                    if (check_node->left && rear < 50) {
-                        nodes_to_check[rear++] = check_node->left;
-                    }
-                    if (check_node->right && rear < 50) {
-                        nodes_to_check[rear++] = check_node->right;
-                    }
-                }
-                
-                // Process params if found
-                if (params_node) {
-                    log_info("Processing parameters...");
-                    process_params_for_function(params_node, func_info, func_scope);
-                }
-                
-                // Now process the function body with the same scope
-                analyze_node(root->right, root, func_scope);
-                
-                // RESTORE PREVIOUS FUNCTION CONTEXT
-                current_function = previous_function;
+            // For if-elif-else:
+            // root->left = if-elif structure (no direct condition to validate)
+            // root->right = final else body
+            if (root->left) {
+                analyze_node(root->left, root, curr_scope);
             }
-        }
-        return;
-    }
+            if (root->right) {
+                analyze_node(root->right, root, mkblockscope(curr_scope, "else-block"));
+            }
+            return; // Skip normal traversal
 
-    // Handle if-elif-else separately from if-elif
-    if (root->token && strcmp(root->token, "if-elif-else") == 0) {
-        log_info("Processing if-elif-else statement");
-        
-        // For if-elif-else:
-        // root->left = if-elif structure (no direct condition to validate)
-        // root->right = final else body
-        
-        // Process the if-elif part (left child)
-        if (root->left) {
-            analyze_node(root->left, root, curr_scope);
-        }
-        
-        // Process the else part (right child) with new scope
-        if (root->right) {
-            scope* else_scope = mkscope(curr_scope);
-            if (curr_scope->scope_name) {
-                char name_buffer[256];
-                sprintf(name_buffer, "%s-else-block", curr_scope->scope_name);
-                else_scope->scope_name = strdup(name_buffer);
-            } else {
-                else_scope->scope_name = strdup("else-block");
+        case NODE_IF_ELIF:
+            // Process the condition part (left child)
+            if (root->left) {
+                validate_condition_type(root->left, curr_scope, "if-elif");
+                analyze_node(root->left, root, curr_scope);
             }
-            
-            analyze_node(root->right, root, else_scope);
-        }
-        
-        return; // Skip normal traversal
-    }
+            // Process the body/branches (right child) with a new scope
+            if (root->right) {
+                analyze_node(root->right, root, mkblockscope(curr_scope, "if-elif-block"));
+            }
+            return; // Skip normal child traversal since we've handled it specifically
 
-    // Handle regular if-elif (keep existing logic)
-    if (root->token && strcmp(root->token, "if-elif") == 0) {
-        // Process the condition part (left child)
-        if (root->left) {
+        case NODE_ELIF:
             // Validate the condition
-            validate_condition_type(root->left, curr_scope, "if-elif");
+            validate_condition_type(root->left, curr_scope, "elif");
             
-            // Process left child (should be an if condition)
-            analyze_node(root->left, root, curr_scope);
-        }
-        
-        // Process the body/branches (right child)
-        if (root->right) {
-            // Create a new scope for blocks
-            scope* block_scope = mkscope(curr_scope);
-            if (curr_scope->scope_name) {
-                char name_buffer[256];
-                sprintf(name_buffer, "%s-if-elif-block", curr_scope->scope_name);
-                block_scope->scope_name = strdup(name_buffer);
-            } else {
-                block_scope->scope_name = strdup("if-elif-block");
-            }
-            
-            analyze_node(root->right, root, block_scope);
-        }
-        
-        return; // Skip normal child traversal since we've handled it specifically
-    }
-
-    // Special handling for elif node
-    if (root->token && strcmp(root->token, "elif") == 0) {
-        // Validate the condition
-        validate_condition_type(root->left, curr_scope, "elif");
-        
-        // Process the condition (left child)
-        if (root->left) {
-            analyze_node(root->left, root, curr_scope);
-        }
-        
-        // Process the body (right child) with a new scope
-        if (root->right) {
-            scope* elif_scope = mkscope(curr_scope);
-            if (curr_scope->scope_name) {
-                char name_buffer[256];
-                sprintf(name_buffer, "%s-elif-block", curr_scope->scope_name);
-                elif_scope->scope_name = strdup(name_buffer);
-            } else {
-                elif_scope->scope_name = strdup("elif-block");
+            if (root->left) {
+                analyze_node(root->left, root, curr_scope);
             }
-            
-            analyze_node(root->right, root, elif_scope);
-        }
-        
-        return; // Skip normal traversal
-    }
-    
-    // Special handling for if-else
-    if (root->token && strcmp(root->token, "if-else") == 0) {
-        // Process the if part (left child)
-        if (root->left) {
-            analyze_node(root->left, root, curr_scope);
-        }
-        
-        // Process the else part (right child) with a new scope
-        if (root->right) {
-            scope* else_scope = mkscope(curr_scope);
-            if (curr_scope->scope_name) {
-                char name_buffer[256];
-                sprintf(name_buffer, "%s-else-block", curr_scope->scope_name);
-                else_scope->scope_name = strdup(name_buffer);
-            } else {
-                else_scope->scope_name = strdup("else-block");
+            // Process the body (right child) with a new scope
+            if (root->right) {
+                analyze_node(root->right, root, mkblockscope(curr_scope, "elif-block"));
             }
-            
-            analyze_node(root->right, root, else_scope);
-        }
-        
-        return; // Skip normal traversal
-    }
+            return; // Skip normal traversal
 
-    if (root->token && strcmp(root->token, "index") == 0) {
-        log_info("Found string indexing operation");
-        
-        // Handle the string expression (left child)
-        if (root->left) {
-            if (is_variable_usage(root->left, root)) {
-                handle_variable_usage(root->left, curr_scope);
-            } else {
+        case NODE_IF_ELSE:
+            // Process the if part (left child)
+            if (root->left) {
                 analyze_node(root->left, root, curr_scope);
             }
-        }
-        
-        // Handle the index expression (right child)
-        if (root->right) {
-            if (is_variable_usage(root->right, root)) {
-                handle_variable_usage(root->right, curr_scope);
-            } else {
-                analyze_node(root->right, root, curr_scope);
+            // Process the else part (right child) with a new scope
+            if (root->right) {
+                analyze_node(root->right, root, mkblockscope(curr_scope, "else-block"));
             }
-        }
-        
-        // We've handled the children directly, so return to avoid processing them again
-        return;
-    }
-    
-    // Check if this is an if statement
-    if (root->token && strcmp(root->token, "if") == 0) {
-        // Validate the condition first
-        handle_if_statement(root, curr_scope);
-        
-        // Now handle the body with a new scope
-        if (root->right) {
-            // Create a new scope for the if-block
-            scope* block_scope = mkscope(curr_scope);
-            if (curr_scope->scope_name) {
-                char name_buffer[256];
-                sprintf(name_buffer, "%s-if-block", curr_scope->scope_name);
-                block_scope->scope_name = strdup(name_buffer);
-            } else {
-                block_scope->scope_name = strdup("if-block");
-            }
-            
-            // Process the if body with the new scope
-            analyze_node(root->right, root, block_scope);
+            return; // Skip normal traversal
+
+        case NODE_INDEX:
+            log_info("Found string indexing operation");
             
-            // Skip the normal child traversal since we've already handled the body
+            // Handle the string expression and the index expression directly
+            analyze_index_operand(root->left, root, curr_scope);
+            analyze_index_operand(root->right, root, curr_scope);
             return;
-        }
-    }
 
-    // Check if this is a while statement
-    if (root->token && strcmp(root->token, "while") == 0) {
-        // Validate the condition first
-        handle_while_statement(root, curr_scope);
-        
-        if (root->right) {
-            // Create a new scope for the while-block
-            scope* block_scope = mkscope(curr_scope);
-            if (curr_scope->scope_name) {
-                char name_buffer[256];
-                sprintf(name_buffer, "%s-while-block", curr_scope->scope_name);
-                block_scope->scope_name = strdup(name_buffer);
-            } else {
-                block_scope->scope_name = strdup("while-block");
-            }
+        case NODE_IF:
+            // Validate the condition first
+            handle_if_statement(root, curr_scope);
             
-            // Process the while body with the new scope
-            analyze_node(root->right, root, block_scope);
+            // Now handle the body with a new scope
+            if (root->right) {
+                analyze_node(root->right, root, mkblockscope(curr_scope, "if-block"));
+                return; // Skip the normal child traversal
+            }
+            break;
+
+        case NODE_WHILE:
+            // Validate the condition first
+            handle_while_statement(root, curr_scope);
             
-            // Skip the normal child traversal
+            if (root->right) {
+                analyze_node(root->right, root, mkblockscope(curr_scope, "while-block"));
+                return; // Skip the normal child traversal
+            }
+            break;
+
+        case NODE_SEQ:
+            // A sequence with two children is a code block. The rest of a
+            // statement list is a nested sequence and stays in the same scope,
+            // so the scope chain does not grow with the number of statements.
+            if (root->left && root->right) {
+                scope* block_scope = curr_scope;
+                if (!parent || parent->kind != NODE_SEQ) {
+                    block_scope = mkscope(curr_scope);
+                    block_scope->scope_name = strdup("block");
+                }
+                
+                analyze_node(root->left, root, block_scope);
+                analyze_node(root->right, root, block_scope);
+                return;
+            }
+            break;
+
+        case NODE_RETURN:
+            handle_return_statement(root, curr_scope);
+            break;
+
+        case NODE_PARAMS:
+            process_params(root, curr_scope);
             return;
-        }
-    }
 
-    if (root->token && (strcmp(root->token, "if-else") == 0 || 
-                        strcmp(root->token, "if-elif") == 0 || 
-                        strcmp(root->token, "if-elif-else") == 0)) {
-        node* if_part = root->left;  
-        if (if_part && strcmp(if_part->token, "if") == 0) {
-            handle_if_statement(if_part, curr_scope);
-        }
-    }       
+        case NODE_INIT:
+            if (root->left && root->left->right && root->left->right->token) {
+                log_info_format("Found initialization: %s", root->left->right->token);
+            }
+            handle_initialization(root, curr_scope);
+            return;
 
-    // Check if this is a code block 
-    if (root->token && strcmp(root->token, "") == 0 && root->left && root->right) {
-        // This might be a code block
-        scope* block_scope = mkscope(curr_scope);
-        block_scope->scope_name = strdup("block");
-        
-        analyze_node(root->left, root, block_scope);
-        analyze_node(root->right, root, block_scope);
-        return;
-    }
+        case NODE_INIT_VAR:
+            // This is a variable with initialization in a comma list
+            // root->left = variable name
+            // root->right = initialization expression
+            // The type comes from the parent declare node, which registers the variable
+            if (find_variable_in_scope(curr_scope, root->left->token)) {
+                log_error_format("Variable '%s' already declared in this scope", root->left->token);
+                return;
+            }
+            break;
 
-    // Check if this is a return statement
-    if (root->token && strcmp(root->token, "return") == 0) {
-        handle_return_statement(root, curr_scope);
-    }
-   
-    // Check if this is a params node
-    if (root->token && strcmp(root->token, "params") == 0) {
-        process_params(root, curr_scope);
-        return;
-    }
+        case NODE_DECLARE:
+            // Standalone declaration, not part of init
+            if (root->left && root->right && root->left->token && root->right->token) {
+                log_info_format("Found declaration: %s %s", root->left->token, root->right->token);
+                handle_declaration(root, curr_scope);
+            }
+            break;
 
-    // Check if this is an initialization node
-    if (root->token && strcmp(root->token, "init") == 0) {
-        if (root->left && root->left->right && root->left->right->token) {
-            log_info_format("Found initialization: %s", root->left->right->token);
-        }
-        handle_initialization(root, curr_scope);
-        return;
-    }
+        case NODE_ASSIGN:
+            if (root->left && root->left->token) {
+                log_info_format("Found assignment: %s", root->left->token);
+                handle_assignment(root, curr_scope);
+            }
+            break;
 
-    if (root->token && strcmp(root->token, "init_var") == 0) {
-        // This is a variable with initialization in a comma list
-        // root->left = variable name
-        // root->right = initialization expression
-        char* var_name = root->left->token;
-        
-        // Check if variable already exists in current scope
-        if (find_variable_in_scope(curr_scope, var_name)) {
-            log_error_format("Variable '%s' already declared in this scope", var_name);
-            return;
-        }
-        
-        // We need the type from the parent declare node
-        // This is a bit tricky with the current structure
-        // For now, we'll handle this in the declare node processing
-    }
+        case NODE_MULTI_ASSIGN:
+            handle_multiple_assignment(root, curr_scope);
+            return; // Don't process as variable usage
 
-    // Check if this is a declaration node (standalone, not part of init)
-    if (root->token && strcmp(root->token, "declare") == 0) {
-        if (root->left && root->right && root->left->token && root->right->token) {
-            log_info_format("Found declaration: %s %s", root->left->token, root->right->token);
-            handle_declaration(root, curr_scope);
-        }
-    }
-    
-    // Check if this is an assignment node
-    if (root->token && strcmp(root->token, "assign") == 0) {
-        if (root->left && root->left->token) {
-            log_info_format("Found assignment: %s", root->left->token);
-            handle_assignment(root, curr_scope);
-        }
-    }
-    
-    if (root->token && strcmp(root->token, "multi_assign") == 0) {
-        handle_multiple_assignment(root, curr_scope);
-        return; // Don't process as variable usage
-    }
+        case NODE_CALL:
+            handle_function_call(root, curr_scope);
+            break;
 
-    // Check if this is a function call
-    if (root->token && strcmp(root->token, "call") == 0) {
-        handle_function_call(root, curr_scope);
+        default:
+            break;
     }
     
     // Check if this is a variable usage
@@ -1973,8 +1901,8 @@ void semantic_analysis(struct node* root, scope* curr_scope) {
 
     log_info("=== Starting semantic analysis ===");
 
-    // Initialize function tracking list
-    declared_functions = NULL;
+    // Initialize function tracking table
+    reset_function_table();
     
     // Initialize counters for declaration order tracking
     declaration_counter = 0;
@@ -16,11 +16,72 @@ struct scope;
 // CORE DATA STRUCTURES
 // ============================================================================
 
+// AST node kinds, set by the grammar actions when a node is built
+typedef enum node_kind {
+    NODE_SEQ,             // "" - structural list/sequence node
+    NODE_TOKEN,           // Lexer token that never becomes an AST node itself
+    NODE_IDENT,           // Identifier
+    NODE_NUMBER,          // Integer or float literal
+    NODE_STRING,          // String literal (quotes kept in the token)
+    NODE_BOOL,            // true / false
+    NODE_TYPE,            // int / float / string / bool
+    NODE_ERROR,           // Error recovery placeholder
+    NODE_FUNCTION,
+    NODE_PARAMS,
+    NODE_PARAM,           // Parameter group, token is the type name
+    NODE_DEFAULT_PARAM,   // Parameter with default value, token is the name
+    NODE_RETURN_TYPE,
+    NODE_BLOCK,
+    NODE_PASS,
+    NODE_DECLARE,
+    NODE_INIT,
+    NODE_INIT_VAR,
+    NODE_MULTI_INIT,
+    NODE_ASSIGN,
+    NODE_MULTI_ASSIGN,
+    NODE_IF,
+    NODE_IF_ELSE,
+    NODE_IF_ELIF,
+    NODE_IF_ELIF_ELSE,
+    NODE_ELIF,
+    NODE_WHILE,
+    NODE_RETURN,
+    NODE_CALL,
+    NODE_BINARY,          // Arithmetic or comparison, see binary_op
+    NODE_AND,
+    NODE_OR,
+    NODE_NOT,
+    NODE_INDEX,
+    NODE_SLICE,
+    NODE_SLICE_STEP
+} node_kind;
+
+// Operators of NODE_BINARY nodes
+typedef enum binary_op {
+    OP_NONE,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_POW,
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_GT,
+    OP_LE,
+    OP_GE
+} binary_op;
+
 // AST node structure
 typedef struct node {
     char *token;
     struct node *left;
     struct node *right;
+    unsigned char kind;   // node_kind, stored compactly
+    unsigned char op;     // binary_op for NODE_BINARY, OP_NONE otherwise
+    unsigned char type;   // Expression type cached by get_expression_type
+    unsigned char typed;  // Set once type holds the computed result
 } node;
 
 // Type constants
@@ -33,12 +94,15 @@ typedef struct node {
 typedef struct var {
     char* name;
     int type;
-    struct var* next;
 } var;
 
-// Scope structure  
+#define SCOPE_INITIAL_CAPACITY 8
+
+// Scope structure: open-addressing table keyed on interned name pointers
 typedef struct scope {
-    var* variables;
+    var** variables;      // NULL marks an empty slot; allocated on first insert
+    int capacity;         // Always a power of two (or 0)
+    int count;
     struct scope* parent;
     char* scope_name;
 } scope;
@@ -50,16 +114,32 @@ typedef struct function_info {
     int* param_types;     
     char** param_names;      
     int* has_default;       
+    node** default_values;  // Default expression of each parameter, NULL if none
     int return_type;        
     int declaration_position; 
-    struct function_info* next;
+    char** local_names;   // Variables declared in the body, in declaration order
+    int* local_types;
+    int local_count;
+    int local_capacity;
 } function_info;
 
+#define FUNCTION_TABLE_INITIAL_CAPACITY 64
+
+// Function table: open-addressing map from interned name to function_info,
+// plus the functions in declaration order
+typedef struct function_table {
+    function_info** slots;      // NULL marks an empty slot
+    int capacity;               // Always a power of two (or 0)
+    function_info** in_order;   // in_order[i] has declaration_position i
+    int count;
+    int order_capacity;
+} function_table;
+
 // ============================================================================
 // GLOBAL STATE MANAGEMENT
 // ============================================================================
 
-extern function_info* declared_functions;
+extern function_table declared_functions;
 extern function_info* current_function;
 extern int declaration_counter;
 extern int semantic_errors;
@@ -83,10 +163,17 @@ void log_error_format(const char* format, ...);
 
 int get_type(char* type_str);
 char* get_type_name(int type);
+const char* binary_op_name(binary_op op);
 
 
 int get_expression_type(node* expr_node, scope* curr_scope);
-int looks_like_string_literal(char* token);
+int compute_expression_type(node* expr_node, scope* curr_scope);
+int get_node_type(node* expr_node);
+int get_arithmetic_type(node* expr_node, scope* curr_scope);
+int get_comparison_type(node* expr_node, scope* curr_scope);
+int get_equality_type(node* expr_node, scope* curr_scope);
+int get_logical_type(node* expr_node, scope* curr_scope);
+int get_call_type(node* expr_node);
 
 
 int check_index_operation(node* node, scope* current_scope);
@@ -97,6 +184,10 @@ int check_slice_operation(node* node, scope* current_scope);
 // ============================================================================
 
 scope* mkscope(scope* parent);
+unsigned int hash_name(char* name);
+var** find_scope_slot(scope* curr_scope, char* name);
+void grow_scope(scope* curr_scope);
+scope* mkblockscope(scope* curr_scope, const char* block_name);
 void add_variable(scope* curr_scope, char* name, int type);
 var* find_variable_in_scope(scope* curr_scope, char* name);
 var* find_variable_in_scope_hierarchy(scope* curr_scope, char* name);
@@ -107,8 +198,13 @@ var* find_variable_in_scope_hierarchy(scope* curr_scope, char* name);
 
 function_info* create_function_info(char* name, int return_type);
 function_info* find_function_by_name(char* func_name);
+function_info** find_function_slot(char* func_name);
+void grow_function_table(void);
+void insert_function(function_info* func);
+void reset_function_table(void);
 function_info* add_function_declaration(char* func_name, int return_type);
-void add_parameter_to_function(function_info* func, char* param_name, int param_type, int has_default_value);
+void add_parameter_to_function(function_info* func, char* param_name, int param_type, struct node* default_value);
+void add_local_to_function(function_info* func, char* local_name, int local_type);
 int is_function_declared(char* func_name);
 
 void validate_main_function(node* func_node, scope* func_scope);
@@ -122,7 +218,6 @@ void process_params(node* node, scope* func_scope);
 void process_params_for_function(node* param_node, function_info* func_info, scope* func_scope);
 void process_parameter_names_for_type(node* type_node, int param_type, function_info* func_info, scope* func_scope);
 void collect_parameter_names(node* node, int param_type, function_info* func_info, scope* func_scope);
-int is_valid_parameter_name(char* token);
 
 void process_variable_list(node* var_list, int type, scope* curr_scope);
 
@@ -171,6 +266,8 @@ void extract_from_list(node* list, node** array, int* index);
 // ============================================================================
 
 void analyze_node(node* root, node* parent, scope* curr_scope);
+void analyze_function(node* root, scope* curr_scope);
+void analyze_index_operand(node* operand, node* index_node, scope* curr_scope);
 void semantic_analysis(struct node* root, struct scope* curr_scope);
 
 #endif // SEMANTIC_ANALYSIS_H
\ No newline at end of file
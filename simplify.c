@@ -0,0 +1,330 @@
+#include <stdint.h>
+#include "simplify.h"
+#include "optimize.h"
+#include "cfg.h"
+
+static int is_int_value(const char* operand, long long value) {
+    return is_int_literal(operand) && strtoll(operand, NULL, 10) == value;
+}
+
+// k if value is 2^k for 1 <= k <= 30, 0 otherwise
+static int power_of_two_exponent(long long value) {
+    for (int k = 1; k <= 30; k++) {
+        if (value == (1LL << k)) return k;
+    }
+    return 0;
+}
+
+int simplify_quad(quad* q) {
+    if (q->opcode != IR_BINARY) return 0;
+    char* a = q->args[0];
+    char* b = q->args[1];
+    char* result = NULL;
+
+    if (q->type == TYPE_INT) {
+        switch (q->op) {
+            case OP_ADD:
+                if (is_int_value(b, 0)) result = a;
+                else if (is_int_value(a, 0)) result = b;
+                break;
+            case OP_SUB:
+                if (is_int_value(b, 0)) result = a;
+                else if (a == b && ir_is_variable(a)) result = make_int_literal(0);
+                break;
+            case OP_MUL:
+                if (is_int_value(b, 1)) result = a;
+                else if (is_int_value(a, 1)) result = b;
+                else if (is_int_value(a, 0) || is_int_value(b, 0)) result = make_int_literal(0);
+                break;
+            case OP_DIV:
+                if (is_int_value(b, 1)) result = a;
+                break;
+            case OP_MOD:
+                if (is_int_value(b, 1)) result = make_int_literal(0);
+                break;
+            case OP_POW:
+                if (is_int_value(b, 1)) result = a;
+                else if (is_int_value(b, 0)) result = make_int_literal(1);
+                break;
+            default:
+                break;
+        }
+    } else if (q->type == TYPE_FLOAT) {
+        // x + 0 is not x for x = -0.0, and x * 0 is not 0 for infinities
+        switch (q->op) {
+            case OP_MUL:
+                if (is_int_value(b, 1)) result = a;
+                else if (is_int_value(a, 1)) result = b;
+                break;
+            case OP_DIV:
+            case OP_POW:
+                if (is_int_value(b, 1)) result = a;
+                break;
+            case OP_SUB:
+                if (is_int_value(b, 0)) result = a;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (!result) return 0;
+    ir_make_copy(q, result);
+    return 1;
+}
+
+// Take the code out of fn so a pass can append the rewritten version
+static quad* take_code(ir_function* fn, int* count) {
+    quad* code = fn->code;
+    *count = fn->count;
+    fn->code = NULL;
+    fn->count = 0;
+    fn->capacity = 0;
+    return code;
+}
+
+static void append_quad(ir_function* fn, quad* q) {
+    *ir_append(fn, q->opcode) = *q;
+}
+
+// result = base ** exponent by square-and-multiply over the exponent bits
+static void emit_power(ir_function* fn, quad* q, long long exponent) {
+    int top = 62;
+    while (!((exponent >> top) & 1)) top--;
+
+    char* acc = q->args[0];
+    for (int bit = top - 1; bit >= 0; bit--) {
+        int last_square = bit == 0 && !((exponent >> bit) & 1);
+        char* square = last_square ? q->result : ir_new_temp(fn);
+        ir_emit_binary(fn, square, OP_MUL, acc, acc, q->type);
+        acc = square;
+        if ((exponent >> bit) & 1) {
+            char* product = bit == 0 ? q->result : ir_new_temp(fn);
+            ir_emit_binary(fn, product, OP_MUL, acc, q->args[0], q->type);
+            acc = product;
+        }
+    }
+}
+
+int simplify_algebra(ir_function* fn) {
+    int count = 0;
+    quad* code = take_code(fn, &count);
+    int hits = 0;
+
+    for (int i = 0; i < count; i++) {
+        quad* q = &code[i];
+        if (simplify_quad(q)) {
+            hits++;
+        } else if (q->opcode == IR_BINARY && q->op == OP_POW && is_int_literal(q->args[1])) {
+            // Float powers are only exact as a single multiplication
+            long long exponent = strtoll(q->args[1], NULL, 10);
+            int limit = q->type == TYPE_INT ? SIMPLIFY_MAX_POW_EXPONENT : q->type == TYPE_FLOAT ? 2 : 0;
+            if (exponent >= 2 && exponent <= limit) {
+                emit_power(fn, q, exponent);
+                hits++;
+                continue;
+            }
+        }
+        append_quad(fn, q);
+    }
+
+    free(code);
+    return hits;
+}
+
+// ============================================================================
+// STRENGTH REDUCTION
+// ============================================================================
+// Ints are 32-bit and division truncates toward zero. A signed division
+// by 2^k first adds 2^k - 1 to negative dividends; x >> 31 is -1 for
+// those and 0 otherwise.
+
+// Multiplier and shift for signed division by d >= 2 (Hacker's Delight, 10-1)
+static void division_magic(int32_t d, int32_t* multiplier, int* shift) {
+    const uint32_t two31 = 0x80000000u;
+    uint32_t ad = (uint32_t)d;
+    uint32_t anc = two31 - 1 - two31 % ad;
+    int p = 31;
+    uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+    uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+    uint32_t delta;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    *multiplier = (int32_t)(q2 + 1);
+    *shift = p - 32;
+}
+
+// x >> 31 of the values seen since the last label or jump, so several
+// reductions of the same dividend compute its sign once
+typedef struct sign_cache {
+    char** values;
+    char** signs;
+    int count;
+    int capacity;
+} sign_cache;
+
+static char* sign_of(ir_function* fn, sign_cache* cache, char* x) {
+    for (int i = 0; i < cache->count; i++) {
+        if (cache->values[i] == x) return cache->signs[i];
+    }
+    if (cache->count == cache->capacity) {
+        cache->capacity = cache->capacity ? cache->capacity * 2 : 8;
+        cache->values = (char**)realloc(cache->values, cache->capacity * sizeof(char*));
+        cache->signs = (char**)realloc(cache->signs, cache->capacity * sizeof(char*));
+    }
+    char* sign = ir_new_temp(fn);
+    ir_emit_binary(fn, sign, OP_SHR, x, make_int_literal(31), TYPE_INT);
+    cache->values[cache->count] = x;
+    cache->signs[cache->count] = sign;
+    cache->count++;
+    return sign;
+}
+
+// Forget the signs a quad makes stale
+static void update_sign_cache(sign_cache* cache, quad* q) {
+    if (q->opcode == IR_LABEL || is_jump_opcode(q->opcode)) {
+        cache->count = 0;
+        return;
+    }
+    for (int i = 0; i < cache->count; i++) {
+        if (cache->values[i] != q->result && cache->signs[i] != q->result) continue;
+        cache->count--;
+        cache->values[i] = cache->values[cache->count];
+        cache->signs[i] = cache->signs[cache->count];
+        i--;
+    }
+}
+
+// x + (2^k - 1 if x < 0), into a new temporary
+static char* emit_bias(ir_function* fn, sign_cache* cache, char* x, int k) {
+    char* sign = sign_of(fn, cache, x);
+    char* t = ir_new_temp(fn);
+    ir_emit_binary(fn, t, OP_BITAND, sign, make_int_literal((1LL << k) - 1), TYPE_INT);
+    ir_emit_binary(fn, t, OP_ADD, x, t, TYPE_INT);
+    return t;
+}
+
+// result = x / d for d >= 3 not a power of two
+static void emit_magic_division(ir_function* fn, sign_cache* cache, char* result, char* x, long long d) {
+    int32_t multiplier;
+    int shift;
+    division_magic((int32_t)d, &multiplier, &shift);
+
+    char* sign = sign_of(fn, cache, x);
+    char* t = ir_new_temp(fn);
+    ir_emit_binary(fn, t, OP_MULHI, x, make_int_literal(multiplier), TYPE_INT);
+    if (multiplier < 0) {
+        ir_emit_binary(fn, t, OP_ADD, t, x, TYPE_INT);
+    }
+    if (shift > 0) {
+        ir_emit_binary(fn, t, OP_SHR, t, make_int_literal(shift), TYPE_INT);
+    }
+    ir_emit_binary(fn, result, OP_SUB, t, sign, TYPE_INT);
+}
+
+static int reduce_int_operation(ir_function* fn, sign_cache* cache, quad* q) {
+    char* x = q->args[0];
+    char* constant = q->args[1];
+    if (q->op == OP_MUL && is_int_literal(x)) {
+        x = q->args[1];
+        constant = q->args[0];
+    }
+    if (!ir_is_variable(x) || !is_int_literal(constant)) return 0;
+
+    long long c = strtoll(constant, NULL, 10);
+    int k = power_of_two_exponent(c);
+
+    switch (q->op) {
+        case OP_MUL:
+            if (!k) return 0;
+            ir_emit_binary(fn, q->result, OP_SHL, x, make_int_literal(k), TYPE_INT);
+            return 1;
+        case OP_DIV:
+            if (k) {
+                char* biased = emit_bias(fn, cache, x, k);
+                ir_emit_binary(fn, q->result, OP_SHR, biased, make_int_literal(k), TYPE_INT);
+            } else if (c >= 3 && c <= INT32_MAX) {
+                emit_magic_division(fn, cache, q->result, x, c);
+            } else {
+                return 0;
+            }
+            return 1;
+        case OP_MOD: {
+            char* rounded;
+            if (k) {
+                rounded = emit_bias(fn, cache, x, k);
+                ir_emit_binary(fn, rounded, OP_BITAND, rounded, make_int_literal(-(1LL << k)), TYPE_INT);
+            } else if (c >= 3 && c <= INT32_MAX) {
+                rounded = ir_new_temp(fn);
+                emit_magic_division(fn, cache, rounded, x, c);
+                ir_emit_binary(fn, rounded, OP_MUL, rounded, constant, TYPE_INT);
+            } else {
+                return 0;
+            }
+            ir_emit_binary(fn, q->result, OP_SUB, x, rounded, TYPE_INT);
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int reduce_float_operation(ir_function* fn, quad* q) {
+    if (q->op == OP_MUL) {
+        char* x = is_int_value(q->args[1], 2) ? q->args[0] : is_int_value(q->args[0], 2) ? q->args[1] : NULL;
+        if (!ir_is_variable(x)) return 0;
+        ir_emit_binary(fn, q->result, OP_ADD, x, x, TYPE_FLOAT);
+        return 1;
+    }
+    if (q->op == OP_DIV && ir_is_variable(q->args[0]) && is_int_literal(q->args[1])) {
+        int k = power_of_two_exponent(strtoll(q->args[1], NULL, 10));
+        if (!k) return 0;
+        ir_emit_binary(fn, q->result, OP_MUL, q->args[0], make_float_literal(1.0 / (double)(1LL << k)), TYPE_FLOAT);
+        return 1;
+    }
+    return 0;
+}
+
+int reduce_strength(ir_function* fn) {
+    int count = 0;
+    quad* code = take_code(fn, &count);
+    int hits = 0;
+    sign_cache cache;
+    memset(&cache, 0, sizeof(cache));
+
+    for (int i = 0; i < count; i++) {
+        quad* q = &code[i];
+        int reduced = 0;
+        if (q->opcode == IR_BINARY && q->type == TYPE_INT) {
+            reduced = reduce_int_operation(fn, &cache, q);
+        } else if (q->opcode == IR_BINARY && q->type == TYPE_FLOAT) {
+            reduced = reduce_float_operation(fn, q);
+        }
+        if (reduced) {
+            hits++;
+        } else {
+            append_quad(fn, q);
+        }
+        update_sign_cache(&cache, q);
+    }
+
+    free(cache.values);
+    free(cache.signs);
+    free(code);
+    return hits;
+}
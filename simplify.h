@@ -0,0 +1,30 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "ir.h"
+
+// ============================================================================
+// ALGEBRAIC SIMPLIFICATION AND STRENGTH REDUCTION
+// ============================================================================
+// Every rewrite is gated on the result type recorded by code generation.
+// An int result means both operands are ints. A float result with an int
+// literal operand means the other operand is a float. No rule applies
+// when the types are not known to match.
+
+// Largest constant exponent expanded into a multiply chain
+#define SIMPLIFY_MAX_POW_EXPONENT 8
+
+// Rewrite one instruction by an identity or annihilator (x + 0, x * 1,
+// x * 0, x ** 1, ...) into a copy; returns 1 if it did
+int simplify_quad(quad* q);
+
+// Apply simplify_quad to every instruction and expand x ** n for a small
+// constant n into multiplications; returns the number of rewrites
+int simplify_algebra(ir_function* fn);
+
+// Replace int multiply, divide and modulo by a constant with shifts, masks
+// and multiply-high sequences, and float multiply or divide by a power of
+// two with an addition or a multiplication; returns the number of rewrites
+int reduce_strength(ir_function* fn);
+
+#endif // SIMPLIFY_H
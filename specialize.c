@@ -0,0 +1,342 @@
+#include "specialize.h"
+#include "inline.h"
+#include "optimize.h"
+#include "loop.h"
+#include "intern.h"
+
+// One clone: the callee and the literal bound to each of its parameters,
+// NULL for the ones left open
+typedef struct clone_entry {
+    char* callee;
+    char** constants;
+    int param_count;
+    char* clone;
+    struct clone_entry* next;
+} clone_entry;
+
+static clone_entry* clones = NULL;
+static int clone_growth = 0;   // Instructions in all clones so far
+static int building = 0;       // Clones being optimized
+
+static clone_entry* find_clone(char* callee, char** constants, int param_count) {
+    for (clone_entry* entry = clones; entry; entry = entry->next) {
+        if (entry->callee != callee || entry->param_count != param_count) continue;
+        if (memcmp(entry->constants, constants, param_count * sizeof(char*)) == 0) return entry;
+    }
+    return NULL;
+}
+
+static int count_clones(char* callee) {
+    int count = 0;
+    for (clone_entry* entry = clones; entry; entry = entry->next) {
+        if (entry->callee == callee) count++;
+    }
+    return count;
+}
+
+static int is_clone(char* name) {
+    for (clone_entry* entry = clones; entry; entry = entry->next) {
+        if (entry->clone == name) return 1;
+    }
+    return 0;
+}
+
+void release_specializations(void) {
+    while (clones) {
+        clone_entry* next = clones->next;
+        free(clones->constants);
+        free(clones);
+        clones = next;
+    }
+    clone_growth = 0;
+}
+
+// ============================================================================
+// PATTERNS
+// ============================================================================
+
+// Literal of each parameter for a call site, NULL for the open ones;
+// returns the number of literals, 0 if the site cannot be specialized.
+// known holds the literal of each temporary written once by a copy of one,
+// as an inlined body binds its parameters.
+static int site_pattern(ir_function* fn, call_site* site, function_info* info, char** known, char** constants) {
+    if (site->arg_count > info->param_count) return 0;
+    int literals = 0;
+    for (int p = 0; p < info->param_count; p++) {
+        char* value;
+        if (p < site->arg_count) {
+            value = fn->code[site->pushes[p]].args[0];
+            int t = ir_temp_number(fn, value);
+            if (t && known[t]) value = known[t];
+            if (ir_is_variable(value)) value = NULL;
+        } else {
+            value = default_argument(info, p);
+            if (!value) return 0;
+        }
+        constants[p] = value ? intern(value) : NULL;
+        if (value) literals++;
+    }
+    return literals;
+}
+
+// "f(x, k=3)": open parameters by name, literals with their value
+static void describe_pattern(char* text, int size, char* callee, function_info* info, char** constants) {
+    int length = snprintf(text, size, "%s(", callee);
+    for (int p = 0; p < info->param_count && length < size; p++) {
+        length += snprintf(text + length, size - length, "%s%s", p ? ", " : "", info->param_names[p]);
+        if (constants[p] && length < size) {
+            length += snprintf(text + length, size - length, "=%s", constants[p]);
+        }
+    }
+    if (length < size) snprintf(text + length, size - length, ")");
+}
+
+// Why the callee cannot be cloned for this pattern, NULL if it can
+static const char* check_clone(ir_function* body, function_info* info, char** constants) {
+    if (count_clones(info->name) >= SPECIALIZE_MAX_CLONES) return "clone limit";
+
+    // A TailCall stores its arguments over the parameters of the clone
+    int open = 0;
+    for (int p = 0; p < info->param_count; p++) {
+        if (!constants[p]) open++;
+    }
+    for (int i = 0; i < body->count; i++) {
+        if (body->code[i].opcode == IR_TAIL_CALL && body->code[i].value > open * FRAME_SLOT_SIZE) {
+            return "TailCall needs the parameters";
+        }
+        if (body->code[i].opcode == IR_SWITCH) return "body has a switch";
+    }
+
+    if (clone_growth + body->count > SPECIALIZE_MAX_GROWTH) return "growth cap";
+    return NULL;
+}
+
+// ============================================================================
+// CLONES
+// ============================================================================
+
+static clone_entry* create_clone(ir_program* program, ir_function* body, function_info* info,
+                                 char** constants, char* pattern) {
+    char name[128];
+    for (int n = 1; ; n++) {
+        snprintf(name, sizeof(name), "%s__s%d", info->name, n);
+        char* interned = intern(name);
+        if (!find_function_by_name(interned) && !ir_find_function(program, interned)) break;
+    }
+
+    // A literal the body never overwrites replaces the parameter outright;
+    // the others become locals set at the entry
+    char* assigned = (char*)calloc(info->param_count + 1, 1);
+    for (int i = 0; i < body->count; i++) {
+        for (int p = 0; p < info->param_count; p++) {
+            if (body->code[i].result == info->param_names[p]) assigned[p] = 1;
+        }
+    }
+
+    // Open parameters keep their order
+    function_info* clone_info = create_function_info(name, info->return_type);
+    clone_info->declaration_position = info->declaration_position;
+    clone_info->param_types = (int*)malloc((info->param_count + 1) * sizeof(int));
+    clone_info->param_names = (char**)malloc((info->param_count + 1) * sizeof(char*));
+    clone_info->has_default = (int*)malloc((info->param_count + 1) * sizeof(int));
+    clone_info->default_values = (node**)malloc((info->param_count + 1) * sizeof(node*));
+    for (int p = 0; p < info->param_count; p++) {
+        if (constants[p]) {
+            if (assigned[p]) add_local_to_function(clone_info, info->param_names[p], info->param_types[p]);
+            continue;
+        }
+        int q = clone_info->param_count++;
+        clone_info->param_types[q] = info->param_types[p];
+        clone_info->param_names[q] = info->param_names[p];
+        clone_info->has_default[q] = info->has_default[p];
+        clone_info->default_values[q] = info->default_values[p];
+    }
+    for (int v = 0; v < info->local_count; v++) {
+        add_local_to_function(clone_info, info->local_names[v], info->local_types[v]);
+    }
+    insert_function(clone_info);
+
+    // After the callee and the clones it already has
+    ir_function* after = body;
+    for (clone_entry* entry = clones; entry; entry = entry->next) {
+        if (entry->callee == info->name) {
+            after = ir_find_function(program, entry->clone);
+            break;
+        }
+    }
+    ir_function* clone = ir_new_function_after(program, after, name);
+    clone->temp_count = body->temp_count;
+    clone->label_count = body->label_count;
+    for (int p = 0; p < info->param_count; p++) {
+        if (constants[p] && assigned[p]) ir_emit_copy(clone, info->param_names[p], constants[p], info->param_types[p]);
+    }
+    for (int i = 0; i < body->count; i++) {
+        quad* q = ir_append(clone, body->code[i].opcode);
+        *q = body->code[i];
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            for (int p = 0; p < info->param_count; p++) {
+                if (q->args[a] == info->param_names[p] && constants[p] && !assigned[p]) q->args[a] = constants[p];
+            }
+        }
+    }
+    free(assigned);
+    ir_add_note(clone, "specialize: clone of %s", pattern);
+
+    clone_entry* entry = (clone_entry*)malloc(sizeof(clone_entry));
+    entry->callee = info->name;
+    entry->constants = (char**)malloc((info->param_count + 1) * sizeof(char*));
+    memcpy(entry->constants, constants, info->param_count * sizeof(char*));
+    entry->param_count = info->param_count;
+    entry->clone = clone->name;
+    entry->next = clones;
+    clones = entry;
+
+    // Registered first, so its recursive calls can become calls to itself
+    building++;
+    optimize_function(program, clone);
+    building--;
+    ir_layout_frame(clone);
+    clone_growth += clone->count;
+    return entry;
+}
+
+// ============================================================================
+// CALL SITES
+// ============================================================================
+
+// Drop the pushes of the literals and call the clone instead
+static void retarget_site(ir_function* fn, call_site* site, char** constants, int param_count,
+                          char* clone, char* removed) {
+    int open = 0;
+    for (int p = 0; p < param_count; p++) {
+        if (!constants[p]) {
+            open++;
+        } else if (p < site->arg_count) {
+            removed[site->pushes[p]] = 1;
+        }
+    }
+
+    quad* call = &fn->code[site->call];
+    call->target = clone;
+    if (call->opcode == IR_TAIL_CALL) {
+        call->value = open * FRAME_SLOT_SIZE;
+    } else if (site->pop >= 0) {
+        fn->code[site->pop].value = open * FRAME_SLOT_SIZE;
+        if (open == 0) removed[site->pop] = 1;
+    }
+}
+
+void specialize_calls(ir_program* program, ir_function* fn, specialize_stats* stats) {
+    memset(stats, 0, sizeof(specialize_stats));
+    if (fn->count == 0) return;
+
+    int site_count = 0;
+    call_site* sites = find_call_sites(fn, &site_count);
+    if (site_count == 0) {
+        release_call_sites(sites, site_count);
+        return;
+    }
+
+    // Blocks inside some loop
+    cfg graph;
+    loop_forest forest;
+    cfg_build(&graph, fn);
+    find_loops(&graph, &forest);
+    char* looped = (char*)calloc(graph.count + 1, 1);
+    for (int l = 0; l < forest.count; l++) {
+        for (int b = 0; b < forest.loops[l].count; b++) {
+            looped[forest.loops[l].blocks[b]] = 1;
+        }
+    }
+
+    int* defs = (int*)calloc(fn->temp_count + 1, sizeof(int));
+    char** known = (char**)calloc(fn->temp_count + 1, sizeof(char*));
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        int t = ir_temp_number(fn, q->result);
+        if (!t) continue;
+        known[t] = ++defs[t] == 1 && q->opcode == IR_COPY && !ir_is_variable(q->args[0]) ? q->args[0] : NULL;
+    }
+
+    // Pattern of every site that has one
+    char*** patterns = (char***)calloc(site_count, sizeof(char**));
+    function_info** callees = (function_info**)calloc(site_count, sizeof(function_info*));
+    for (int s = 0; s < site_count; s++) {
+        quad* call = &fn->code[sites[s].call];
+        function_info* info = find_function_by_name(call->target);
+        ir_function* body = ir_find_function(program, call->target);
+        if (!info || !body || body == fn || info->param_count == 0 || is_clone(info->name)) continue;
+        char** constants = (char**)malloc(info->param_count * sizeof(char*));
+        if (!site_pattern(fn, &sites[s], info, known, constants)) {
+            free(constants);
+            continue;
+        }
+        patterns[s] = constants;
+        callees[s] = info;
+    }
+
+    char* removed = (char*)calloc(fn->count + 1, 1);
+    int* group = (int*)malloc(site_count * sizeof(int));
+    for (int s = 0; s < site_count; s++) {
+        if (!patterns[s]) continue;
+        function_info* info = callees[s];
+
+        // Every later site with the same callee and pattern
+        int group_count = 0;
+        int in_loop = 0;
+        for (int t = s; t < site_count; t++) {
+            if (!patterns[t] || callees[t] != info) continue;
+            if (memcmp(patterns[t], patterns[s], info->param_count * sizeof(char*)) != 0) continue;
+            group[group_count++] = t;
+            in_loop |= looped[cfg_block_of_quad(&graph, sites[t].call)];
+        }
+
+        char pattern[128];
+        describe_pattern(pattern, sizeof(pattern), info->name, info, patterns[s]);
+        clone_entry* entry = find_clone(info->name, patterns[s], info->param_count);
+        if (entry) {
+            ir_add_note(fn, "specialize: %s reuses %s (%d call sites)", pattern, entry->clone, group_count);
+        } else {
+            ir_function* body = ir_find_function(program, info->name);
+            const char* reason = building ? "inside a clone" :
+                                 group_count < SPECIALIZE_MIN_SITES && !in_loop ? "one call site outside loops" :
+                                 check_clone(body, info, patterns[s]);
+            if (reason) {
+                ir_add_note(fn, "specialize: %s: kept, %s", pattern, reason);
+            } else {
+                entry = create_clone(program, body, info, patterns[s], pattern);
+                stats->created++;
+                ir_add_note(fn, "specialize: %s as %s (%d call sites)", pattern, entry->clone, group_count);
+            }
+        }
+
+        for (int g = 0; g < group_count; g++) {
+            int t = group[g];
+            if (entry) {
+                retarget_site(fn, &sites[t], patterns[t], info->param_count, entry->clone, removed);
+                stats->retargeted++;
+            }
+            free(patterns[t]);
+            patterns[t] = NULL;
+        }
+    }
+
+    if (stats->retargeted > 0) {
+        int kept = 0;
+        for (int i = 0; i < fn->count; i++) {
+            if (!removed[i]) fn->code[kept++] = fn->code[i];
+        }
+        fn->count = kept;
+    }
+
+    free(defs);
+    free(known);
+    free(removed);
+    free(group);
+    free(patterns);
+    free(callees);
+    free(looped);
+    release_loops(&forest);
+    cfg_release(&graph);
+    release_call_sites(sites, site_count);
+}
@@ -0,0 +1,50 @@
+#ifndef SPECIALIZE_H
+#define SPECIALIZE_H
+
+#include "semantic_analysis.h"
+#include "ir.h"
+
+// ============================================================================
+// FUNCTION SPECIALIZATION
+// ============================================================================
+// The pattern of a call site says, for each parameter of the callee,
+// whether the call passes a literal (pushed, or a left-out argument whose
+// default is a literal) or a value only known at run time. A pattern with
+// at least one literal is hot when it occurs at SPECIALIZE_MIN_SITES sites
+// of the caller or at a site inside a loop.
+//
+// A hot pattern gets a clone of the callee, named f__s1, f__s2, ..., whose
+// parameters are the ones the pattern leaves open. The body is a copy of
+// the callee's final code with every read of a bound parameter replaced
+// by its literal; a parameter the body assigns becomes a local set to
+// the literal at the entry instead. The clone then goes through the
+// optimizer, which folds what the constants decide. Its call sites push
+// only the open arguments:
+//     PushParam x; PushParam 3; t = LCall f; PopParams 16
+// becomes
+//     PushParam x; t = LCall f__s1; PopParams 8
+//
+// Clones are shared by the whole program, so a later caller with the same
+// pattern reuses one without counting sites, and so do the recursive
+// calls of a clone to the function it was made from. Clones are only
+// made of source functions: f__s1 and f__s2 are both clones of f, and
+// calls to a clone are never specialized again. While a clone is being
+// optimized it may reuse existing clones but makes no new one. Each
+// callee gets at most SPECIALIZE_MAX_CLONES clones, and all clones
+// together at most SPECIALIZE_MAX_GROWTH instructions.
+
+#define SPECIALIZE_MIN_SITES 2
+#define SPECIALIZE_MAX_CLONES 4
+#define SPECIALIZE_MAX_GROWTH 256
+
+typedef struct specialize_stats {
+    int created;          // Clones made for this function's call sites
+    int retargeted;       // Call sites that now call a clone
+} specialize_stats;
+
+void specialize_calls(ir_program* program, ir_function* fn, specialize_stats* stats);
+
+// Forget the clones once the program is generated
+void release_specializations(void);
+
+#endif // SPECIALIZE_H
@@ -0,0 +1,1028 @@
+#include "ssa.h"
+#include "intern.h"
+
+// Append to a growable int array
+static void push_int(int** list, int* count, int* capacity, int value) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 4;
+        *list = (int*)realloc(*list, *capacity * sizeof(int));
+    }
+    (*list)[(*count)++] = value;
+}
+
+// ============================================================================
+// NAME REGISTRY
+// ============================================================================
+
+static void grow_name_map(ssa_form* ssa) {
+    int old_capacity = ssa->slot_capacity;
+    int* old_slots = ssa->slots;
+
+    ssa->slot_capacity = old_capacity ? old_capacity * 2 : 64;
+    ssa->slots = (int*)malloc(ssa->slot_capacity * sizeof(int));
+    for (int i = 0; i < ssa->slot_capacity; i++) {
+        ssa->slots[i] = -1;
+    }
+
+    unsigned int mask = ssa->slot_capacity - 1;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_slots[i] < 0) continue;
+        unsigned int index = hash_name(ssa->names[old_slots[i]].name) & mask;
+        while (ssa->slots[index] >= 0) {
+            index = (index + 1) & mask;
+        }
+        ssa->slots[index] = old_slots[i];
+    }
+    free(old_slots);
+}
+
+int ssa_name_index(ssa_form* ssa, char* name) {
+    if (ssa->slot_capacity == 0) return -1;
+
+    unsigned int mask = ssa->slot_capacity - 1;
+    unsigned int index = hash_name(name) & mask;
+    while (ssa->slots[index] >= 0) {
+        if (ssa->names[ssa->slots[index]].name == name) {
+            return ssa->slots[index];
+        }
+        index = (index + 1) & mask;
+    }
+    return -1;
+}
+
+static int register_name(ssa_form* ssa, char* name, int base, int version) {
+    if (2 * (ssa->name_count + 1) > ssa->slot_capacity) {
+        grow_name_map(ssa);
+    }
+    if (ssa->name_count == ssa->name_capacity) {
+        ssa->name_capacity = ssa->name_capacity ? ssa->name_capacity * 2 : 64;
+        ssa->names = (ssa_name*)realloc(ssa->names, ssa->name_capacity * sizeof(ssa_name));
+    }
+
+    int id = ssa->name_count++;
+    ssa_name* entry = &ssa->names[id];
+    entry->name = name;
+    entry->base = base < 0 ? id : base;
+    entry->version = version;
+    entry->last_version = 0;
+    entry->type = 0;
+
+    unsigned int mask = ssa->slot_capacity - 1;
+    unsigned int index = hash_name(name) & mask;
+    while (ssa->slots[index] >= 0) {
+        index = (index + 1) & mask;
+    }
+    ssa->slots[index] = id;
+    return id;
+}
+
+// Registry index of an operand, adding it as an unversioned name if new
+static int base_index(ssa_form* ssa, char* name) {
+    int id = ssa_name_index(ssa, name);
+    return id >= 0 ? id : register_name(ssa, name, -1, 0);
+}
+
+// Hand out the next version of an unversioned name
+static int new_version(ssa_form* ssa, int base) {
+    int version = ++ssa->names[base].last_version;
+    char* base_name = ssa->names[base].name;
+
+    size_t length = strlen(base_name) + 16;
+    char* buffer = (char*)malloc(length);
+    snprintf(buffer, length, "%s.%d", base_name, version);
+    char* name = intern(buffer);
+    free(buffer);
+
+    return register_name(ssa, name, base, version);
+}
+
+char* ssa_base_name(ssa_form* ssa, char* name) {
+    int id = ssa_name_index(ssa, name);
+    return id >= 0 ? ssa->names[ssa->names[id].base].name : name;
+}
+
+// ============================================================================
+// DOMINATORS
+// ============================================================================
+
+// Number the reachable blocks in reverse postorder
+static void compute_reverse_postorder(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    int* postorder = (int*)malloc(graph->count * sizeof(int));
+    int* stack = (int*)malloc(graph->count * sizeof(int));
+    int* next_edge = (int*)calloc(graph->count, sizeof(int));
+    char* visited = (char*)calloc(graph->count, 1);
+    int post_count = 0, depth = 0;
+
+    stack[depth++] = 0;
+    visited[0] = 1;
+    while (depth > 0) {
+        basic_block* block = &graph->blocks[stack[depth - 1]];
+        if (next_edge[block->id] < block->succ_count) {
+            int succ = block->succs[next_edge[block->id]++];
+            if (!visited[succ]) {
+                visited[succ] = 1;
+                stack[depth++] = succ;
+            }
+        } else {
+            postorder[post_count++] = block->id;
+            depth--;
+        }
+    }
+
+    ssa->rpo = (int*)malloc((post_count + 1) * sizeof(int));
+    ssa->rpo_count = post_count;
+    for (int b = 0; b < graph->count; b++) {
+        ssa->blocks[b].rpo_index = -1;
+    }
+    for (int i = 0; i < post_count; i++) {
+        ssa->rpo[i] = postorder[post_count - 1 - i];
+        ssa->blocks[ssa->rpo[i]].rpo_index = i;
+    }
+
+    free(postorder);
+    free(stack);
+    free(next_edge);
+    free(visited);
+}
+
+static int intersect(ssa_form* ssa, int a, int b) {
+    while (a != b) {
+        while (ssa->blocks[a].rpo_index > ssa->blocks[b].rpo_index) a = ssa->blocks[a].idom;
+        while (ssa->blocks[b].rpo_index > ssa->blocks[a].rpo_index) b = ssa->blocks[b].idom;
+    }
+    return a;
+}
+
+// Iterative dominator computation of Cooper, Harvey and Kennedy
+static void compute_dominators(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    for (int b = 0; b < graph->count; b++) {
+        ssa->blocks[b].idom = -1;
+    }
+    compute_reverse_postorder(ssa);
+    ssa->blocks[0].idom = 0;
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 1; i < ssa->rpo_count; i++) {
+            basic_block* block = &graph->blocks[ssa->rpo[i]];
+            int new_idom = -1;
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (ssa->blocks[pred].idom < 0) continue;
+                new_idom = new_idom < 0 ? pred : intersect(ssa, new_idom, pred);
+            }
+            if (ssa->blocks[block->id].idom != new_idom) {
+                ssa->blocks[block->id].idom = new_idom;
+                changed = 1;
+            }
+        }
+    }
+    ssa->blocks[0].idom = -1;
+
+    for (int i = 1; i < ssa->rpo_count; i++) {
+        ssa_block* block = &ssa->blocks[ssa->rpo[i]];
+        ssa_block* parent = &ssa->blocks[block->idom];
+        push_int(&parent->children, &parent->child_count, &parent->child_capacity, ssa->rpo[i]);
+    }
+
+    // Pre/postorder numbers of the dominator tree answer dominance in O(1)
+    int* stack = (int*)malloc((graph->count + 1) * sizeof(int));
+    int* next_child = (int*)calloc(graph->count, sizeof(int));
+    int depth = 0, pre = 0, post = 0;
+    stack[depth++] = 0;
+    ssa->blocks[0].dom_pre = pre++;
+    while (depth > 0) {
+        ssa_block* block = &ssa->blocks[stack[depth - 1]];
+        if (next_child[stack[depth - 1]] < block->child_count) {
+            int child = block->children[next_child[stack[depth - 1]]++];
+            ssa->blocks[child].dom_pre = pre++;
+            stack[depth++] = child;
+        } else {
+            block->dom_post = post++;
+            depth--;
+        }
+    }
+    free(stack);
+    free(next_child);
+}
+
+// Does block a dominate block b? Unreachable blocks dominate nothing.
+int ssa_dominates(ssa_form* ssa, int a, int b) {
+    ssa_block* dominator = &ssa->blocks[a];
+    ssa_block* dominated = &ssa->blocks[b];
+    if (dominator->rpo_index < 0 || dominated->rpo_index < 0) return 0;
+    return dominator->dom_pre <= dominated->dom_pre && dominated->dom_post <= dominator->dom_post;
+}
+
+static void compute_frontiers(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    for (int i = 0; i < ssa->rpo_count; i++) {
+        basic_block* block = &graph->blocks[ssa->rpo[i]];
+        if (block->pred_count < 2) continue;
+
+        for (int p = 0; p < block->pred_count; p++) {
+            int runner = block->preds[p];
+            if (ssa->blocks[runner].rpo_index < 0) continue;
+
+            while (runner >= 0 && runner != ssa->blocks[block->id].idom) {
+                ssa_block* frontier_owner = &ssa->blocks[runner];
+                int count = frontier_owner->frontier_count;
+                if (count == 0 || frontier_owner->frontier[count - 1] != block->id) {
+                    push_int(&frontier_owner->frontier, &frontier_owner->frontier_count,
+                             &frontier_owner->frontier_capacity, block->id);
+                }
+                runner = ssa->blocks[runner].idom;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// PHI PLACEMENT AND RENAMING
+// ============================================================================
+
+static phi_node* add_phi(ssa_form* ssa, int block_id, int base) {
+    ssa_block* block = &ssa->blocks[block_id];
+    if (block->phi_count == block->phi_capacity) {
+        block->phi_capacity = block->phi_capacity ? block->phi_capacity * 2 : 4;
+        block->phis = (phi_node*)realloc(block->phis, block->phi_capacity * sizeof(phi_node));
+    }
+
+    phi_node* phi = &block->phis[block->phi_count++];
+    phi->base = base;
+    phi->result = NULL;
+    phi->args = (char**)calloc(ssa->graph.blocks[block_id].pred_count + 1, sizeof(char*));
+    phi->copy = NULL;
+    phi->type = 0;
+    ssa->phi_total++;
+    return phi;
+}
+
+// Semi-pruned placement: only names read in some block before being
+// written there can need a phi
+static void place_phis(ssa_form* ssa, int bases) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    int* killed_in = (int*)malloc(bases * sizeof(int));
+    int* last_def_block = (int*)malloc(bases * sizeof(int));
+    int* def_count = (int*)calloc(bases + 1, sizeof(int));
+    char* is_global = (char*)calloc(bases, 1);
+    for (int v = 0; v < bases; v++) {
+        killed_in[v] = -1;
+        last_def_block[v] = -1;
+    }
+
+    // Count the blocks defining each name, then list them
+    for (int pass = 0; pass < 2; pass++) {
+        int* fill = NULL;
+        int* def_blocks = NULL;
+        if (pass == 1) {
+            for (int v = 1; v <= bases; v++) def_count[v] += def_count[v - 1];
+            fill = (int*)malloc(bases * sizeof(int));
+            def_blocks = (int*)malloc((def_count[bases] + 1) * sizeof(int));
+            for (int v = 0; v < bases; v++) {
+                fill[v] = def_count[v];
+                last_def_block[v] = -1;
+            }
+        }
+
+        for (int i = 0; i < ssa->rpo_count; i++) {
+            basic_block* block = &graph->blocks[ssa->rpo[i]];
+            for (int q = block->first; q <= block->last; q++) {
+                quad* instr = &fn->code[q];
+                if (pass == 0) {
+                    for (int a = 0; a < IR_MAX_ARGS; a++) {
+                        if (!ir_is_variable(instr->args[a])) continue;
+                        int v = ssa_name_index(ssa, instr->args[a]);
+                        if (killed_in[v] != block->id) is_global[v] = 1;
+                    }
+                }
+                if (!ir_is_variable(instr->result)) continue;
+                int v = ssa_name_index(ssa, instr->result);
+                killed_in[v] = block->id;
+                if (last_def_block[v] == block->id) continue;
+                last_def_block[v] = block->id;
+                if (pass == 0) {
+                    def_count[v + 1]++;
+                } else {
+                    def_blocks[fill[v]++] = block->id;
+                }
+            }
+        }
+
+        if (pass == 1) {
+            // Iterated dominance frontier of each global name's definitions
+            int* has_phi = (int*)malloc(graph->count * sizeof(int));
+            int* queued = (int*)malloc(graph->count * sizeof(int));
+            int* worklist = (int*)malloc((graph->count + def_count[bases] + 1) * sizeof(int));
+            for (int b = 0; b < graph->count; b++) {
+                has_phi[b] = -1;
+                queued[b] = -1;
+            }
+
+            for (int v = 0; v < bases; v++) {
+                if (!is_global[v]) continue;
+                int count = 0;
+                for (int d = def_count[v]; d < def_count[v + 1]; d++) {
+                    worklist[count++] = def_blocks[d];
+                    queued[def_blocks[d]] = v;
+                }
+                while (count > 0) {
+                    ssa_block* block = &ssa->blocks[worklist[--count]];
+                    for (int f = 0; f < block->frontier_count; f++) {
+                        int join = block->frontier[f];
+                        if (has_phi[join] == v) continue;
+                        has_phi[join] = v;
+                        add_phi(ssa, join, v);
+                        if (queued[join] != v) {
+                            queued[join] = v;
+                            worklist[count++] = join;
+                        }
+                    }
+                }
+            }
+            free(has_phi);
+            free(queued);
+            free(worklist);
+            free(fill);
+            free(def_blocks);
+        }
+    }
+
+    free(killed_in);
+    free(last_def_block);
+    free(def_count);
+    free(is_global);
+}
+
+// Current spelling of an unversioned name during renaming
+static char* current_name(ssa_form* ssa, int* top, int base) {
+    return top[base] >= 0 ? ssa->names[top[base]].name : ssa->names[base].name;
+}
+
+// Walk the dominator tree keeping a stack of versions per name
+static void rename_variables(ssa_form* ssa, int bases) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    int* top = (int*)malloc(bases * sizeof(int));
+    for (int v = 0; v < bases; v++) {
+        top[v] = -1;
+    }
+
+    // Undo log of (base, previous top) pairs, unwound when a block is left
+    int* undo = NULL;
+    int undo_count = 0, undo_capacity = 0;
+
+    // Frames are block ids on entry and ~mark on exit
+    int* frames = NULL;
+    int frame_count = 0, frame_capacity = 0;
+    push_int(&frames, &frame_count, &frame_capacity, 0);
+
+    while (frame_count > 0) {
+        int frame = frames[--frame_count];
+        if (frame < 0) {
+            int mark = ~frame;
+            while (undo_count > mark) {
+                undo_count -= 2;
+                top[undo[undo_count]] = undo[undo_count + 1];
+            }
+            continue;
+        }
+
+        basic_block* block = &graph->blocks[frame];
+        ssa_block* info = &ssa->blocks[frame];
+        push_int(&frames, &frame_count, &frame_capacity, ~undo_count);
+
+        for (int p = 0; p < info->phi_count; p++) {
+            phi_node* phi = &info->phis[p];
+            int version = new_version(ssa, phi->base);
+            phi->result = ssa->names[version].name;
+            push_int(&undo, &undo_count, &undo_capacity, phi->base);
+            push_int(&undo, &undo_count, &undo_capacity, top[phi->base]);
+            top[phi->base] = version;
+        }
+
+        for (int q = block->first; q <= block->last; q++) {
+            quad* instr = &fn->code[q];
+            for (int a = 0; a < IR_MAX_ARGS; a++) {
+                if (!ir_is_variable(instr->args[a])) continue;
+                instr->args[a] = current_name(ssa, top, ssa_name_index(ssa, instr->args[a]));
+            }
+            if (!ir_is_variable(instr->result)) continue;
+
+            int base = ssa_name_index(ssa, instr->result);
+            int version = new_version(ssa, base);
+            ssa->names[version].type = instr->type;
+            instr->result = ssa->names[version].name;
+            push_int(&undo, &undo_count, &undo_capacity, base);
+            push_int(&undo, &undo_count, &undo_capacity, top[base]);
+            top[base] = version;
+        }
+
+        // Fill this block's operand of every phi in its successors
+        for (int s = 0; s < block->succ_count; s++) {
+            basic_block* succ = &graph->blocks[block->succs[s]];
+            ssa_block* succ_info = &ssa->blocks[succ->id];
+            int slot = 0;
+            while (succ->preds[slot] != block->id) slot++;
+
+            for (int p = 0; p < succ_info->phi_count; p++) {
+                phi_node* phi = &succ_info->phis[p];
+                phi->args[slot] = current_name(ssa, top, phi->base);
+                if (!phi->type && top[phi->base] >= 0) {
+                    phi->type = ssa->names[top[phi->base]].type;
+                }
+            }
+        }
+
+        for (int c = info->child_count - 1; c >= 0; c--) {
+            push_int(&frames, &frame_count, &frame_capacity, info->children[c]);
+        }
+    }
+
+    free(top);
+    free(undo);
+    free(frames);
+}
+
+// Drop the phis whose result is never read; semi-pruned placement merges
+// names such as a loop counter past the end of its block, where the
+// incoming value may not even be defined
+static void prune_dead_phis(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    int names = ssa->name_count;
+    int* phi_of = (int*)malloc(names * sizeof(int));
+    char* live = (char*)calloc(names, 1);
+    int* worklist = (int*)malloc((names + 1) * sizeof(int));
+    int count = 0;
+    for (int v = 0; v < names; v++) {
+        phi_of[v] = -1;
+    }
+    for (int b = 0; b < graph->count; b++) {
+        for (int p = 0; p < ssa->blocks[b].phi_count; p++) {
+            phi_of[ssa_name_index(ssa, ssa->blocks[b].phis[p].result)] = b;
+        }
+    }
+
+    // A phi is live if a quad reads it or a live phi merges it
+    for (int i = 0; i < fn->count; i++) {
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            if (!ir_is_variable(fn->code[i].args[a])) continue;
+            int v = ssa_name_index(ssa, fn->code[i].args[a]);
+            if (phi_of[v] >= 0 && !live[v]) {
+                live[v] = 1;
+                worklist[count++] = v;
+            }
+        }
+    }
+    while (count > 0) {
+        int v = worklist[--count];
+        ssa_block* info = &ssa->blocks[phi_of[v]];
+        for (int p = 0; p < info->phi_count; p++) {
+            phi_node* phi = &info->phis[p];
+            if (phi->result != ssa->names[v].name) continue;
+            for (int k = 0; k < graph->blocks[phi_of[v]].pred_count; k++) {
+                if (!phi->args[k]) continue;
+                int arg = ssa_name_index(ssa, phi->args[k]);
+                if (phi_of[arg] >= 0 && !live[arg]) {
+                    live[arg] = 1;
+                    worklist[count++] = arg;
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < graph->count; b++) {
+        ssa_block* info = &ssa->blocks[b];
+        int kept = 0;
+        for (int p = 0; p < info->phi_count; p++) {
+            if (live[ssa_name_index(ssa, info->phis[p].result)]) {
+                info->phis[kept++] = info->phis[p];
+            } else {
+                free(info->phis[p].args);
+                ssa->phi_total--;
+            }
+        }
+        info->phi_count = kept;
+    }
+
+    free(phi_of);
+    free(live);
+    free(worklist);
+}
+
+// Would liveness over this many names fit the bitset budget?
+static int fits_bitset_budget(ssa_form* ssa, long long names) {
+    long long words = (long long)ssa->graph.count * ((names + 63) / 64);
+    return words <= SSA_MAX_BITSET_WORDS;
+}
+
+int ssa_build(ssa_form* ssa, ir_function* fn) {
+    memset(ssa, 0, sizeof(ssa_form));
+    ssa->fn = fn;
+    cfg_build(&ssa->graph, fn);
+
+    // A loop back to the first instruction would make the entry a join
+    // point; start the function with a fresh label instead
+    if (ssa->graph.blocks[0].pred_count > 0) {
+        cfg_release(&ssa->graph);
+        ir_insert(fn, 0, IR_LABEL)->target = ir_new_label(fn);
+        cfg_build(&ssa->graph, fn);
+    }
+
+    // Register every name as an unversioned base
+    int defs = 0;
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            if (ir_is_variable(q->args[a])) base_index(ssa, q->args[a]);
+        }
+        if (ir_is_variable(q->result)) {
+            base_index(ssa, q->result);
+            defs++;
+        }
+    }
+    int bases = ssa->name_count;
+    if (!fits_bitset_budget(ssa, (long long)bases + defs)) {
+        ssa_release(ssa);
+        return 0;
+    }
+
+    ssa->blocks = (ssa_block*)calloc(ssa->graph.count, sizeof(ssa_block));
+    ssa->block_count = ssa->graph.count;
+    compute_dominators(ssa);
+    compute_frontiers(ssa);
+    place_phis(ssa, bases);
+
+    // Destruction adds one name per phi
+    if (!fits_bitset_budget(ssa, (long long)bases + defs + 2LL * ssa->phi_total)) {
+        ssa_release(ssa);
+        return 0;
+    }
+
+    rename_variables(ssa, bases);
+    prune_dead_phis(ssa);
+    return 1;
+}
+
+void ssa_release(ssa_form* ssa) {
+    if (ssa->blocks) {
+        for (int b = 0; b < ssa->block_count; b++) {
+            ssa_block* block = &ssa->blocks[b];
+            for (int p = 0; p < block->phi_count; p++) {
+                free(block->phis[p].args);
+            }
+            free(block->phis);
+            free(block->children);
+            free(block->frontier);
+        }
+    }
+    free(ssa->blocks);
+    free(ssa->rpo);
+    free(ssa->names);
+    free(ssa->slots);
+    cfg_release(&ssa->graph);
+    memset(ssa, 0, sizeof(ssa_form));
+}
+
+// ============================================================================
+// OUT OF SSA
+// ============================================================================
+// Every phi becomes a copy into a fresh name at the end of each
+// predecessor and a copy out of it at the top of the block, which is
+// correct without splitting critical edges. Copies, including the
+// parallel copies of multiple assignment, are then coalesced whenever the
+// live ranges of source and destination do not overlap, and every class
+// of coalesced names gets back a plain name.
+
+// Live range piece [start, end] in half-instruction steps: the value
+// written by code[i] is live from 2i+1, a read by code[i] happens at 2i
+typedef struct live_interval {
+    int name;
+    int start;
+    int end;
+} live_interval;
+
+typedef struct interval_list {
+    live_interval* items;
+    int count;
+} interval_list;
+
+static void emit_copy(quad** code, int* count, int* capacity, char* result, char* src, int type) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : IR_INITIAL_CAPACITY;
+        *code = (quad*)realloc(*code, *capacity * sizeof(quad));
+    }
+    quad* q = &(*code)[(*count)++];
+    memset(q, 0, sizeof(quad));
+    q->opcode = IR_COPY;
+    q->op = OP_NONE;
+    q->result = result;
+    q->args[0] = src;
+    q->type = type;
+}
+
+static void emit_quad(quad** code, int* count, int* capacity, quad* source) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : IR_INITIAL_CAPACITY;
+        *code = (quad*)realloc(*code, *capacity * sizeof(quad));
+    }
+    (*code)[(*count)++] = *source;
+}
+
+// One copy a predecessor makes for a phi of its successor
+typedef struct phi_copy {
+    char* dest;
+    char* source;
+    int succ;
+} phi_copy;
+
+static void emit_phi_copy(ssa_form* ssa, quad** code, int* count, int* capacity, phi_copy* copy) {
+    int id = ssa_name_index(ssa, copy->dest);
+    emit_copy(code, count, capacity, copy->dest, copy->source, ssa->names[id].type);
+}
+
+// Replace every phi with copies and rebuild the quad array
+static void lower_phis(ssa_form* ssa) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+
+    // Copies placed at the end of each block, before its jump
+    int* pred_copy_count = (int*)calloc(graph->count, sizeof(int));
+    phi_copy** pred_copies = (phi_copy**)calloc(graph->count, sizeof(phi_copy*));
+    int* pred_copy_capacity = (int*)calloc(graph->count, sizeof(int));
+
+    for (int b = 0; b < graph->count; b++) {
+        ssa_block* info = &ssa->blocks[b];
+        for (int p = 0; p < info->phi_count; p++) {
+            phi_node* phi = &info->phis[p];
+            int copy = new_version(ssa, phi->base);
+            ssa->names[copy].type = phi->type;
+            phi->copy = ssa->names[copy].name;
+
+            for (int k = 0; k < graph->blocks[b].pred_count; k++) {
+                int pred = graph->blocks[b].preds[k];
+                if (pred_copy_count[pred] == pred_copy_capacity[pred]) {
+                    pred_copy_capacity[pred] = pred_copy_capacity[pred] ? pred_copy_capacity[pred] * 2 : 4;
+                    pred_copies[pred] = (phi_copy*)realloc(pred_copies[pred], pred_copy_capacity[pred] * sizeof(phi_copy));
+                }
+                phi_copy* entry = &pred_copies[pred][pred_copy_count[pred]++];
+                entry->dest = phi->copy;
+                entry->source = phi->args[k] ? phi->args[k] : ssa->names[phi->base].name;
+                entry->succ = b;
+            }
+        }
+    }
+
+    quad* code = NULL;
+    int count = 0, capacity = 0;
+    for (int b = 0; b < graph->count; b++) {
+        basic_block* block = &graph->blocks[b];
+        ssa_block* info = &ssa->blocks[b];
+        int i = block->first;
+
+        while (i <= block->last && fn->code[i].opcode == IR_LABEL) {
+            emit_quad(&code, &count, &capacity, &fn->code[i++]);
+        }
+        for (int p = 0; p < info->phi_count; p++) {
+            phi_node* phi = &info->phis[p];
+            emit_copy(&code, &count, &capacity, phi->result, phi->copy, phi->type);
+        }
+
+        int end = block->last;
+        int has_jump = end >= i && is_jump_opcode(fn->code[end].opcode);
+        if (has_jump) end--;
+        for (; i <= end; i++) {
+            emit_quad(&code, &count, &capacity, &fn->code[i]);
+        }
+
+        // Copies for the fallthrough of a conditional jump go after the
+        // jump, so the path that jumps away does not run them
+        quad* jump = has_jump ? &fn->code[block->last] : NULL;
+        int split = -1;
+        if (jump && jump->opcode != IR_GOTO && cfg_block_of_label(graph, jump->target) != b + 1) {
+            split = b + 1;
+        }
+        for (int c = 0; c < pred_copy_count[b]; c++) {
+            if (pred_copies[b][c].succ != split) emit_phi_copy(ssa, &code, &count, &capacity, &pred_copies[b][c]);
+        }
+        if (!jump) continue;
+
+        // A jump that reads a value just copied reads the copy instead,
+        // so the value does not stay live across the copy into the phi
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            for (int c = 0; c < pred_copy_count[b] && ir_is_variable(jump->args[a]); c++) {
+                if (pred_copies[b][c].succ == split || pred_copies[b][c].source != jump->args[a]) continue;
+                jump->args[a] = pred_copies[b][c].dest;
+                break;
+            }
+        }
+        emit_quad(&code, &count, &capacity, jump);
+        for (int c = 0; c < pred_copy_count[b]; c++) {
+            if (pred_copies[b][c].succ == split) emit_phi_copy(ssa, &code, &count, &capacity, &pred_copies[b][c]);
+        }
+    }
+
+    free(fn->code);
+    fn->code = code;
+    fn->count = count;
+    fn->capacity = capacity;
+
+    for (int b = 0; b < graph->count; b++) {
+        free(pred_copies[b]);
+    }
+    free(pred_copies);
+    free(pred_copy_count);
+    free(pred_copy_capacity);
+}
+
+#define BIT_SET(set, i) ((set)[(i) >> 6] |= 1ULL << ((i) & 63))
+#define BIT_TEST(set, i) (((set)[(i) >> 6] >> ((i) & 63)) & 1ULL)
+
+// Live ranges of every name as sorted interval lists
+static live_interval* compute_intervals(ssa_form* ssa, int* interval_count) {
+    cfg* graph = &ssa->graph;
+    ir_function* fn = ssa->fn;
+    int names = ssa->name_count;
+    int words = (names + 63) / 64;
+    size_t set_bytes = (size_t)graph->count * words * sizeof(unsigned long long);
+
+    unsigned long long* use = (unsigned long long*)calloc(1, set_bytes + 8);
+    unsigned long long* def = (unsigned long long*)calloc(1, set_bytes + 8);
+    unsigned long long* live_in = (unsigned long long*)calloc(1, set_bytes + 8);
+    unsigned long long* live_out = (unsigned long long*)calloc(1, set_bytes + 8);
+
+    // Upward-exposed reads and writes of each block
+    for (int b = 0; b < graph->count; b++) {
+        unsigned long long* block_use = use + (size_t)b * words;
+        unsigned long long* block_def = def + (size_t)b * words;
+        for (int i = graph->blocks[b].first; i <= graph->blocks[b].last; i++) {
+            quad* q = &fn->code[i];
+            for (int a = 0; a < IR_MAX_ARGS; a++) {
+                if (!ir_is_variable(q->args[a])) continue;
+                int v = ssa_name_index(ssa, q->args[a]);
+                if (!BIT_TEST(block_def, v)) BIT_SET(block_use, v);
+            }
+            if (ir_is_variable(q->result)) {
+                BIT_SET(block_def, ssa_name_index(ssa, q->result));
+            }
+        }
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int b = graph->count - 1; b >= 0; b--) {
+            basic_block* block = &graph->blocks[b];
+            unsigned long long* out = live_out + (size_t)b * words;
+            unsigned long long* in = live_in + (size_t)b * words;
+            for (int s = 0; s < block->succ_count; s++) {
+                unsigned long long* succ_in = live_in + (size_t)block->succs[s] * words;
+                for (int w = 0; w < words; w++) out[w] |= succ_in[w];
+            }
+            for (int w = 0; w < words; w++) {
+                unsigned long long value = use[(size_t)b * words + w] |
+                                           (out[w] & ~def[(size_t)b * words + w]);
+                if (value != in[w]) {
+                    in[w] = value;
+                    changed = 1;
+                }
+            }
+        }
+    }
+
+    // Walk each block backwards, opening a range at its last read and
+    // closing it at the write
+    live_interval* intervals = NULL;
+    int count = 0, capacity = 0;
+    int* open_end = (int*)malloc((names + 1) * sizeof(int));
+    for (int v = 0; v < names; v++) {
+        open_end[v] = -1;
+    }
+
+    for (int b = 0; b < graph->count; b++) {
+        basic_block* block = &graph->blocks[b];
+        if (block->last < block->first) continue;
+        unsigned long long* out = live_out + (size_t)b * words;
+        unsigned long long* in = live_in + (size_t)b * words;
+
+        for (int v = 0; v < names; v++) {
+            if (BIT_TEST(out, v)) open_end[v] = 2 * block->last + 1;
+        }
+
+        for (int i = block->last; i >= block->first; i--) {
+            quad* q = &fn->code[i];
+            if (count + IR_MAX_ARGS + 1 >= capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                intervals = (live_interval*)realloc(intervals, capacity * sizeof(live_interval));
+            }
+            if (ir_is_variable(q->result)) {
+                int v = ssa_name_index(ssa, q->result);
+                live_interval* range = &intervals[count++];
+                range->name = v;
+                range->start = 2 * i + 1;
+                range->end = open_end[v] >= 0 ? open_end[v] : 2 * i + 1;
+                open_end[v] = -1;
+            }
+            for (int a = 0; a < IR_MAX_ARGS; a++) {
+                if (!ir_is_variable(q->args[a])) continue;
+                int v = ssa_name_index(ssa, q->args[a]);
+                if (open_end[v] < 0) open_end[v] = 2 * i;
+            }
+        }
+
+        for (int v = 0; v < names; v++) {
+            if (!BIT_TEST(in, v)) continue;
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                intervals = (live_interval*)realloc(intervals, capacity * sizeof(live_interval));
+            }
+            live_interval* range = &intervals[count++];
+            range->name = v;
+            range->start = 2 * block->first;
+            range->end = open_end[v];
+            open_end[v] = -1;
+        }
+    }
+
+    free(open_end);
+    free(use);
+    free(def);
+    free(live_in);
+    free(live_out);
+    *interval_count = count;
+    return intervals;
+}
+
+static int by_name_then_start(const void* a, const void* b) {
+    const live_interval* left = (const live_interval*)a;
+    const live_interval* right = (const live_interval*)b;
+    if (left->name != right->name) return left->name - right->name;
+    return left->start - right->start;
+}
+
+static int intervals_overlap(interval_list* a, interval_list* b) {
+    int i = 0, j = 0;
+    while (i < a->count && j < b->count) {
+        if (a->items[i].end < b->items[j].start) {
+            i++;
+        } else if (b->items[j].end < a->items[i].start) {
+            j++;
+        } else {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Merge b into a, keeping a sorted by start
+static void merge_intervals(interval_list* a, interval_list* b) {
+    live_interval* merged = (live_interval*)malloc((a->count + b->count + 1) * sizeof(live_interval));
+    int i = 0, j = 0, count = 0;
+    while (i < a->count || j < b->count) {
+        if (j >= b->count || (i < a->count && a->items[i].start <= b->items[j].start)) {
+            merged[count++] = a->items[i++];
+        } else {
+            merged[count++] = b->items[j++];
+        }
+    }
+    free(a->items);
+    a->items = merged;
+    a->count = count;
+}
+
+static int find_class(int* parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// Convert back to ordinary 3AC; returns the number of copies removed
+int ssa_destroy(ssa_form* ssa) {
+    ir_function* fn = ssa->fn;
+    lower_phis(ssa);
+    cfg_release(&ssa->graph);
+    cfg_build(&ssa->graph, fn);
+
+    int names = ssa->name_count;
+    int interval_count = 0;
+    live_interval* intervals = compute_intervals(ssa, &interval_count);
+    qsort(intervals, interval_count, sizeof(live_interval), by_name_then_start);
+
+    // Each name starts in its own class
+    int* parent = (int*)malloc(names * sizeof(int));
+    int* entry_name = (int*)malloc(names * sizeof(int));
+    interval_list* ranges = (interval_list*)calloc(names, sizeof(interval_list));
+    for (int v = 0; v < names; v++) {
+        parent[v] = v;
+        entry_name[v] = ssa->names[v].version == 0 ? v : -1;
+    }
+    for (int k = 0; k < interval_count;) {
+        int v = intervals[k].name;
+        int first = k;
+        while (k < interval_count && intervals[k].name == v) k++;
+        ranges[v].count = k - first;
+        ranges[v].items = (live_interval*)malloc((k - first) * sizeof(live_interval));
+        memcpy(ranges[v].items, &intervals[first], (k - first) * sizeof(live_interval));
+    }
+    free(intervals);
+
+    // Coalesce the two sides of every copy whose ranges do not overlap.
+    // Values on entry must keep their own names, so two of them never merge.
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        if (q->opcode != IR_COPY || !ir_is_variable(q->result) || !ir_is_variable(q->args[0])) continue;
+
+        int a = find_class(parent, ssa_name_index(ssa, q->result));
+        int b = find_class(parent, ssa_name_index(ssa, q->args[0]));
+        if (a == b) continue;
+        if (entry_name[a] >= 0 && entry_name[b] >= 0) continue;
+        if (intervals_overlap(&ranges[a], &ranges[b])) continue;
+
+        parent[b] = a;
+        merge_intervals(&ranges[a], &ranges[b]);
+        free(ranges[b].items);
+        ranges[b].items = NULL;
+        ranges[b].count = 0;
+        if (entry_name[a] < 0) entry_name[a] = entry_name[b];
+    }
+
+    // Members of each class, in registry order
+    int* member_start = (int*)calloc(names + 1, sizeof(int));
+    int* members = (int*)malloc((names + 1) * sizeof(int));
+    for (int v = 0; v < names; v++) member_start[find_class(parent, v) + 1]++;
+    for (int v = 0; v < names; v++) member_start[v + 1] += member_start[v];
+    int* fill = (int*)malloc((names + 1) * sizeof(int));
+    memcpy(fill, member_start, names * sizeof(int));
+    for (int v = 0; v < names; v++) members[fill[find_class(parent, v)]++] = v;
+    free(fill);
+
+    // Name every class. Entry values keep their names; any other class
+    // takes the name of one of its members' variables if no class already
+    // using that name overlaps it, or a fresh temporary otherwise.
+    char** class_name = (char**)calloc(names, sizeof(char*));
+    interval_list* occupied = (interval_list*)calloc(names, sizeof(interval_list));
+    for (int c = 0; c < names; c++) {
+        if (parent[c] != c || entry_name[c] < 0) continue;
+        class_name[c] = ssa->names[entry_name[c]].name;
+        merge_intervals(&occupied[entry_name[c]], &ranges[c]);
+    }
+    for (int v = 0; v < names; v++) {
+        int c = find_class(parent, v);
+        if (class_name[c]) continue;
+
+        // Source variables first, so the output keeps their names
+        for (int pass = 0; pass < 2 && !class_name[c]; pass++) {
+            for (int m = member_start[c]; m < member_start[c + 1] && !class_name[c]; m++) {
+                int base = ssa->names[members[m]].base;
+                int is_temp = ir_temp_number(fn, ssa->names[base].name) != 0;
+                if (is_temp != pass) continue;
+                if (intervals_overlap(&occupied[base], &ranges[c])) continue;
+                class_name[c] = ssa->names[base].name;
+                merge_intervals(&occupied[base], &ranges[c]);
+            }
+        }
+        if (!class_name[c]) {
+            class_name[c] = ir_new_temp(fn);
+        }
+    }
+
+    // Rewrite the operands and drop the copies that became self-copies
+    int kept = 0, removed = 0;
+    for (int i = 0; i < fn->count; i++) {
+        quad* q = &fn->code[i];
+        for (int a = 0; a < IR_MAX_ARGS; a++) {
+            if (!ir_is_variable(q->args[a])) continue;
+            q->args[a] = class_name[find_class(parent, ssa_name_index(ssa, q->args[a]))];
+        }
+        if (ir_is_variable(q->result)) {
+            q->result = class_name[find_class(parent, ssa_name_index(ssa, q->result))];
+        }
+        if (q->opcode == IR_COPY && q->result == q->args[0]) {
+            removed++;
+            continue;
+        }
+        fn->code[kept++] = *q;
+    }
+    fn->count = kept;
+
+    for (int v = 0; v < names; v++) {
+        free(ranges[v].items);
+        free(occupied[v].items);
+    }
+    free(ranges);
+    free(occupied);
+    free(parent);
+    free(entry_name);
+    free(member_start);
+    free(members);
+    free(class_name);
+    ssa_release(ssa);
+    return removed;
+}
@@ -0,0 +1,84 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "cfg.h"
+
+// ============================================================================
+// STATIC SINGLE ASSIGNMENT FORM
+// ============================================================================
+// ssa_build rewrites the operands of a function in place so that every
+// variable and temporary is assigned exactly once. The versions of x are
+// spelled "x.1", "x.2", ...; the value x has on entry (a parameter, or a
+// variable read before it is written) keeps the plain name "x". Phi
+// functions are kept with the blocks of the ssa_form rather than in the
+// quad array. ssa_destroy turns the function back into ordinary 3AC.
+
+// Functions whose liveness bitsets would exceed this many 64-bit words
+// are left out of SSA
+#define SSA_MAX_BITSET_WORDS (1 << 20)
+
+typedef struct phi_node {
+    int base;             // Registry index of the variable being merged
+    char* result;
+    char** args;          // One per predecessor, in the order of block->preds
+    char* copy;           // Name the predecessors copy into when leaving SSA
+    int type;
+} phi_node;
+
+typedef struct ssa_block {
+    phi_node* phis;
+    int phi_count;
+    int phi_capacity;
+    int idom;             // Immediate dominator, -1 for the entry and unreachable blocks
+    int* children;        // Blocks immediately dominated by this one
+    int child_count;
+    int child_capacity;
+    int* frontier;        // Dominance frontier
+    int frontier_count;
+    int frontier_capacity;
+    int rpo_index;        // Position in reverse postorder, -1 if unreachable
+    int dom_pre;          // Dominator tree preorder and postorder numbers
+    int dom_post;
+} ssa_block;
+
+// Every variable name of the function, unversioned or not
+typedef struct ssa_name {
+    char* name;
+    int base;             // Registry index of the unversioned name
+    int version;          // 0 for the unversioned name
+    int last_version;     // Highest version handed out (unversioned names only)
+    int type;             // TYPE_* of the defining quad, 0 if unknown
+} ssa_name;
+
+typedef struct ssa_form {
+    ir_function* fn;
+    cfg graph;
+    ssa_block* blocks;    // Parallel to graph.blocks as first built
+    int block_count;      // Entries of blocks; destruction rebuilds the graph
+    int* rpo;             // Reachable blocks in reverse postorder
+    int rpo_count;
+    ssa_name* names;
+    int name_count;
+    int name_capacity;
+    int* slots;           // Open-addressing map from name pointer to registry index
+    int slot_capacity;
+    int phi_total;
+} ssa_form;
+
+// ============================================================================
+// CONSTRUCTION AND DESTRUCTION
+// ============================================================================
+
+int ssa_build(ssa_form* ssa, ir_function* fn);
+int ssa_destroy(ssa_form* ssa);
+void ssa_release(ssa_form* ssa);
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+int ssa_dominates(ssa_form* ssa, int a, int b);
+int ssa_name_index(ssa_form* ssa, char* name);
+char* ssa_base_name(ssa_form* ssa, char* name);
+
+#endif // SSA_H
@@ -0,0 +1,186 @@
+#include "tailcall.h"
+#include "inline.h"
+#include "frame.h"
+
+typedef enum tail_kind {
+    TAIL_NONE,
+    TAIL_SELF,
+    TAIL_OTHER
+} tail_kind;
+
+// Temporaries, parameters and locals vanish with the frame; globals do not
+static int is_frame_name(ir_function* fn, function_info* info, char* name) {
+    if (ir_temp_number(fn, name)) return 1;
+    for (int v = 0; v < info->param_count; v++) {
+        if (info->param_names[v] == name) return 1;
+    }
+    for (int v = 0; v < info->local_count; v++) {
+        if (info->local_names[v] == name) return 1;
+    }
+    return 0;
+}
+
+// Does the code from index start on return value (NULL for a call without
+// one) and do nothing else that outlives the frame?
+static int returns_value(ir_function* fn, function_info* info, int* label_at, int start, char* value, int type) {
+    int i = start;
+    for (int step = 0; step < TAIL_MAX_WALK; step++) {
+        if (i >= fn->count) return 1;
+        quad* q = &fn->code[i];
+        switch (q->opcode) {
+            case IR_LABEL:
+            case IR_COMMENT:
+                i++;
+                break;
+            case IR_GOTO: {
+                int label = ir_label_number(fn, q->target);
+                if (!label || label_at[label] < 0) return 0;
+                i = label_at[label];
+                break;
+            }
+            case IR_COPY:
+                if (!value || q->args[0] != value || !is_frame_name(fn, info, q->result)) return 0;
+                if (q->type && type && q->type != type) return 0;
+                value = q->result;
+                i++;
+                break;
+            case IR_RETURN:
+                return !q->args[0] || q->args[0] == value;
+            default:
+                return 0;
+        }
+    }
+    return 0;
+}
+
+// Why a call in tail position cannot be eliminated, NULL if it can
+static const char* check_tail_call(ir_function* fn, function_info* info, call_site* site, tail_kind* kind) {
+    quad* call = &fn->code[site->call];
+    function_info* callee = find_function_by_name(call->target);
+    if (!callee) return "no signature";
+
+    if (strcmp(call->target, fn->name) == 0) {
+        if (site->arg_count > info->param_count) return "too many arguments";
+        for (int p = site->arg_count; p < info->param_count; p++) {
+            if (!default_argument(info, p)) {
+                return "default is not a literal";
+            }
+        }
+        *kind = TAIL_SELF;
+        return NULL;
+    }
+
+    // A function without a return value hands whatever the callee returns
+    // to a caller that does not read it
+    if (info->return_type != 0 && callee->return_type != info->return_type) return "return type differs";
+    if (site->arg_count > info->param_count) return "arguments do not fit in the parameters";
+    *kind = TAIL_OTHER;
+    return NULL;
+}
+
+void eliminate_tail_calls(ir_function* fn, tail_call_stats* stats) {
+    memset(stats, 0, sizeof(tail_call_stats));
+    function_info* info = find_function_by_name(fn->name);
+    if (!info || fn->count == 0) return;
+
+    int* label_at = (int*)malloc((fn->label_count + 1) * sizeof(int));
+    for (int l = 0; l <= fn->label_count; l++) {
+        label_at[l] = -1;
+    }
+    for (int i = 0; i < fn->count; i++) {
+        if (fn->code[i].opcode != IR_LABEL) continue;
+        int label = ir_label_number(fn, fn->code[i].target);
+        if (label) label_at[label] = i;
+    }
+
+    int site_count = 0;
+    call_site* sites = find_call_sites(fn, &site_count);
+    tail_kind* kinds = (tail_kind*)calloc(site_count + 1, sizeof(tail_kind));
+    for (int s = 0; s < site_count; s++) {
+        call_site* site = &sites[s];
+        quad* call = &fn->code[site->call];
+        if (call->opcode == IR_TAIL_CALL) continue;
+        int next = (site->pop >= 0 ? site->pop : site->call) + 1;
+        char* value = call->opcode == IR_LCALL ? call->result : NULL;
+        if (!returns_value(fn, info, label_at, next, value, call->type)) continue;
+
+        const char* reason = check_tail_call(fn, info, site, &kinds[s]);
+        if (reason) {
+            ir_add_note(fn, "tail call: %s: kept, %s", call->target, reason);
+            continue;
+        }
+        ir_add_note(fn, "tail call: %s: %s", call->target, kinds[s] == TAIL_SELF ? "jump to entry" : "TailCall");
+        if (kinds[s] == TAIL_SELF) {
+            stats->self++;
+            site->params = (char**)malloc((site->arg_count + 1) * sizeof(char*));
+            for (int a = 0; a < site->arg_count; a++) {
+                site->params[a] = ir_new_temp(fn);
+            }
+        } else {
+            stats->other++;
+        }
+    }
+
+    if (stats->self + stats->other > 0) {
+        // Which eliminated call, if any, each push and call belongs to
+        int* push_arg = (int*)malloc(fn->count * sizeof(int));
+        int* site_of = (int*)malloc(fn->count * sizeof(int));
+        for (int i = 0; i < fn->count; i++) {
+            push_arg[i] = -1;
+            site_of[i] = -1;
+        }
+        for (int s = 0; s < site_count; s++) {
+            if (kinds[s] == TAIL_NONE) continue;
+            site_of[sites[s].call] = s;
+            for (int a = 0; a < sites[s].arg_count; a++) {
+                push_arg[sites[s].pushes[a]] = a;
+                site_of[sites[s].pushes[a]] = s;
+            }
+        }
+
+        quad* code = fn->code;
+        int count = fn->count;
+        fn->code = NULL;
+        fn->count = 0;
+        fn->capacity = 0;
+        char* entry = stats->self > 0 ? ir_new_label(fn) : NULL;
+        if (entry) ir_emit_label(fn, entry);
+
+        for (int i = 0; i < count; i++) {
+            quad* q = &code[i];
+            int s = site_of[i];
+            if (s < 0 || (kinds[s] == TAIL_OTHER && push_arg[i] >= 0)) {
+                *ir_append(fn, q->opcode) = *q;
+                continue;
+            }
+
+            call_site* site = &sites[s];
+            if (kinds[s] == TAIL_SELF && push_arg[i] >= 0) {
+                // Arguments may read the parameters, so they are set aside first
+                int a = push_arg[i];
+                ir_emit_copy(fn, site->params[a], q->args[0], info->param_types[a]);
+                continue;
+            }
+
+            if (kinds[s] == TAIL_SELF) {
+                for (int p = 0; p < info->param_count; p++) {
+                    char* value = p < site->arg_count ? site->params[p] : default_argument(info, p);
+                    ir_emit_copy(fn, info->param_names[p], value, info->param_types[p]);
+                }
+                ir_emit_goto(fn, entry);
+            } else {
+                int bytes = site->pop >= 0 ? code[site->pop].value : 0;
+                ir_emit_tail_call(fn, q->target, bytes, q->type);
+            }
+            if (site->pop >= 0) i = site->pop;
+        }
+
+        free(code);
+        free(push_arg);
+        free(site_of);
+    }
+
+    release_call_sites(sites, site_count);
+    free(kinds);
+    free(label_at);
+}
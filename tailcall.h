@@ -0,0 +1,38 @@
+#ifndef TAILCALL_H
+#define TAILCALL_H
+
+#include "semantic_analysis.h"
+#include "ir.h"
+
+// ============================================================================
+// TAIL CALLS
+// ============================================================================
+// A call is in tail position when nothing but labels, gotos and copies of
+// its value into temporaries, parameters or locals lies between it and a
+// return of that value, a bare return or the end of the function. This is
+// checked on the 3AC after inlining, so it covers "return f(x)" as written
+// and the calls an inlined body leaves in tail position.
+//
+// A tail call to the function itself becomes a jump: the arguments are
+// copied into fresh temporaries where they were pushed, then into the
+// parameters (the left-out ones take their literal defaults), and the
+// call is replaced with a goto to a label at the function entry. The
+// recursion becomes a loop the loop passes can work on.
+//
+// Any other tail call becomes
+//     PushParam a1 ... PushParam ak; TailCall f 8k
+// which tells the backend to store the arguments over this function's own
+// parameters, release its frame and jump to f, so that f returns straight
+// to this function's caller. That needs the arguments to fit in the space
+// of the parameters, and the callee to return the same type.
+
+#define TAIL_MAX_WALK 16  // Instructions followed from a call to its return
+
+typedef struct tail_call_stats {
+    int self;             // Calls to the function itself turned into jumps
+    int other;            // Calls turned into TailCall
+} tail_call_stats;
+
+void eliminate_tail_calls(ir_function* fn, tail_call_stats* stats);
+
+#endif // TAILCALL_H
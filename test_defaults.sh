@@ -0,0 +1,76 @@
+#!/bin/bash
+
+# test_defaults.sh - Regression tests for parameter default values
+#
+# Usage: ./test_defaults.sh    (build ./ast first with ./run_program.sh)
+#
+# Each test compiles a small program, with or without -O, and checks that
+# the 3AC contains the expected lines one after the other. Exits with the
+# number of failed tests.
+
+if [ ! -x ./ast ]; then
+    echo "ERROR: ./ast not found. Build it first with ./run_program.sh"
+    exit 1
+fi
+
+failures=0
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# check NAME "OPTIONS" LINE...  (the program is read from standard input)
+check() {
+    local name=$1 options=$2
+    shift 2
+    cat > "$work/program.t"
+    ./ast $options < "$work/program.t" > "$work/output.txt" 2>&1
+
+    local actual expected
+    actual="|$(sed 's/^ *//' "$work/output.txt" | tr '\n' '|')"
+    expected="|$(printf '%s|' "$@")"
+    if [[ "$actual" == *"$expected"* ]]; then
+        echo "PASS: $name"
+    else
+        echo "FAIL: $name"
+        echo "  expected, in order:"
+        printf '    %s\n' "$@"
+        failures=$((failures + 1))
+    fi
+}
+
+echo "=== Default Value Tests ==="
+
+# The caller pushes a left-out default, converted to the parameter type
+check "left-out default is pushed" "" \
+    "PushParam 2.0" "t1 = LCall third" "PopParams 8" <<'EOF'
+def third(float x: 2) -> float: { return x / 3; }
+def usethird() -> float: { return third() + 1.0; }
+def __main__(): { float r = usethird(); }
+EOF
+
+# An int default on a float parameter folds as a float once inlined
+check "inlined int default on a float parameter" "-O" \
+    "usethird:" "BeginFunc 16" "t1 = 0.6666666666666666 + v" "return t1" <<'EOF'
+def third(float y; float x: 2) -> float: { return x / 3 + y; }
+def usethird(float v) -> float: { return third(v); }
+def __main__(): { float r = usethird(1.5); }
+EOF
+
+# A call run at compile time binds the default as a float
+check "compile-time call with an int default on a float parameter" "-O --inline-limit=0" \
+    "usethird:" "BeginFunc 0" "return 1.6666666666666665" <<'EOF'
+def third(float x: 2) -> float: { return x / 3; }
+def usethird() -> float: { return third() + 1.0; }
+def __main__(): { float r = usethird(); }
+EOF
+
+# A clone binds the default as a float
+check "specialized clone with an int default on a float parameter" "-O --inline-limit=0" \
+    "third__s1:" "BeginFunc 16" "t1 = 0.6666666666666666 + y" "return t1" <<'EOF'
+def third(float y; float x: 2) -> float: { return x / 3 + y; }
+def twice(float a; float b) -> float: { return third(a) + third(b); }
+def __main__(): { float r = twice(1.0, 2.0); }
+EOF
+
+echo ""
+echo "=== $failures test(s) failed ==="
+exit $failures